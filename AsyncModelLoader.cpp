@@ -0,0 +1,93 @@
+#include "AsyncModelLoader.h"
+#include <chrono>
+
+float ModelLoadHandle::Progress() const {
+	if (!job_) {
+		return 0.0f;
+	}
+	if (job_->done) {
+		return 1.0f;
+	}
+	const uint64_t total = job_->control.bytesTotal;
+	if (total == 0) {
+		return 0.0f;
+	}
+	return static_cast<float>(static_cast<double>(job_->control.bytesParsed) / static_cast<double>(total));
+}
+
+AsyncModelLoader::AsyncModelLoader(size_t completedCapacity)
+	: completed_(completedCapacity), worker_([this]() { WorkerMain(); }) {
+}
+
+AsyncModelLoader::~AsyncModelLoader() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+		for (const std::shared_ptr<ModelLoadJob>& job : pendingJobs_) {
+			job->control.cancelRequested = true;
+		}
+		if (currentJob_) {
+			currentJob_->control.cancelRequested = true;
+		}
+	}
+	condition_.notify_one();
+	worker_.join();
+}
+
+ModelLoadHandle AsyncModelLoader::Load(const std::string& directoryPath, const std::string& filename) {
+	auto job = std::make_shared<ModelLoadJob>();
+	job->directoryPath = directoryPath;
+	job->filename = filename;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pendingJobs_.push_back(job);
+	}
+	condition_.notify_one();
+	return ModelLoadHandle(job);
+}
+
+bool AsyncModelLoader::TryPopCompleted(LoadedModel& model) {
+	return completed_.TryPop(model);
+}
+
+void AsyncModelLoader::WorkerMain() {
+	for (;;) {
+		std::shared_ptr<ModelLoadJob> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return quit_ || !pendingJobs_.empty(); });
+			if (quit_) {
+				return;
+			}
+			job = std::move(pendingJobs_.front());
+			pendingJobs_.pop_front();
+			currentJob_ = job;
+		}
+
+		LoadedModel result;
+		result.directoryPath = job->directoryPath;
+		result.filename = job->filename;
+		//始まる前に中断されていたら、読まずに中断として返す
+		if (!job->control.cancelRequested) {
+			result.modelData = LoadObjFileCached(job->directoryPath, job->filename, &result.info, &job->control);
+		}
+		result.cancelled = job->control.cancelRequested;
+		if (result.cancelled) {
+			result.modelData = {};
+		}
+
+		//受け取る側が追いつくまで待つ。止めるときは結果を捨てる
+		while (!completed_.TryPush(std::move(result))) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (quit_) {
+				return;
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			currentJob_ = nullptr;
+		}
+		job->done = true;
+	}
+}
\ No newline at end of file
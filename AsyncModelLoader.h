@@ -0,0 +1,92 @@
+#pragma once
+#include "GraphicsData.h"
+#include "MeshCache.h"
+#include "ObjLoader.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 読み込み1件ぶんの、読み込みスレッドと呼び出し側で共有する状態
+struct ModelLoadJob {
+	std::string directoryPath;
+	std::string filename;
+	ObjLoadControl control;
+	std::atomic<bool> done{ false };  //結果が完了キューに入ったらtrue
+};
+
+// 読み込みが終わったモデル。中断されたときはmodelDataが空でcancelledがtrue
+struct LoadedModel {
+	std::string directoryPath;
+	std::string filename;
+	ModelData modelData;
+	MeshLoadInfo info;
+	bool cancelled = false;
+};
+
+/// <summary>
+/// AsyncModelLoader::Loadが返す、読み込み1件の進み具合の確認と中断のためのハンドル
+/// どのスレッドから呼んでもよい
+/// </summary>
+class ModelLoadHandle {
+public:
+	ModelLoadHandle() = default;
+	explicit ModelLoadHandle(std::shared_ptr<ModelLoadJob> job)
+		: job_(std::move(job)) {}
+
+	bool IsValid() const { return job_ != nullptr; }
+	// 結果が完了キューに入ったか
+	bool IsDone() const { return job_ && job_->done; }
+	// 読み終わったバイト数の割合(0~1)。まだファイルを開いていなければ0
+	float Progress() const;
+	uint64_t BytesParsed() const { return job_ ? job_->control.bytesParsed.load() : 0; }
+	uint64_t BytesTotal() const { return job_ ? job_->control.bytesTotal.load() : 0; }
+	uint64_t FacesParsed() const { return job_ ? job_->control.facesParsed.load() : 0; }
+	// 中断を要求する。すでに読み終わっていたら何もしない
+	void Cancel() {
+		if (job_) {
+			job_->control.cancelRequested = true;
+		}
+	}
+
+private:
+	std::shared_ptr<ModelLoadJob> job_;
+};
+
+/// <summary>
+/// 専用のスレッドでLoadObjFileCachedを呼んで、モデルを非同期に読み込む
+/// 読み込みは頼まれた順に1件ずつ行い(1件の中ではParallelForで並列に読む)、
+/// 結果はロックなしのキューに入れて、描画スレッドが毎フレームTryPopCompletedで受け取る
+/// 破棄すると、まだ終わっていない読み込みをすべて中断してスレッドを止める
+/// </summary>
+class AsyncModelLoader {
+public:
+	// completedCapacityは受け取られていない結果をいくつまで溜めるか(2のべき乗)。いっぱいなら読み込みスレッドが待つ
+	explicit AsyncModelLoader(size_t completedCapacity = 16);
+	~AsyncModelLoader();
+
+	AsyncModelLoader(const AsyncModelLoader&) = delete;
+	AsyncModelLoader& operator=(const AsyncModelLoader&) = delete;
+
+	// 読み込みを頼む。すぐに戻る
+	ModelLoadHandle Load(const std::string& directoryPath, const std::string& filename);
+
+	// 終わった読み込みがあれば1件取り出してtrueを返す。1つのスレッド(描画スレッド)からだけ呼ぶ
+	bool TryPopCompleted(LoadedModel& model);
+
+private:
+	void WorkerMain();
+
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::shared_ptr<ModelLoadJob>> pendingJobs_;  //mutex_で守る
+	bool quit_ = false;                                      //mutex_で守る
+	std::shared_ptr<ModelLoadJob> currentJob_;               //mutex_で守る。読み込み中のもの
+	SpscQueue<LoadedModel> completed_;
+	std::thread worker_;  //最後に作って最初に止めるので、最後に置く
+};
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "DescriptorAllocator.h"
+#include <cassert>
+
+DescriptorAllocator::DescriptorAllocator(uint32_t persistentCapacity, uint32_t transientCapacity)
+	: persistentCapacity_(persistentCapacity), generations_(persistentCapacity, 0), transient_(transientCapacity) {
+	assert(uint64_t(persistentCapacity) + transientCapacity < kInvalidIndex);
+}
+
+DescriptorHandle DescriptorAllocator::AllocatePersistent() {
+	uint32_t index;
+	if (!freeIndices_.empty()) {
+		index = freeIndices_.back();
+		freeIndices_.pop_back();
+	}
+	else if (neverUsed_ < persistentCapacity_) {
+		index = neverUsed_++;
+	}
+	else {
+		return {};
+	}
+	++generations_[index];
+	++persistentCount_;
+	return { index, generations_[index] };
+}
+
+void DescriptorAllocator::FreePersistent(DescriptorHandle handle) {
+	//二重解放や、別の場所を借りているハンドルでの解放
+	assert(IsAlive(handle));
+	if (!IsAlive(handle)) {
+		return;
+	}
+	++generations_[handle.index];
+	--persistentCount_;
+	framePendingFrees_.push_back(handle.index);
+}
+
+bool DescriptorAllocator::IsAlive(DescriptorHandle handle) const {
+	return handle.index < persistentCapacity_ && generations_[handle.index] == handle.generation && (handle.generation & 1) != 0;
+}
+
+uint32_t DescriptorAllocator::Resolve(DescriptorHandle handle) const {
+	//解放した後のハンドルを使っている
+	assert(IsAlive(handle));
+	return handle.index;
+}
+
+uint32_t DescriptorAllocator::AllocateTransient(uint32_t count) {
+	const uint64_t offset = transient_.Allocate(count, 1);
+	if (offset == UploadRingAllocator::kInvalidOffset) {
+		return kInvalidIndex;
+	}
+	return persistentCapacity_ + uint32_t(offset);
+}
+
+void DescriptorAllocator::FinishFrame(uint64_t fenceValue) {
+	for (uint32_t index : framePendingFrees_) {
+		pendingFrees_.push_back({ fenceValue, index });
+	}
+	framePendingFrees_.clear();
+	transient_.FinishFrame(fenceValue);
+}
+
+void DescriptorAllocator::Reclaim(uint64_t completedFenceValue) {
+	while (!pendingFrees_.empty() && pendingFrees_.front().fenceValue <= completedFenceValue) {
+		freeIndices_.push_back(pendingFrees_.front().index);
+		pendingFrees_.pop_front();
+	}
+	transient_.Reclaim(completedFenceValue);
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include "UploadRingAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// 常駐用のディスクリプタの場所。解放すると場所の世代が進むので、解放後に古いハンドルを使うとIsAliveがfalseになる
+struct DescriptorHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+};
+
+/// <summary>
+/// 1つのディスクリプタヒープの中の場所(インデックス)を決めるアロケータ。GPUのAPIには触らない
+/// 先頭persistentCapacity個はテクスチャなどの常駐用で、空きリストから1つずつ貸し出す
+/// 残りtransientCapacity個はフレームごとの一時用で、連続した範囲をリングから切り出す
+/// 解放した常駐用の場所と一時用の範囲は、そのフレームのフェンス値までGPUが進んでから再利用する
+/// 1フレームの流れ: Reclaim(完了したフェンス値) → Allocate/Freeを何回か → FinishFrame(このフレームでSignalする値)
+/// 1つのスレッド(描画スレッド)からだけ呼ぶ
+/// </summary>
+class DescriptorAllocator {
+public:
+	// 切り出せなかったときにAllocateTransientが返す値
+	static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+	DescriptorAllocator(uint32_t persistentCapacity, uint32_t transientCapacity);
+
+	// 常駐用の場所を1つ借りる。空きがなければindexがkInvalidIndexのハンドルを返す
+	DescriptorHandle AllocatePersistent();
+	// 常駐用の場所を返す。ハンドルはすぐに使えなくなり、場所は今のフレームをGPUが終えてから再利用する
+	void FreePersistent(DescriptorHandle handle);
+	// ハンドルがまだ解放されていないか
+	bool IsAlive(DescriptorHandle handle) const;
+	// ヒープの中のインデックスを返す。解放済みのハンドルを渡してはいけない
+	uint32_t Resolve(DescriptorHandle handle) const;
+
+	// このフレームだけ使う連続したcount個の場所を切り出して、先頭のインデックスを返す。足りなければkInvalidIndex
+	uint32_t AllocateTransient(uint32_t count);
+
+	// 前回のFinishFrameから後の解放と一時用の切り出しを、GPUがfenceValueまで進んだら再利用するものとして記録する
+	void FinishFrame(uint64_t fenceValue);
+	// フェンス値がcompletedFenceValue以下のフレームの分を再利用できるようにする
+	void Reclaim(uint64_t completedFenceValue);
+
+	// ヒープに必要なディスクリプタの数
+	uint32_t Capacity() const { return persistentCapacity_ + uint32_t(transient_.Capacity()); }
+	uint32_t PersistentCapacity() const { return persistentCapacity_; }
+	// 貸し出している常駐用の場所の数(GPUの完了を待っている解放済みの場所は含まない)
+	uint32_t PersistentCount() const { return persistentCount_; }
+	// まだ再利用できない一時用の場所の数
+	uint32_t TransientUsed() const { return uint32_t(transient_.UsedBytes()); }
+
+private:
+	// 解放されたがGPUの完了を待っている常駐用の場所
+	struct PendingFree {
+		uint64_t fenceValue;
+		uint32_t index;
+	};
+
+	uint32_t persistentCapacity_;
+	uint32_t persistentCount_ = 0;
+	uint32_t neverUsed_ = 0;                  //これより後ろの場所は一度も貸し出していない(空きリストに入れずに済ませる)
+	std::vector<uint32_t> generations_;       //場所ごとの世代。貸し出している間は奇数
+	std::vector<uint32_t> freeIndices_;       //再利用できる場所
+	std::vector<uint32_t> framePendingFrees_;  //今のフレームで解放した場所
+	std::deque<PendingFree> pendingFrees_;
+	UploadRingAllocator transient_;  //一時用の範囲。オフセットをインデックスとして使う
+};
\ No newline at end of file
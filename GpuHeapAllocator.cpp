@@ -0,0 +1,225 @@
+#include "GpuHeapAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+GpuHeapAllocator::GpuHeapAllocator(uint64_t blockSize)
+	: blockSize_(blockSize) {
+	assert(blockSize > 0);
+}
+
+std::vector<GpuHeapAllocator::Block>& GpuHeapAllocator::Blocks(uint32_t group) {
+	if (group >= groups_.size()) {
+		groups_.resize(group + 1);
+	}
+	return groups_[group];
+}
+
+GpuHeapAllocation GpuHeapAllocator::Allocate(uint32_t group, uint64_t size, uint64_t alignment) {
+	std::vector<Block>& blocks = Blocks(group);
+	auto record = [&](uint32_t blockIndex, const TlsfAllocation& allocation) {
+		Block& block = blocks[blockIndex];
+		if (allocation.node >= block.allocations.size()) {
+			block.allocations.resize(allocation.node + 1);
+		}
+		block.allocations[allocation.node] = allocation;
+		return GpuHeapAllocation{ group, blockIndex, allocation };
+	};
+
+	//今あるブロックに先頭から入れてみる
+	uint32_t emptySlot = UINT32_MAX;
+	for (uint32_t i = 0; i < blocks.size(); ++i) {
+		if (!blocks[i].allocator) {
+			emptySlot = (std::min)(emptySlot, i);
+			continue;
+		}
+		if (blocks[i].retired) {
+			continue;
+		}
+		const TlsfAllocation allocation = blocks[i].allocator->Allocate(size, alignment);
+		if (allocation.node != UINT32_MAX) {
+			return record(i, allocation);
+		}
+	}
+
+	//入らなければブロックを足す。ブロックの大きさより大きいものは専用のブロックにする
+	const uint64_t granularity = (std::max)(alignment, uint64_t(16));
+	const uint64_t newBlockSize = (std::max)(blockSize_, (size + granularity - 1) & ~(granularity - 1));
+	if (emptySlot == UINT32_MAX) {
+		emptySlot = uint32_t(blocks.size());
+		blocks.emplace_back();
+	}
+	blocks[emptySlot] = Block{ std::make_unique<TlsfAllocator>(newBlockSize), false, {} };
+	const TlsfAllocation allocation = blocks[emptySlot].allocator->Allocate(size, alignment);
+	assert(allocation.node != UINT32_MAX);
+	return record(emptySlot, allocation);
+}
+
+void GpuHeapAllocator::Free(const GpuHeapAllocation& allocation) {
+	assert(allocation.group < groups_.size() && allocation.block < groups_[allocation.group].size());
+	Block& block = groups_[allocation.group][allocation.block];
+	assert(block.allocator && allocation.allocation.node < block.allocations.size());
+	block.allocator->Free(block.allocations[allocation.allocation.node]);
+	block.allocations[allocation.allocation.node] = {};
+}
+
+uint32_t GpuHeapAllocator::BlockCount(uint32_t group) const {
+	return group < groups_.size() ? uint32_t(groups_[group].size()) : 0;
+}
+
+uint64_t GpuHeapAllocator::BlockSize(uint32_t group, uint32_t block) const {
+	if (group >= groups_.size() || block >= groups_[group].size() || !groups_[group][block].allocator) {
+		return 0;
+	}
+	return groups_[group][block].allocator->Capacity();
+}
+
+void GpuHeapAllocator::ReleaseEmptyBlocks(uint32_t group, std::vector<uint32_t>& releasedBlocks) {
+	std::vector<Block>& blocks = Blocks(group);
+	for (uint32_t i = 0; i < blocks.size(); ++i) {
+		if (blocks[i].allocator && blocks[i].allocator->AllocationCount() == 0) {
+			blocks[i] = Block{};
+			releasedBlocks.push_back(i);
+		}
+	}
+}
+
+std::vector<GpuHeapMove> GpuHeapAllocator::Defragment(uint32_t group, uint32_t maxMoves) {
+	std::vector<Block>& blocks = Blocks(group);
+	std::vector<GpuHeapMove> moves;
+
+	//使用量の少ないブロックから空にしてみる
+	std::vector<uint32_t> order;
+	for (uint32_t i = 0; i < blocks.size(); ++i) {
+		if (blocks[i].allocator && !blocks[i].retired && blocks[i].allocator->AllocationCount() > 0) {
+			order.push_back(i);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return blocks[a].allocator->UsedBytes() < blocks[b].allocator->UsedBytes();
+	});
+
+	for (uint32_t source : order) {
+		Block& sourceBlock = blocks[source];
+		if (moves.size() + sourceBlock.allocator->AllocationCount() > maxMoves) {
+			break;
+		}
+		//移し先は使用量の多いブロックから。入りきらなければこのブロックはあきらめて元に戻す
+		std::vector<uint32_t> destinations;
+		for (uint32_t i = 0; i < blocks.size(); ++i) {
+			if (i != source && blocks[i].allocator && !blocks[i].retired) {
+				destinations.push_back(i);
+			}
+		}
+		std::sort(destinations.begin(), destinations.end(), [&](uint32_t a, uint32_t b) {
+			return blocks[a].allocator->UsedBytes() > blocks[b].allocator->UsedBytes();
+		});
+
+		std::vector<GpuHeapMove> blockMoves;
+		bool fits = true;
+		for (const TlsfAllocation& allocation : sourceBlock.allocations) {
+			if (allocation.node == UINT32_MAX) {
+				continue;
+			}
+			const uint64_t alignment = sourceBlock.allocator->GetAlignment(allocation.node);
+			GpuHeapAllocation destination;
+			for (uint32_t i : destinations) {
+				const TlsfAllocation moved = blocks[i].allocator->Allocate(allocation.size, alignment);
+				if (moved.node != UINT32_MAX) {
+					destination = { group, i, moved };
+					break;
+				}
+			}
+			if (destination.block == UINT32_MAX) {
+				fits = false;
+				break;
+			}
+			blockMoves.push_back({ { group, source, allocation }, destination });
+		}
+		if (!fits) {
+			for (const GpuHeapMove& move : blockMoves) {
+				blocks[move.destination.block].allocator->Free(move.destination.allocation);
+			}
+			continue;
+		}
+
+		//移し先を記録して、元の範囲を返す。元のブロックは空になるので、ReleaseEmptyBlocksまで使わない
+		for (const GpuHeapMove& move : blockMoves) {
+			Block& destinationBlock = blocks[move.destination.block];
+			if (move.destination.allocation.node >= destinationBlock.allocations.size()) {
+				destinationBlock.allocations.resize(move.destination.allocation.node + 1);
+			}
+			destinationBlock.allocations[move.destination.allocation.node] = move.destination.allocation;
+			Free(move.source);
+			moves.push_back(move);
+		}
+		sourceBlock.retired = true;
+	}
+	return moves;
+}
+
+std::vector<TlsfMove> GpuHeapAllocator::CompactBlock(uint32_t group, uint32_t block) {
+	std::vector<Block>& blocks = Blocks(group);
+	assert(block < blocks.size() && blocks[block].allocator);
+	std::vector<TlsfMove> moves = blocks[block].allocator->Compact();
+	for (const TlsfMove& move : moves) {
+		blocks[block].allocations[move.node].offset = move.destinationOffset;
+	}
+	return moves;
+}
+
+GpuHeapStatistics GpuHeapAllocator::GetStatistics(uint32_t group) const {
+	GpuHeapStatistics statistics{};
+	if (group >= groups_.size()) {
+		return statistics;
+	}
+	uint64_t freeBytes = 0;
+	for (const Block& block : groups_[group]) {
+		if (!block.allocator) {
+			continue;
+		}
+		const TlsfStatistics blockStatistics = block.allocator->GetStatistics();
+		++statistics.blockCount;
+		statistics.capacity += blockStatistics.capacity;
+		statistics.usedBytes += blockStatistics.usedBytes;
+		statistics.largestFreeBlock = (std::max)(statistics.largestFreeBlock, blockStatistics.largestFreeBlock);
+		statistics.allocationCount += blockStatistics.allocationCount;
+		statistics.freeBlockCount += blockStatistics.freeBlockCount;
+		freeBytes += blockStatistics.freeBytes;
+	}
+	if (freeBytes > 0) {
+		statistics.fragmentation = 1.0f - float(double(statistics.largestFreeBlock) / double(freeBytes));
+	}
+	return statistics;
+}
+
+bool GpuHeapAllocator::Validate() const {
+	for (const std::vector<Block>& blocks : groups_) {
+		for (const Block& block : blocks) {
+			if (!block.allocator) {
+				if (block.retired || !block.allocations.empty()) {
+					return false;
+				}
+				continue;
+			}
+			if (!block.allocator->Validate()) {
+				return false;
+			}
+			//覚えている範囲の数・位置が、ブロックのアロケータの中と同じであること
+			uint32_t allocationCount = 0;
+			for (uint32_t node = 0; node < block.allocations.size(); ++node) {
+				const TlsfAllocation& allocation = block.allocations[node];
+				if (allocation.node == UINT32_MAX) {
+					continue;
+				}
+				if (allocation.node != node || allocation.offset != block.allocator->GetOffset(node) || allocation.offset + allocation.size > block.allocator->Capacity()) {
+					return false;
+				}
+				++allocationCount;
+			}
+			if (allocationCount != block.allocator->AllocationCount() || (block.retired && allocationCount != 0)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include "TlsfAllocator.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// GpuHeapAllocatorが貸し出した範囲。groupのblock番目のヒープの、allocation.offsetから
+struct GpuHeapAllocation {
+	uint32_t group = UINT32_MAX;
+	uint32_t block = UINT32_MAX;
+	TlsfAllocation allocation;
+};
+
+// Defragmentで別のヒープに移した範囲。呼び出し側はsourceの中身をdestinationに作ったリソースにコピーして付け替える
+struct GpuHeapMove {
+	GpuHeapAllocation source;       //Defragmentの中ですでに返してある。コピーが終わるまでsourceのヒープには何も置かれない
+	GpuHeapAllocation destination;
+};
+
+// 1つのグループの使い方
+struct GpuHeapStatistics {
+	uint32_t blockCount;
+	uint64_t capacity;
+	uint64_t usedBytes;
+	uint64_t largestFreeBlock;
+	uint32_t allocationCount;
+	uint32_t freeBlockCount;
+	float fragmentation;  //1 - largestFreeBlock / 空きの合計
+};
+
+/// <summary>
+/// 大きなヒープ(ブロック)をいくつも持ち、その中をTlsfAllocatorで切り分けて配置リソースの場所を決める
+/// ヒープはグループ(ヒープの種類・置けるリソースの種類・アラインメントの組み合わせ。番号は呼び出し側が決める)ごとに分ける
+/// GPUのAPIには触らないので、ブロックが増えたら呼び出し側がBlockSizeの大きさのヒープを作る
+/// </summary>
+class GpuHeapAllocator {
+public:
+	// blockSizeは新しく作るヒープの大きさ。それより大きいものは、ちょうどの大きさの専用ブロックに置く
+	explicit GpuHeapAllocator(uint64_t blockSize);
+
+	// 入るブロックがなければ新しいブロックを作る。ブロックの番号は再利用する
+	GpuHeapAllocation Allocate(uint32_t group, uint64_t size, uint64_t alignment);
+	void Free(const GpuHeapAllocation& allocation);
+
+	// groupのブロックの数(解放したブロックの番号も含む)と、block番目の大きさ(解放済みなら0)
+	uint32_t BlockCount(uint32_t group) const;
+	uint64_t BlockSize(uint32_t group, uint32_t block) const;
+
+	// 使っている範囲がなくなったブロックを解放して、その番号をreleasedBlocksに入れる。呼び出し側はそのヒープを破棄する
+	void ReleaseEmptyBlocks(uint32_t group, std::vector<uint32_t>& releasedBlocks);
+
+	// 使用率の低いブロックから順に、中身をすべて他のブロックに移せるなら移して空にする(最大maxMoves個まで)
+	// 移したブロックは、ReleaseEmptyBlocksまで新しく切り出す場所に使わない
+	std::vector<GpuHeapMove> Defragment(uint32_t group, uint32_t maxMoves = UINT32_MAX);
+	// 1つのブロックの中を先頭に詰める。動かした範囲はTlsfAllocator::Compactと同じ
+	std::vector<TlsfMove> CompactBlock(uint32_t group, uint32_t block);
+
+	GpuHeapStatistics GetStatistics(uint32_t group) const;
+
+	// 各ブロックのTlsfAllocatorと、覚えている範囲がそろっているかを調べる(テスト・デバッグ用。O(ブロック数))
+	bool Validate() const;
+
+private:
+	struct Block {
+		std::unique_ptr<TlsfAllocator> allocator;  //解放したブロックはnullptr
+		bool retired = false;                       //Defragmentで空にしたので、新しく切り出さない
+		std::vector<TlsfAllocation> allocations;    //Defragmentで移すために、使っている範囲を覚えておく(nodeの位置に入れる)
+	};
+
+	std::vector<Block>& Blocks(uint32_t group);
+
+	uint64_t blockSize_;
+	std::vector<std::vector<Block>> groups_;
+};
\ No newline at end of file
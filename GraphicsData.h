@@ -0,0 +1,87 @@
+#pragma once
+#include "MyMath.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GPUに送るデータ・モデルデータの構造体
+// 定数バッファの構造体はHLSL側(Object3d.VS.hlsl / Object3d.PS.hlsl)とレイアウトを合わせること
+
+struct VertexData {
+	Vector4 position;
+	Vector2 texcoord;
+	Vector3 normal;
+};
+
+// 圧縮した頂点(20byte)。VertexDataのwは常に1なので位置はfloat3にし、
+// 法線は八面体エンコードした2x16bit(SNORM)、UVはhalf2で持つ。作り方はVertexPacking.h
+// 入力レイアウトはR32G32B32_FLOAT / R16G16_SNORM / R16G16_FLOAT、VSはObject3dPacked.VS.hlsl
+struct PackedVertexData {
+	Vector3 position;
+	int16_t normal[2];
+	uint16_t texcoord[2];
+};
+
+struct Material {
+	Vector4 color;
+	int32_t enableLighting;
+	float padding[3];
+	Matrix2x4 uvTransform;
+};
+
+struct TransformationMatrix {
+	Matrix4x4 WVP;
+	Matrix3x4 World;
+};
+
+struct DirectionalLight {
+	Vector4 color;
+	Vector3 direction;
+	float intensity;
+};
+
+struct MaterialData {
+	std::string name;                             //newmtlの名前
+	Vector4 color = { 1.0f, 1.0f, 1.0f, 1.0f };  //Kd(rgb)とd(a)
+	std::string textureFilePath;                  //map_Kd。なければ空
+};
+
+// 同じマテリアルで描く三角形の範囲
+struct SubMesh {
+	uint32_t indexStart;     //indicesの中での開始位置
+	uint32_t indexCount;
+	uint32_t materialIndex;  //materialsの番号
+};
+
+// 近くの三角形をまとめた小さなかたまり。かたまりごとに視錐台・裏向き・大きさでカリングする
+struct Meshlet {
+	uint32_t indexStart;     //ModelData::indicesの中での開始位置
+	uint32_t triangleCount;
+	uint32_t vertexCount;
+	uint32_t materialIndex;
+	Vector3 center;          //バウンディングスフィア(モデル空間)
+	float radius;
+	Vector3 coneAxis;        //法線の向きの平均。法線がばらばらなときは0
+	float coneCutoff;        //法線の広がり(sin)。1なら裏向きカリングしない
+};
+
+// 簡略化したメッシュ1段分。頂点は全LODで共有し、インデックスだけが違う
+struct MeshLod {
+	std::vector<SubMesh> submeshes;  //ModelData::indicesの中の範囲
+	uint32_t triangleCount;
+	float error;                     //元の形からのずれ(モデル空間の距離)
+	std::vector<Meshlet> meshlets;   //BuildMeshletsで作る。空ならカリングせずにsubmeshesを描く
+};
+
+// 頂点は「位置/UV/法線」の組み合わせごとに1つだけ持ち、三角形はindicesで表す
+// indicesはマテリアルごとにまとまっていて、submeshes1つにつき1回の描画で描ける
+// lodsはGenerateMeshLodsで作る。lods[0]はsubmeshesと同じで、LOD1以降のインデックスはindicesの後ろにある
+// closedはIsClosedMeshで求める。閉じたメッシュだけ、メッシュレットの裏向きカリングをしてよい
+struct ModelData {
+	std::vector<VertexData>vertices;
+	std::vector<uint32_t>indices;
+	std::vector<MaterialData>materials;
+	std::vector<SubMesh>submeshes;
+	std::vector<MeshLod>lods;
+	bool closed = false;
+};
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "LodSelection.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+float ComputeLodPixelScale(float distance, float fovY, float screenHeight) {
+	//カメラに重なるほど近いときは一番細かいLODになるようにする
+	return screenHeight / (2.0f * std::tan(fovY * 0.5f) * (std::max)(distance, FLT_MIN));
+}
+
+uint32_t SelectLod(std::span<const float> lodErrors, float pixelScale, uint32_t currentLod, float thresholdPixels, float hysteresis) {
+	if (lodErrors.empty()) {
+		return 0;
+	}
+	//LODの数が減ったモデルに差し替えたときも、範囲に収めた段から始める
+	const uint32_t startLod = (std::min)(currentLod, static_cast<uint32_t>(lodErrors.size() - 1));
+	uint32_t lod = startLod;
+	const float finerThreshold = thresholdPixels * (1.0f + hysteresis);
+	const float coarserThreshold = thresholdPixels * (1.0f - hysteresis);
+	while (lod > 0 && lodErrors[lod] * pixelScale > finerThreshold) {
+		--lod;
+	}
+	if (lod == startLod) {
+		while (lod + 1 < lodErrors.size() && lodErrors[lod + 1] * pixelScale <= coarserThreshold) {
+			++lod;
+		}
+	}
+	return lod;
+}
\ No newline at end of file
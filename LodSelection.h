@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+// 画面上の大きさからLODを選ぶ
+
+// モデル空間での長さ1が、カメラからの距離distance・縦の画角fovY・画面の高さscreenHeight(ピクセル)で何ピクセルに見えるか
+// モデルを拡大しているときは、その倍率を掛けて使う
+float ComputeLodPixelScale(float distance, float fovY, float screenHeight);
+
+// lodErrors[i]はLODiの誤差(モデル空間の距離、LOD0から昇順)。誤差が画面上でthresholdPixels以下になる一番粗いLODを選ぶ
+// 境目でLODが毎フレーム切り替わらないように、粗くするのはthreshold×(1-hysteresis)以下になってから、
+// 細かくするのはthreshold×(1+hysteresis)を超えてから。currentLodには前のフレームで選んだLODを渡す
+uint32_t SelectLod(std::span<const float> lodErrors, float pixelScale, uint32_t currentLod, float thresholdPixels = 1.0f, float hysteresis = 0.25f);
\ No newline at end of file
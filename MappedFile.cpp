@@ -0,0 +1,94 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filePath) {
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	fileHandle_ = file;
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(file, &fileSize)) {
+		return;
+	}
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+	//サイズ0のファイルはマップできないので、開けた扱いにして終わる
+	if (size_ == 0) {
+		isOpen_ = true;
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		size_ = 0;
+		return;
+	}
+	mappingHandle_ = mapping;
+
+	data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr) {
+		size_ = 0;
+		return;
+	}
+	isOpen_ = true;
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	if (mappingHandle_) {
+		CloseHandle(mappingHandle_);
+	}
+	if (fileHandle_) {
+		CloseHandle(fileHandle_);
+	}
+}
+#else
+MappedFile::MappedFile(const std::string& filePath) {
+	fileDescriptor_ = open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor_ < 0) {
+		return;
+	}
+
+	struct stat fileStat = {};
+	if (fstat(fileDescriptor_, &fileStat) != 0) {
+		return;
+	}
+	size_ = static_cast<size_t>(fileStat.st_size);
+	//サイズ0のファイルはマップできないので、開けた扱いにして終わる
+	if (size_ == 0) {
+		isOpen_ = true;
+		return;
+	}
+
+	void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileDescriptor_, 0);
+	if (mapped == MAP_FAILED) {
+		size_ = 0;
+		return;
+	}
+	//先頭から順に読むことをOSに伝えて先読みさせる
+	madvise(mapped, size_, MADV_SEQUENTIAL);
+	data_ = static_cast<const char*>(mapped);
+	isOpen_ = true;
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		munmap(const_cast<char*>(data_), size_);
+	}
+	if (fileDescriptor_ >= 0) {
+		close(fileDescriptor_);
+	}
+}
+#endif
\ No newline at end of file
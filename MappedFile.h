@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// 読み取り専用でメモリマップしたファイル
+/// ファイル全体をコピーせずにそのままメモリとして読める。破棄するとマップも閉じる
+/// </summary>
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& filePath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// 開けたかどうか(空のファイルも開けた扱い)
+	bool IsOpen() const { return isOpen_; }
+	const char* Data() const { return data_; }
+	size_t Size() const { return size_; }
+	std::string_view View() const { return { data_, size_ }; }
+
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+	bool isOpen_ = false;
+#ifdef _WIN32
+	void* fileHandle_ = nullptr;
+	void* mappingHandle_ = nullptr;
+#else
+	int fileDescriptor_ = -1;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+/// <summary>
+/// 2x4行列(UV変換用)
+/// 4x4行列の左2列を転置して詰めたもの。2次元の拡縮・回転・平行移動だけを32byteで持てる
+/// HLSLではrow_majorのfloat2x4としてmul(M, float4(uv, 0, 1))で使う
+/// </summary>
+struct Matrix2x4 final {
+	float m[2][4];
+};
\ No newline at end of file
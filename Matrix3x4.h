@@ -0,0 +1,10 @@
+#pragma once
+
+/// <summary>
+/// 3x4行列(アフィン変換用)
+/// 4x4行列の左3列を転置して詰めたもの。4列目が常に(0,0,0,1)になるワールド行列などを16byte少なく持てる
+/// HLSLではrow_majorのfloat3x4としてmul(M, float4(pos, 1))で使う
+/// </summary>
+struct Matrix3x4 final {
+	float m[3][4];
+};
\ No newline at end of file
@@ -1,4 +1,7 @@
 #pragma once
-struct Matrix4x4 {
+/// <summary>
+/// 4x4行列
+/// </summary>
+struct Matrix4x4 final {
 	float m[4][4];
-};
\ No newline at end of file
+};
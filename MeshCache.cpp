@@ -0,0 +1,393 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "ObjLoader.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+// キャッシュファイル(.cmesh)の形式
+// ヘッダーのあとに各セクションを16byte境界で並べる。数値はすべて実行環境のエンディアンのまま
+// 頂点・インデックスはGPUに送る形そのままなので、読むときは解析せずにコピーするだけでよい
+namespace {
+
+constexpr char kCookedMeshMagic[4] = { 'C', 'M', 'S', 'H' };
+constexpr uint32_t kCookedMeshVersion = 7;  //形式を変えたら上げる。違うものは作り直す
+constexpr uint64_t kSectionAlignment = 16;
+
+struct CookedMeshSection {
+	uint64_t offset;  //ファイル先頭からの位置
+	uint64_t count;   //要素数
+};
+
+struct CookedMeshHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t vertexStride;
+	uint32_t indexStride;
+	uint32_t closed;    //1なら閉じたメッシュ(ModelData::closed)
+	uint32_t reserved;
+	uint64_t fileSize;
+	double cookMilliseconds;
+	MeshOptimizationReport optimization;  //ログ表示用。キャッシュから読んだときも作ったときの値を出す
+	CookedMeshSection vertices;   //VertexData
+	CookedMeshSection indices;    //uint32_t
+	CookedMeshSection submeshes;  //CookedSubmesh。LOD0のあとにLOD1以降のものが続く
+	CookedMeshSection lods;       //CookedLod
+	CookedMeshSection meshlets;   //Meshlet。LODの順に並べる
+	CookedMeshSection materials;  //CookedMaterial
+	CookedMeshSection sources;    //CookedSource
+	CookedMeshSection strings;    //char。パスなどの文字列をまとめたもの
+};
+
+// 同じマテリアルで描く三角形の範囲
+struct CookedSubmesh {
+	uint32_t indexStart;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+	uint32_t reserved;
+};
+
+// LOD1段分。submeshes・meshletsセクションの中の範囲
+struct CookedLod {
+	uint32_t submeshStart;
+	uint32_t submeshCount;
+	uint32_t meshletStart;
+	uint32_t meshletCount;
+	uint32_t triangleCount;
+	float error;
+};
+
+struct CookedString {
+	uint32_t offset;  //stringsセクション内の位置
+	uint32_t length;
+};
+
+struct CookedMaterial {
+	CookedString name;
+	float color[4];
+	CookedString textureFilePath;
+};
+
+// キャッシュを作ったときの元ファイル(obj・mtl)の状態
+struct CookedSource {
+	uint64_t size;
+	int64_t writeTime;
+	uint64_t hash;
+	CookedString path;
+};
+
+// FNV-1a(64bit)
+uint64_t HashBytes(const char* data, size_t size) {
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= static_cast<uint8_t>(data[i]);
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+bool GetFileStatus(const std::string& path, uint64_t& size, int64_t& writeTime) {
+	std::error_code error;
+	size = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	writeTime = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+	return !error;
+}
+
+// 書き出し用のバッファ
+class CookedMeshWriter {
+public:
+	// セクションを16byte境界に揃えて追加する
+	template<typename T>
+	CookedMeshSection AddSection(std::span<const T> elements) {
+		buffer_.resize((buffer_.size() + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment, 0);
+		CookedMeshSection section = { buffer_.size(), elements.size() };
+		const char* bytes = reinterpret_cast<const char*>(elements.data());
+		buffer_.insert(buffer_.end(), bytes, bytes + elements.size_bytes());
+		return section;
+	}
+	std::vector<char>& Buffer() { return buffer_; }
+
+private:
+	std::vector<char> buffer_;
+};
+
+CookedString AddString(std::vector<char>& strings, const std::string& string) {
+	CookedString result = { static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(string.size()) };
+	strings.insert(strings.end(), string.begin(), string.end());
+	return result;
+}
+
+bool WriteCookedMesh(const std::string& cachePath, const ModelData& modelData, const std::vector<std::string>& sourceFiles, double cookMilliseconds, const MeshOptimizationReport& optimization) {
+	std::vector<char> strings;
+
+	std::vector<CookedSubmesh> submeshes;
+	for (const SubMesh& submesh : modelData.submeshes) {
+		submeshes.push_back({ submesh.indexStart, submesh.indexCount, submesh.materialIndex, 0 });
+	}
+	//LOD0はsubmeshesと同じなので、範囲だけ指す
+	std::vector<CookedLod> lods;
+	std::vector<Meshlet> meshlets;
+	for (size_t i = 0; i < modelData.lods.size(); ++i) {
+		const MeshLod& lod = modelData.lods[i];
+		CookedLod cookedLod = {
+			0, static_cast<uint32_t>(modelData.submeshes.size()),
+			static_cast<uint32_t>(meshlets.size()), static_cast<uint32_t>(lod.meshlets.size()),
+			lod.triangleCount, lod.error };
+		meshlets.insert(meshlets.end(), lod.meshlets.begin(), lod.meshlets.end());
+		if (i != 0) {
+			cookedLod.submeshStart = static_cast<uint32_t>(submeshes.size());
+			cookedLod.submeshCount = static_cast<uint32_t>(lod.submeshes.size());
+			for (const SubMesh& submesh : lod.submeshes) {
+				submeshes.push_back({ submesh.indexStart, submesh.indexCount, submesh.materialIndex, 0 });
+			}
+		}
+		lods.push_back(cookedLod);
+	}
+	std::vector<CookedMaterial> materials;
+	for (const MaterialData& material : modelData.materials) {
+		materials.push_back({
+			AddString(strings, material.name),
+			{ material.color.x, material.color.y, material.color.z, material.color.w },
+			AddString(strings, material.textureFilePath) });
+	}
+
+	std::vector<CookedSource> sources;
+	for (const std::string& sourcePath : sourceFiles) {
+		CookedSource source = {};
+		if (!GetFileStatus(sourcePath, source.size, source.writeTime)) {
+			return false;
+		}
+		MappedFile sourceFile(sourcePath);
+		if (!sourceFile.IsOpen()) {
+			return false;
+		}
+		source.hash = HashBytes(sourceFile.Data(), sourceFile.Size());
+		source.path = AddString(strings, sourcePath);
+		sources.push_back(source);
+	}
+
+	CookedMeshWriter writer;
+	CookedMeshHeader header = {};
+	writer.AddSection(std::span<const CookedMeshHeader>(&header, 1));
+	std::memcpy(header.magic, kCookedMeshMagic, sizeof(header.magic));
+	header.version = kCookedMeshVersion;
+	header.vertexStride = sizeof(VertexData);
+	header.indexStride = sizeof(uint32_t);
+	header.closed = modelData.closed ? 1 : 0;
+	header.cookMilliseconds = cookMilliseconds;
+	header.optimization = optimization;
+	header.vertices = writer.AddSection(std::span<const VertexData>(modelData.vertices));
+	header.indices = writer.AddSection(std::span<const uint32_t>(modelData.indices));
+	header.submeshes = writer.AddSection(std::span<const CookedSubmesh>(submeshes));
+	header.lods = writer.AddSection(std::span<const CookedLod>(lods));
+	header.meshlets = writer.AddSection(std::span<const Meshlet>(meshlets));
+	header.materials = writer.AddSection(std::span<const CookedMaterial>(materials));
+	header.sources = writer.AddSection(std::span<const CookedSource>(sources));
+	header.strings = writer.AddSection(std::span<const char>(strings));
+	header.fileSize = writer.Buffer().size();
+	std::memcpy(writer.Buffer().data(), &header, sizeof(header));
+
+	//書きかけのファイルを読まないように、別名で書いてから置き換える
+	const std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+		file.write(writer.Buffer().data(), static_cast<std::streamsize>(writer.Buffer().size()));
+		if (!file) {
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	return !error;
+}
+
+// セクションが範囲内に収まっているか確かめて、先頭を返す
+template<typename T>
+const T* GetSection(const MappedFile& file, const CookedMeshSection& section) {
+	if (section.offset % alignof(T) != 0 || section.offset > file.Size() || section.count > (file.Size() - section.offset) / sizeof(T)) {
+		return nullptr;
+	}
+	return reinterpret_cast<const T*>(file.Data() + section.offset);
+}
+
+enum class CookedMeshStatus {
+	Valid,          //そのまま使える
+	SourceTouched,  //元ファイルの更新日時だけ変わっていて中身は同じ。使えるが書き直しておく
+	Invalid,        //作り直す
+};
+
+CookedMeshStatus ReadCookedMesh(const std::string& cachePath, ModelData& modelData, std::vector<std::string>& sourceFiles, double& cookMilliseconds, MeshOptimizationReport& optimization) {
+	MappedFile file(cachePath);
+	if (!file.IsOpen() || file.Size() < sizeof(CookedMeshHeader)) {
+		return CookedMeshStatus::Invalid;
+	}
+	const CookedMeshHeader& header = *reinterpret_cast<const CookedMeshHeader*>(file.Data());
+	if (std::memcmp(header.magic, kCookedMeshMagic, sizeof(header.magic)) != 0 || header.version != kCookedMeshVersion ||
+		header.vertexStride != sizeof(VertexData) || header.indexStride != sizeof(uint32_t) || header.fileSize != file.Size()) {
+		return CookedMeshStatus::Invalid;
+	}
+	const VertexData* vertices = GetSection<VertexData>(file, header.vertices);
+	const uint32_t* indices = GetSection<uint32_t>(file, header.indices);
+	const CookedSubmesh* submeshes = GetSection<CookedSubmesh>(file, header.submeshes);
+	const CookedLod* lods = GetSection<CookedLod>(file, header.lods);
+	const Meshlet* meshlets = GetSection<Meshlet>(file, header.meshlets);
+	const CookedMaterial* materials = GetSection<CookedMaterial>(file, header.materials);
+	const CookedSource* sources = GetSection<CookedSource>(file, header.sources);
+	const char* strings = GetSection<char>(file, header.strings);
+	if (!vertices || !indices || !submeshes || !lods || !meshlets || !materials || !sources || !strings || header.lods.count == 0) {
+		return CookedMeshStatus::Invalid;
+	}
+	for (uint64_t i = 0; i < header.submeshes.count; ++i) {
+		const CookedSubmesh& submesh = submeshes[i];
+		if (submesh.materialIndex >= header.materials.count || uint64_t(submesh.indexStart) + submesh.indexCount > header.indices.count) {
+			return CookedMeshStatus::Invalid;
+		}
+	}
+	for (uint64_t i = 0; i < header.lods.count; ++i) {
+		if (uint64_t(lods[i].submeshStart) + lods[i].submeshCount > header.submeshes.count ||
+			uint64_t(lods[i].meshletStart) + lods[i].meshletCount > header.meshlets.count) {
+			return CookedMeshStatus::Invalid;
+		}
+	}
+	for (uint64_t i = 0; i < header.meshlets.count; ++i) {
+		if (uint64_t(meshlets[i].indexStart) + uint64_t(meshlets[i].triangleCount) * 3 > header.indices.count) {
+			return CookedMeshStatus::Invalid;
+		}
+	}
+	//インデックスはそのままGPUとCPU側の処理(カリングなど)で頂点を引くのに使うので、壊れていれば作り直す
+	for (uint64_t i = 0; i < header.indices.count; ++i) {
+		if (indices[i] >= header.vertices.count) {
+			return CookedMeshStatus::Invalid;
+		}
+	}
+	auto getString = [&](const CookedString& string) -> std::string {
+		if (uint64_t(string.offset) + string.length > header.strings.count) {
+			return {};
+		}
+		return std::string(strings + string.offset, string.length);
+	};
+
+	//元ファイルが変わっていないか確かめる。サイズと更新日時が同じならそのまま、日時だけ違えば中身を比べる
+	CookedMeshStatus status = CookedMeshStatus::Valid;
+	for (uint64_t i = 0; i < header.sources.count; ++i) {
+		const CookedSource& source = sources[i];
+		const std::string sourcePath = getString(source.path);
+		uint64_t size;
+		int64_t writeTime;
+		if (!GetFileStatus(sourcePath, size, writeTime) || size != source.size) {
+			return CookedMeshStatus::Invalid;
+		}
+		if (writeTime != source.writeTime) {
+			MappedFile sourceFile(sourcePath);
+			if (!sourceFile.IsOpen() || HashBytes(sourceFile.Data(), sourceFile.Size()) != source.hash) {
+				return CookedMeshStatus::Invalid;
+			}
+			status = CookedMeshStatus::SourceTouched;
+		}
+		sourceFiles.push_back(sourcePath);
+	}
+
+	//頂点とインデックスはGPUに送る形のままなので、まとめてコピーするだけ
+	modelData.vertices.assign(vertices, vertices + header.vertices.count);
+	modelData.indices.assign(indices, indices + header.indices.count);
+	modelData.materials.resize(header.materials.count);
+	for (uint64_t i = 0; i < header.materials.count; ++i) {
+		const CookedMaterial& material = materials[i];
+		modelData.materials[i].name = getString(material.name);
+		modelData.materials[i].color = { material.color[0], material.color[1], material.color[2], material.color[3] };
+		modelData.materials[i].textureFilePath = getString(material.textureFilePath);
+	}
+	modelData.lods.resize(header.lods.count);
+	for (uint64_t i = 0; i < header.lods.count; ++i) {
+		const CookedLod& lod = lods[i];
+		modelData.lods[i].triangleCount = lod.triangleCount;
+		modelData.lods[i].error = lod.error;
+		for (uint32_t j = 0; j < lod.submeshCount; ++j) {
+			const CookedSubmesh& submesh = submeshes[lod.submeshStart + j];
+			modelData.lods[i].submeshes.push_back({ submesh.indexStart, submesh.indexCount, submesh.materialIndex });
+		}
+		modelData.lods[i].meshlets.assign(meshlets + lod.meshletStart, meshlets + lod.meshletStart + lod.meshletCount);
+	}
+	modelData.submeshes = modelData.lods[0].submeshes;
+	modelData.closed = header.closed != 0;
+	cookMilliseconds = header.cookMilliseconds;
+	optimization = header.optimization;
+	return status;
+}
+
+}
+
+ModelData LoadObjFileCached(const std::string& directoryPath, const std::string& filename, MeshLoadInfo* info, ObjLoadControl* control) {
+	const auto start = std::chrono::steady_clock::now();
+	auto elapsedMilliseconds = [&]() {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+	const std::string cachePath = directoryPath + "/" + filename + ".cmesh";
+
+	ModelData modelData;
+	std::vector<std::string> sourceFiles;
+	double cookMilliseconds = 0.0;
+	MeshOptimizationReport optimization = {};
+	CookedMeshStatus status = ReadCookedMesh(cachePath, modelData, sourceFiles, cookMilliseconds, optimization);
+	if (status != CookedMeshStatus::Invalid) {
+		if (status == CookedMeshStatus::SourceTouched) {
+			//次回は中身を比べずに済むように、今の更新日時で書き直しておく
+			WriteCookedMesh(cachePath, modelData, sourceFiles, cookMilliseconds, optimization);
+		}
+		if (control) {
+			//キャッシュからは一度に読めるので、objを全部読み終わったことにする
+			uint64_t size = 0;
+			int64_t writeTime = 0;
+			GetFileStatus(directoryPath + "/" + filename, size, writeTime);
+			control->bytesTotal = size;
+			control->bytesParsed = size;
+			control->facesParsed = modelData.lods[0].triangleCount;
+		}
+		if (info) {
+			*info = { true, elapsedMilliseconds(), cookMilliseconds, optimization };
+		}
+		return modelData;
+	}
+
+	//キャッシュがないか古いので、objから読んで作り直す。書き出せなくても読み込み自体は成功させる
+	modelData = {};
+	sourceFiles.clear();
+	modelData = LoadObjFile(directoryPath, filename, 0, &sourceFiles, control);
+	auto isCancelled = [&]() { return control && control->cancelRequested; };
+	if (isCancelled()) {
+		return {};
+	}
+	//キャッシュに書くのは一度だけなので、頂点キャッシュ・重ね塗り・頂点フェッチの最適化とLOD・メッシュレットの生成もここで行う
+	//最適化の前後の解析(ソフトウェアラスタライズを含む)もここで一度だけ行い、キャッシュに残す
+	OptimizeMesh(modelData, &optimization);
+	if (isCancelled()) {
+		return {};
+	}
+	//簡略化は開いた縁を動かさないので、LOD0が閉じていればLOD1以降も閉じている
+	modelData.closed = IsClosedMesh(modelData, modelData.submeshes);
+	GenerateMeshLods(modelData);
+	if (isCancelled()) {
+		return {};
+	}
+	for (MeshLod& lod : modelData.lods) {
+		lod.meshlets = BuildMeshlets(modelData, lod.submeshes);
+	}
+	cookMilliseconds = elapsedMilliseconds();
+	WriteCookedMesh(cachePath, modelData, sourceFiles, cookMilliseconds, optimization);
+	if (info) {
+		*info = { false, elapsedMilliseconds(), cookMilliseconds, optimization };
+	}
+	return modelData;
+}
\ No newline at end of file
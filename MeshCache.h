@@ -0,0 +1,22 @@
+#pragma once
+#include "GraphicsData.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+#include <string>
+
+// 読み込みにかかった時間など(ログ表示用)
+struct MeshLoadInfo {
+	bool fromCache = false;         //キャッシュから読んだか
+	double loadMilliseconds = 0.0;  //今回の読み込みにかかった時間
+	double cookMilliseconds = 0.0;  //objから読んでキャッシュを作ったときにかかった時間
+	MeshOptimizationReport optimization = {};  //キャッシュを作ったときのOptimizeMeshの前後の頂点キャッシュ効率・重ね塗り(LOD0)
+};
+
+// キャッシュ付きでobjファイルを読む
+// 初回はobjを読んでOptimizeMeshで最適化、IsClosedMeshで閉じているかを調べ、GenerateMeshLodsでLOD、BuildMeshletsでメッシュレットを作り、
+// 「ファイル名.cmesh」にバイナリで書き出す。次回からはそれをメモリマップして読む
+// obj・mtlのサイズか更新日時が変わっていたら中身のハッシュを比べ、違っていれば作り直す
+// キャッシュの各範囲とインデックスが頂点数を超えていないかも確かめ、壊れていれば作り直す
+// controlを渡すと進み具合を書き込む。中断されたら空のModelDataを返し、キャッシュは書かない
+// 作り直すときの最適化・LOD・メッシュレットの生成は途中では止めず、各段階の間で中断を確認する
+ModelData LoadObjFileCached(const std::string& directoryPath, const std::string& filename, MeshLoadInfo* info = nullptr, ObjLoadControl* control = nullptr);
\ No newline at end of file
@@ -0,0 +1,395 @@
+#include "MeshOptimizer.h"
+#include "MyMath.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// ACMRの計算と重ね塗りの最適化で使う、GPUの頂点キャッシュを想定したサイズ
+constexpr uint32_t kFifoCacheSize = 16;
+
+// FIFOの頂点キャッシュ。タイムスタンプで「最近cacheSize回の中に入ったか」を判定する
+class FifoCache {
+public:
+	FifoCache(size_t vertexCount, uint32_t cacheSize)
+		: timestamps_(vertexCount, 0), cacheSize_(cacheSize), time_(cacheSize + 1) {
+	}
+	// 空にする
+	void Clear() {
+		time_ += cacheSize_ + 1;
+	}
+	// 入っていなければ追加してtrue(キャッシュミス)を返す
+	bool Access(uint32_t vertex) {
+		if (time_ - timestamps_[vertex] > cacheSize_) {
+			timestamps_[vertex] = time_++;
+			return true;
+		}
+		return false;
+	}
+
+private:
+	std::vector<uint32_t> timestamps_;
+	uint32_t cacheSize_;
+	uint32_t time_;
+};
+
+#pragma region Forsythのスコア
+constexpr int32_t kForsythCacheSize = 32;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+// キャッシュ内の位置(入っていなければ-1)と、まだ描いていない三角形の数から頂点のスコアを求める
+float ForsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles) {
+	if (remainingTriangles == 0) {
+		return -1.0f;
+	}
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			//直前の三角形の頂点は、同じ三角形ばかり続かないように一定値にする
+			score = kLastTriangleScore;
+		}
+		else {
+			const float scaler = 1.0f / (kForsythCacheSize - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+		}
+	}
+	//残りが少ない頂点を優先して、取り残される三角形を減らす
+	score += kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+	return score;
+}
+#pragma endregion
+
+Vector3 ToVector3(const Vector4& v) {
+	return { v.x, v.y, v.z };
+}
+
+}
+
+#pragma region 解析
+VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+	assert(indices.size() % 3 == 0);
+	VertexCacheStatistics result = {};
+	if (indices.empty()) {
+		return result;
+	}
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> used(vertexCount, false);
+	size_t misses = 0;
+	size_t usedCount = 0;
+	for (uint32_t index : indices) {
+		misses += cache.Access(index) ? 1 : 0;
+		if (!used[index]) {
+			used[index] = true;
+			++usedCount;
+		}
+	}
+	result.acmr = float(misses) / float(indices.size() / 3);
+	result.atvr = float(misses) / float(usedCount);
+	return result;
+}
+
+OverdrawStatistics AnalyzeOverdraw(std::span<const VertexData> vertices, std::span<const uint32_t> indices) {
+	assert(indices.size() % 3 == 0);
+	OverdrawStatistics result = {};
+	if (indices.empty()) {
+		return result;
+	}
+	constexpr int32_t kResolution = 256;
+
+	//バウンディングボックスの一番長い辺を画面いっぱいにする
+	Vector3 minPosition = { FLT_MAX, FLT_MAX, FLT_MAX };
+	Vector3 maxPosition = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t index : indices) {
+		const Vector4& p = vertices[index].position;
+		minPosition = { (std::min)(minPosition.x, p.x), (std::min)(minPosition.y, p.y), (std::min)(minPosition.z, p.z) };
+		maxPosition = { (std::max)(maxPosition.x, p.x), (std::max)(maxPosition.y, p.y), (std::max)(maxPosition.z, p.z) };
+	}
+	const float extent = (std::max)({ maxPosition.x - minPosition.x, maxPosition.y - minPosition.y, maxPosition.z - minPosition.z, FLT_MIN });
+	const float scale = (kResolution - 1) / extent;
+
+	std::vector<float> depthBuffer(kResolution * kResolution);
+	for (int32_t axis = 0; axis < 3; ++axis) {
+		for (float direction : { 1.0f, -1.0f }) {
+			std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+			for (size_t triangle = 0; triangle < indices.size(); triangle += 3) {
+				//axis方向から見たときの画面座標(u,v)と深度
+				float u[3], v[3], depth[3];
+				for (int32_t corner = 0; corner < 3; ++corner) {
+					const Vector4& p = vertices[indices[triangle + corner]].position;
+					const float coordinates[3] = { p.x - minPosition.x, p.y - minPosition.y, p.z - minPosition.z };
+					u[corner] = coordinates[(axis + 1) % 3] * scale;
+					v[corner] = coordinates[(axis + 2) % 3] * scale;
+					depth[corner] = coordinates[axis] * direction;
+				}
+				const float area = (u[1] - u[0]) * (v[2] - v[0]) - (u[2] - u[0]) * (v[1] - v[0]);
+				if (area == 0.0f) {
+					continue;
+				}
+				const int32_t minU = (std::max)(0, int32_t(std::floor((std::min)({ u[0], u[1], u[2] }))));
+				const int32_t maxU = (std::min)(kResolution - 1, int32_t(std::ceil((std::max)({ u[0], u[1], u[2] }))));
+				const int32_t minV = (std::max)(0, int32_t(std::floor((std::min)({ v[0], v[1], v[2] }))));
+				const int32_t maxV = (std::min)(kResolution - 1, int32_t(std::ceil((std::max)({ v[0], v[1], v[2] }))));
+				//ピクセル中心が三角形の内側にあるかをエッジ関数で判定する(向きによらず判定できるようにareaで割る)
+				for (int32_t y = minV; y <= maxV; ++y) {
+					for (int32_t x = minU; x <= maxU; ++x) {
+						const float px = x + 0.5f;
+						const float py = y + 0.5f;
+						const float w0 = ((u[2] - u[1]) * (py - v[1]) - (v[2] - v[1]) * (px - u[1])) / area;
+						const float w1 = ((u[0] - u[2]) * (py - v[2]) - (v[0] - v[2]) * (px - u[2])) / area;
+						const float w2 = 1.0f - w0 - w1;
+						if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+							continue;
+						}
+						const float z = w0 * depth[0] + w1 * depth[1] + w2 * depth[2];
+						float& stored = depthBuffer[y * kResolution + x];
+						if (z <= stored) {
+							stored = z;
+							++result.pixelsShaded;
+						}
+					}
+				}
+			}
+			for (float stored : depthBuffer) {
+				result.pixelsCovered += stored != FLT_MAX ? 1 : 0;
+			}
+		}
+	}
+	result.overdraw = result.pixelsCovered ? float(result.pixelsShaded) / float(result.pixelsCovered) : 0.0f;
+	return result;
+}
+#pragma endregion
+
+
+#pragma region 頂点キャッシュ最適化
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount) {
+	assert(indices.size() % 3 == 0);
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	//頂点ごとに、その頂点を使う三角形の一覧を作る
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices) {
+		++remaining[index];
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remaining[vertex];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		vertexScores[vertex] = ForsythVertexScore(-1, remaining[vertex]);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	std::vector<uint32_t> cache;
+	cache.reserve(kForsythCacheSize + 3);
+	std::vector<uint32_t> newCache;
+	newCache.reserve(kForsythCacheSize + 3);
+	size_t scanCursor = 0;
+
+	int64_t bestTriangle = -1;
+	while (output.size() < indices.size()) {
+		//キャッシュ内の頂点から候補が見つからなければ、まだ描いていない最初の三角形から始め直す
+		//(全体からスコア最大を探すと三角形数の2乗の時間がかかるので、元の順番を頼りにする)
+		if (bestTriangle < 0) {
+			while (emitted[scanCursor]) {
+				++scanCursor;
+			}
+			bestTriangle = static_cast<int64_t>(scanCursor);
+		}
+
+		//三角形を出力して、その頂点をキャッシュの先頭に入れる
+		const uint32_t* triangleIndices = &indices[size_t(bestTriangle) * 3];
+		emitted[size_t(bestTriangle)] = true;
+		newCache.assign(triangleIndices, triangleIndices + 3);
+		for (int32_t corner = 0; corner < 3; ++corner) {
+			const uint32_t vertex = triangleIndices[corner];
+			output.push_back(vertex);
+			//使い終わった三角形を隣接リストの後ろに寄せて、残りの数を減らす
+			uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+			uint32_t* end = begin + remaining[vertex];
+			uint32_t* found = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+			std::swap(*found, *(end - 1));
+			--remaining[vertex];
+		}
+		for (uint32_t vertex : cache) {
+			if (vertex != newCache[0] && vertex != newCache[1] && vertex != newCache[2]) {
+				newCache.push_back(vertex);
+			}
+		}
+		//キャッシュからあふれた頂点は、キャッシュ外としてスコアを更新しておく
+		for (size_t i = 0; i < newCache.size(); ++i) {
+			cachePositions[newCache[i]] = i < size_t(kForsythCacheSize) ? static_cast<int32_t>(i) : -1;
+		}
+		if (newCache.size() > size_t(kForsythCacheSize)) {
+			for (size_t i = kForsythCacheSize; i < newCache.size(); ++i) {
+				vertexScores[newCache[i]] = ForsythVertexScore(-1, remaining[newCache[i]]);
+			}
+			newCache.resize(kForsythCacheSize);
+		}
+		cache.swap(newCache);
+
+		//キャッシュ内の頂点のスコアを更新し、その頂点を使う三角形から次の候補を選ぶ
+		for (uint32_t vertex : cache) {
+			vertexScores[vertex] = ForsythVertexScore(cachePositions[vertex], remaining[vertex]);
+		}
+		bestTriangle = -1;
+		float bestScore = -FLT_MAX;
+		for (uint32_t vertex : cache) {
+			for (uint32_t a = 0; a < remaining[vertex]; ++a) {
+				const uint32_t triangle = adjacency[adjacencyOffsets[vertex] + a];
+				const float score = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = triangle;
+				}
+			}
+		}
+	}
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+#pragma endregion
+
+
+#pragma region 重ね塗り最適化
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const VertexData> vertices, float threshold) {
+	assert(indices.size() % 3 == 0);
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	//1.三角形を前から順にクラスタに分ける。クラスタごとに空のキャッシュから描いたときのACMRが
+	//  全体のACMRのthreshold倍以下になったところで区切るので、クラスタをどう並べ替えてもキャッシュ効率の悪化はその範囲に収まる
+	const float maxClusterAcmr = AnalyzeVertexCache(indices, vertices.size(), kFifoCacheSize).acmr * threshold;
+	std::vector<uint32_t> clusterStarts;
+	{
+		FifoCache cache(vertices.size(), kFifoCacheSize);
+		size_t clusterStart = 0;
+		size_t clusterMisses = 0;
+		clusterStarts.push_back(0);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+			for (int32_t corner = 0; corner < 3; ++corner) {
+				clusterMisses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+			}
+			const size_t clusterTriangles = triangle + 1 - clusterStart;
+			if (triangle + 1 < triangleCount && float(clusterMisses) <= maxClusterAcmr * float(clusterTriangles)) {
+				clusterStarts.push_back(static_cast<uint32_t>(triangle + 1));
+				clusterStart = triangle + 1;
+				clusterMisses = 0;
+				cache.Clear();
+			}
+		}
+	}
+	const size_t clusterCount = clusterStarts.size();
+	clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+	//2.クラスタの中心と向き(面積で重みをつけた平均)から、メッシュの中心に対してどれだけ外を向いているかを求める
+	Vector3 meshCenter = {};
+	float meshArea = 0.0f;
+	std::vector<Vector3> clusterCenters(clusterCount);
+	std::vector<Vector3> clusterNormals(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+		Vector3 center = {};
+		Vector3 normal = {};
+		float clusterArea = 0.0f;
+		for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle) {
+			const Vector3 p0 = ToVector3(vertices[indices[triangle * 3]].position);
+			const Vector3 p1 = ToVector3(vertices[indices[triangle * 3 + 1]].position);
+			const Vector3 p2 = ToVector3(vertices[indices[triangle * 3 + 2]].position);
+			//大きさが面積の2倍の法線
+			const Vector3 areaNormal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+			const float area = std::sqrt(Dot(areaNormal, areaNormal));
+			const Vector3 triangleCenter = { (p0.x + p1.x + p2.x) / 3.0f, (p0.y + p1.y + p2.y) / 3.0f, (p0.z + p1.z + p2.z) / 3.0f };
+			center = Add(center, { triangleCenter.x * area, triangleCenter.y * area, triangleCenter.z * area });
+			normal = Add(normal, areaNormal);
+			clusterArea += area;
+		}
+		meshCenter = Add(meshCenter, center);
+		meshArea += clusterArea;
+		const float inverseArea = clusterArea > 0.0f ? 1.0f / clusterArea : 0.0f;
+		clusterCenters[cluster] = { center.x * inverseArea, center.y * inverseArea, center.z * inverseArea };
+		const float normalLength = std::sqrt(Dot(normal, normal));
+		clusterNormals[cluster] = normalLength > 0.0f ? Vector3{ normal.x / normalLength, normal.y / normalLength, normal.z / normalLength } : Vector3{};
+	}
+	if (meshArea > 0.0f) {
+		meshCenter = { meshCenter.x / meshArea, meshCenter.y / meshArea, meshCenter.z / meshArea };
+	}
+
+	//3.外を向いているクラスタほど手前にあることが多いので先に描く
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+		sortKeys[cluster] = Dot(Subtract(clusterCenters[cluster], meshCenter), clusterNormals[cluster]);
+	}
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (uint32_t cluster : order) {
+		output.insert(output.end(), indices.begin() + size_t(clusterStarts[cluster]) * 3, indices.begin() + size_t(clusterStarts[cluster + 1]) * 3);
+	}
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+#pragma endregion
+
+
+#pragma region 頂点フェッチ最適化
+void OptimizeVertexFetch(ModelData& modelData) {
+	constexpr uint32_t kUnused = (std::numeric_limits<uint32_t>::max)();
+	std::vector<uint32_t> remap(modelData.vertices.size(), kUnused);
+	std::vector<VertexData> vertices;
+	vertices.reserve(modelData.vertices.size());
+	for (uint32_t& index : modelData.indices) {
+		if (remap[index] == kUnused) {
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(modelData.vertices[index]);
+		}
+		index = remap[index];
+	}
+	modelData.vertices = std::move(vertices);
+}
+#pragma endregion
+
+
+void OptimizeMesh(ModelData& modelData, MeshOptimizationReport* report) {
+	//解析(特に重ね塗り)は最適化そのものより重いので、求められたときだけ行う
+	if (report) {
+		report->vertexCacheBefore = AnalyzeVertexCache(modelData.indices, modelData.vertices.size());
+		report->overdrawBefore = AnalyzeOverdraw(modelData.vertices, modelData.indices);
+	}
+
+	for (const SubMesh& submesh : modelData.submeshes) {
+		std::span<uint32_t> indices(modelData.indices.data() + submesh.indexStart, submesh.indexCount);
+		OptimizeVertexCache(indices, modelData.vertices.size());
+		OptimizeOverdraw(indices, modelData.vertices);
+	}
+	OptimizeVertexFetch(modelData);
+
+	if (report) {
+		report->vertexCacheAfter = AnalyzeVertexCache(modelData.indices, modelData.vertices.size());
+		report->overdrawAfter = AnalyzeOverdraw(modelData.vertices, modelData.indices);
+	}
+}
\ No newline at end of file
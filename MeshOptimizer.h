@@ -0,0 +1,46 @@
+#pragma once
+#include "GraphicsData.h"
+#include <cstdint>
+#include <span>
+
+// 頂点キャッシュの効率
+struct VertexCacheStatistics {
+	float acmr;  //三角形1つあたりの頂点シェーダー実行回数(0.5~3。小さいほどよい)
+	float atvr;  //使われている頂点1つあたりの頂点シェーダー実行回数(1以上。1に近いほどよい)
+};
+
+// 重ね塗りの量
+struct OverdrawStatistics {
+	uint64_t pixelsCovered;  //最終的に何かが描かれているピクセル数
+	uint64_t pixelsShaded;   //深度テストを通ってピクセルシェーダーが動いた回数
+	float overdraw;          //pixelsShaded / pixelsCovered(1以上。1に近いほどよい)
+};
+
+// OptimizeMeshの前後の比較
+struct MeshOptimizationReport {
+	VertexCacheStatistics vertexCacheBefore;
+	VertexCacheStatistics vertexCacheAfter;
+	OverdrawStatistics overdrawBefore;
+	OverdrawStatistics overdrawAfter;
+};
+
+// 頂点キャッシュ(FIFO)をシミュレーションしてACMR・ATVRを求める
+VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+// ±x・±y・±zの6方向から正射影でソフトウェアラスタライズして重ね塗りの量を求める
+// 描画と同じくカリングなし、深度テストは描画順で行う(Early-Z相当)
+OverdrawStatistics AnalyzeOverdraw(std::span<const VertexData> vertices, std::span<const uint32_t> indices);
+
+// 頂点キャッシュに乗りやすい順に三角形を並べ替える(Forsythのアルゴリズム)
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+// OptimizeVertexCacheの結果を、キャッシュ効率がthreshold倍まで悪くなるのを許してクラスタに分け、
+// 外側を向いているクラスタから先に描くように並べ替えて重ね塗りを減らす
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const VertexData> vertices, float threshold = 1.05f);
+
+// 頂点を、インデックスで最初に使われる順に並べ替える。使われていない頂点は取り除く
+void OptimizeVertexFetch(ModelData& modelData);
+
+// サブメッシュごとにOptimizeVertexCache→OptimizeOverdrawを行い、最後にOptimizeVertexFetchを行う
+// サブメッシュの範囲とマテリアルは変わらない。reportを渡すと前後の解析結果を入れる
+void OptimizeMesh(ModelData& modelData, MeshOptimizationReport* report = nullptr);
\ No newline at end of file
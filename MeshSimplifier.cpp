@@ -0,0 +1,572 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "MyMath.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kInvalidIndex = (std::numeric_limits<uint32_t>::max)();
+// 開いた縁・継ぎ目の辺に置く平面の重み。大きいほどその線から外れる縮約が高くなる
+constexpr double kConstraintWeight = 10.0;
+// 縮約の前後で面の法線の内積(の割合)がこれ以下になるものは、裏返りとみなして行わない
+constexpr float kFlipThreshold = 0.25f;
+// 1段でこの割合までしか減らなければ、それ以上LODを作らない
+constexpr float kMinLodReduction = 0.9f;
+
+// 平面からの距離の2乗の和(面積で重み付け)を表す対称4x4行列と、重みの合計
+struct Quadric {
+	double a00, a01, a02, a11, a12, a22;
+	double b0, b1, b2;
+	double c;
+	double weight;
+};
+
+// dot(normal, p) + distance = 0 の平面(normalは単位ベクトル)
+Quadric MakePlaneQuadric(const Vector3& normal, float distance, double weight) {
+	const double x = normal.x;
+	const double y = normal.y;
+	const double z = normal.z;
+	const double d = distance;
+	return {
+		weight * x * x, weight * x * y, weight * x * z, weight * y * y, weight * y * z, weight * z * z,
+		weight * x * d, weight * y * d, weight * z * d,
+		weight * d * d,
+		weight };
+}
+
+void AddQuadric(Quadric& q, const Quadric& other) {
+	q.a00 += other.a00;
+	q.a01 += other.a01;
+	q.a02 += other.a02;
+	q.a11 += other.a11;
+	q.a12 += other.a12;
+	q.a22 += other.a22;
+	q.b0 += other.b0;
+	q.b1 += other.b1;
+	q.b2 += other.b2;
+	q.c += other.c;
+	q.weight += other.weight;
+}
+
+// 点pでの誤差。重みの合計で割って、平面からの距離の2乗の平均にする
+double EvaluateQuadric(const Quadric& q, const Vector3& p) {
+	const double x = p.x;
+	const double y = p.y;
+	const double z = p.z;
+	const double error =
+		q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+		2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+		2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+	return q.weight > 0.0 ? (std::max)(error, 0.0) / q.weight : 0.0;
+}
+
+// 位置をビット列のまま比べるためのキー
+struct PositionKey {
+	uint32_t x;
+	uint32_t y;
+	uint32_t z;
+
+	bool operator==(const PositionKey&) const = default;
+};
+
+struct PositionKeyHash {
+	size_t operator()(const PositionKey& key) const {
+		uint64_t hash = (uint64_t(key.x) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(key.y) * 0xC2B2AE3D27D4EB4Full) ^ (uint64_t(key.z) * 0x165667B19E3779F9ull);
+		return size_t(hash ^ (hash >> 32));
+	}
+};
+
+enum class PositionKind : uint8_t {
+	Manifold,  //周りの面がすべてつながっている。どの辺に沿っても縮約できる
+	Border,    //開いた縁か継ぎ目の線の上。その線に沿ってだけ縮約できる
+	Locked,    //縁や継ぎ目が交わる角など。動かさない
+};
+
+enum class EdgeKind {
+	None,         //辺がない
+	Interior,     //2つの面が同じ頂点を共有している
+	Constraint,   //開いた縁か、UV・法線・マテリアルの継ぎ目
+	NonManifold,  //3つ以上の面が共有している
+};
+
+// 位置fromを位置toに寄せる縮約の候補
+struct Collapse {
+	double cost;
+	uint32_t from;
+	uint32_t to;
+
+	bool operator>(const Collapse& other) const {
+		return std::tie(cost, from, to) > std::tie(other.cost, other.from, other.to);
+	}
+};
+
+// 辺の縮約による簡略化。同じ位置の頂点(継ぎ目で分かれたもの)をまとめて1つの「位置」として扱い、
+// 位置を既存の位置に寄せていく。Simplifyを繰り返し呼ぶと、前回の続きからさらに減らす
+class QuadricSimplifier {
+public:
+	QuadricSimplifier(std::span<const uint32_t> indices, std::span<const uint32_t> triangleGroups, std::span<const VertexData> vertices, const MeshSimplifySettings& settings);
+
+	// 三角形数がtargetTriangleCount以下になるか、縮約できる辺がなくなるまで減らす
+	void Simplify(size_t targetTriangleCount);
+	size_t TriangleCount() const { return triangleCount_; }
+	// 今までの縮約の誤差の最大(平面からの距離の2乗平均の平方根を、モデル空間の距離に戻したもの)
+	float Error() const { return static_cast<float>(std::sqrt(maxCollapseError_) * scale_); }
+	// グループgroupの残っている三角形を、元の順番でindicesの後ろに足す
+	void AppendIndices(uint32_t group, std::vector<uint32_t>& indices) const;
+
+private:
+	int32_t FindCorner(uint32_t triangle, uint32_t position) const;
+	EdgeKind ClassifyEdge(uint32_t a, uint32_t b) const;
+	void GatherNeighbors(uint32_t position, std::vector<uint32_t>& neighbors) const;
+	bool EvaluateCollapse(uint32_t from, uint32_t to, double& cost, double& geometricError);
+	bool CheckLinkCondition(uint32_t from, uint32_t to);
+	void PushCollapse(uint32_t from, uint32_t to);
+	void ApplyCollapse(uint32_t from, uint32_t to, double geometricError);
+
+	std::span<const VertexData> vertices_;
+	MeshSimplifySettings settings_;
+	double scale_ = 1.0;                       //正規化した座標からモデル空間に戻す倍率
+	std::vector<uint32_t> vertexPositions_;    //頂点→位置の番号
+	std::vector<Vector3> positions_;           //バウンディングボックスの一番長い辺が1になるように正規化した位置
+	std::vector<Quadric> quadrics_;
+	std::vector<PositionKind> kinds_;
+	std::vector<std::vector<uint32_t>> positionTriangles_;  //位置を使っている三角形(消えたものも含む)
+	std::vector<std::array<uint32_t, 3>> triangles_;
+	std::vector<uint32_t> triangleGroups_;
+	std::vector<bool> triangleAlive_;
+	size_t triangleCount_ = 0;
+	double maxCollapseError_ = 0.0;
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue_;
+	std::vector<std::pair<uint32_t, uint32_t>> wedgeMap_;  //EvaluateCollapseで求めた、fromの頂点→toの頂点
+	uint32_t sharedTriangles_ = 0;                         //EvaluateCollapseで求めた、辺を共有する三角形の数
+	std::vector<uint32_t> fromNeighbors_;
+	std::vector<uint32_t> toNeighbors_;
+};
+
+QuadricSimplifier::QuadricSimplifier(std::span<const uint32_t> indices, std::span<const uint32_t> triangleGroups, std::span<const VertexData> vertices, const MeshSimplifySettings& settings)
+	: vertices_(vertices), settings_(settings) {
+	assert(indices.size() % 3 == 0);
+
+	//メッシュの大きさに依らない誤差にするため、バウンディングボックスの一番長い辺を1にする
+	Vector3 minPosition = { FLT_MAX, FLT_MAX, FLT_MAX };
+	Vector3 maxPosition = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t index : indices) {
+		const Vector4& p = vertices[index].position;
+		minPosition = { (std::min)(minPosition.x, p.x), (std::min)(minPosition.y, p.y), (std::min)(minPosition.z, p.z) };
+		maxPosition = { (std::max)(maxPosition.x, p.x), (std::max)(maxPosition.y, p.y), (std::max)(maxPosition.z, p.z) };
+	}
+	scale_ = (std::max)({ maxPosition.x - minPosition.x, maxPosition.y - minPosition.y, maxPosition.z - minPosition.z, FLT_MIN });
+	const float inverseScale = static_cast<float>(1.0 / scale_);
+
+	//同じ位置の頂点(UV・法線の継ぎ目で分かれたもの)を1つの位置にまとめる
+	vertexPositions_.assign(vertices.size(), kInvalidIndex);
+	std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positionMap;
+	for (uint32_t index : indices) {
+		if (vertexPositions_[index] != kInvalidIndex) {
+			continue;
+		}
+		const Vector4& p = vertices[index].position;
+		//-0と+0を同じ位置にするため、0を足してから比べる
+		const PositionKey key = { std::bit_cast<uint32_t>(p.x + 0.0f), std::bit_cast<uint32_t>(p.y + 0.0f), std::bit_cast<uint32_t>(p.z + 0.0f) };
+		auto [it, inserted] = positionMap.try_emplace(key, static_cast<uint32_t>(positions_.size()));
+		if (inserted) {
+			positions_.push_back({ (p.x - minPosition.x) * inverseScale, (p.y - minPosition.y) * inverseScale, (p.z - minPosition.z) * inverseScale });
+		}
+		vertexPositions_[index] = it->second;
+	}
+	const size_t positionCount = positions_.size();
+
+	//位置が重なってつぶれている三角形は最初から除く
+	positionTriangles_.resize(positionCount);
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+		const uint32_t p0 = vertexPositions_[triangle[0]];
+		const uint32_t p1 = vertexPositions_[triangle[1]];
+		const uint32_t p2 = vertexPositions_[triangle[2]];
+		if (p0 == p1 || p1 == p2 || p2 == p0) {
+			continue;
+		}
+		const uint32_t triangleIndex = static_cast<uint32_t>(triangles_.size());
+		triangles_.push_back(triangle);
+		triangleGroups_.push_back(triangleGroups.empty() ? 0 : triangleGroups[i / 3]);
+		positionTriangles_[p0].push_back(triangleIndex);
+		positionTriangles_[p1].push_back(triangleIndex);
+		positionTriangles_[p2].push_back(triangleIndex);
+	}
+	triangleAlive_.assign(triangles_.size(), true);
+	triangleCount_ = triangles_.size();
+
+	//面の平面を面積で重み付けして3つの位置に足す
+	quadrics_.assign(positionCount, Quadric{});
+	for (const std::array<uint32_t, 3>& triangle : triangles_) {
+		const Vector3& p0 = positions_[vertexPositions_[triangle[0]]];
+		const Vector3& p1 = positions_[vertexPositions_[triangle[1]]];
+		const Vector3& p2 = positions_[vertexPositions_[triangle[2]]];
+		Vector3 normal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+		const float length = std::sqrt(Dot(normal, normal));
+		if (length == 0.0f) {
+			continue;
+		}
+		normal = { normal.x / length, normal.y / length, normal.z / length };
+		const Quadric quadric = MakePlaneQuadric(normal, -Dot(normal, p0), length * 0.5);
+		for (uint32_t vertex : triangle) {
+			AddQuadric(quadrics_[vertexPositions_[vertex]], quadric);
+		}
+	}
+
+	//縁・継ぎ目の辺には、面に垂直で辺を通る平面を足して、線から外れる縮約の誤差を大きくする
+	for (const std::array<uint32_t, 3>& triangle : triangles_) {
+		for (uint32_t corner = 0; corner < 3; ++corner) {
+			const uint32_t a = vertexPositions_[triangle[corner]];
+			const uint32_t b = vertexPositions_[triangle[(corner + 1) % 3]];
+			const EdgeKind kind = ClassifyEdge(a, b);
+			if (kind != EdgeKind::Constraint && kind != EdgeKind::NonManifold) {
+				continue;
+			}
+			const Vector3& pa = positions_[a];
+			const Vector3& pc = positions_[vertexPositions_[triangle[(corner + 2) % 3]]];
+			const Vector3 edge = Subtract(positions_[b], pa);
+			const Vector3 faceNormal = Cross(edge, Subtract(pc, pa));
+			Vector3 normal = Cross(edge, faceNormal);
+			const float length = std::sqrt(Dot(normal, normal));
+			if (length == 0.0f) {
+				continue;
+			}
+			normal = { normal.x / length, normal.y / length, normal.z / length };
+			const Quadric quadric = MakePlaneQuadric(normal, -Dot(normal, pa), kConstraintWeight * Dot(edge, edge));
+			AddQuadric(quadrics_[a], quadric);
+			AddQuadric(quadrics_[b], quadric);
+		}
+	}
+
+	//縁・継ぎ目の辺がちょうど2本なら線の上、それ以外(角や枝分かれ)は動かさない
+	kinds_.assign(positionCount, PositionKind::Manifold);
+	std::vector<uint32_t> neighbors;
+	for (uint32_t position = 0; position < positionCount; ++position) {
+		GatherNeighbors(position, neighbors);
+		uint32_t constraintCount = 0;
+		bool locked = false;
+		for (uint32_t neighbor : neighbors) {
+			const EdgeKind kind = ClassifyEdge(position, neighbor);
+			constraintCount += kind == EdgeKind::Constraint ? 1 : 0;
+			locked = locked || kind == EdgeKind::NonManifold;
+		}
+		if (locked || (constraintCount != 0 && constraintCount != 2)) {
+			kinds_[position] = PositionKind::Locked;
+		}
+		else if (constraintCount == 2) {
+			kinds_[position] = PositionKind::Border;
+		}
+	}
+
+	//すべての辺について、両方向の縮約を候補にする
+	for (uint32_t position = 0; position < positionCount; ++position) {
+		GatherNeighbors(position, neighbors);
+		for (uint32_t neighbor : neighbors) {
+			PushCollapse(position, neighbor);
+		}
+	}
+}
+
+int32_t QuadricSimplifier::FindCorner(uint32_t triangle, uint32_t position) const {
+	for (int32_t corner = 0; corner < 3; ++corner) {
+		if (vertexPositions_[triangles_[triangle][corner]] == position) {
+			return corner;
+		}
+	}
+	return -1;
+}
+
+EdgeKind QuadricSimplifier::ClassifyEdge(uint32_t a, uint32_t b) const {
+	uint32_t count = 0;
+	uint32_t first = kInvalidIndex;
+	bool seam = false;
+	for (uint32_t triangle : positionTriangles_[a]) {
+		if (!triangleAlive_[triangle]) {
+			continue;
+		}
+		const int32_t cornerB = FindCorner(triangle, b);
+		if (cornerB < 0) {
+			continue;
+		}
+		const int32_t cornerA = FindCorner(triangle, a);
+		if (count == 0) {
+			first = triangle;
+		}
+		else {
+			//辺の両側で頂点(UV・法線)かマテリアルが違えば継ぎ目
+			seam = seam ||
+				triangles_[triangle][cornerA] != triangles_[first][FindCorner(first, a)] ||
+				triangles_[triangle][cornerB] != triangles_[first][FindCorner(first, b)] ||
+				triangleGroups_[triangle] != triangleGroups_[first];
+		}
+		++count;
+	}
+	if (count == 0) {
+		return EdgeKind::None;
+	}
+	if (count > 2) {
+		return EdgeKind::NonManifold;
+	}
+	return (count == 1 || seam) ? EdgeKind::Constraint : EdgeKind::Interior;
+}
+
+void QuadricSimplifier::GatherNeighbors(uint32_t position, std::vector<uint32_t>& neighbors) const {
+	neighbors.clear();
+	for (uint32_t triangle : positionTriangles_[position]) {
+		if (!triangleAlive_[triangle]) {
+			continue;
+		}
+		for (uint32_t vertex : triangles_[triangle]) {
+			if (vertexPositions_[vertex] != position) {
+				neighbors.push_back(vertexPositions_[vertex]);
+			}
+		}
+	}
+	std::sort(neighbors.begin(), neighbors.end());
+	neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+bool QuadricSimplifier::EvaluateCollapse(uint32_t from, uint32_t to, double& cost, double& geometricError) {
+	if (kinds_[from] == PositionKind::Locked) {
+		return false;
+	}
+	if (kinds_[from] == PositionKind::Border && ClassifyEdge(from, to) != EdgeKind::Constraint) {
+		return false;
+	}
+
+	//fromの頂点ごとに、辺を共有する三角形でのtoの頂点を対応させる(継ぎ目の両側をそれぞれ寄せる)
+	wedgeMap_.clear();
+	uint32_t sharedTriangles = 0;
+	for (uint32_t triangle : positionTriangles_[from]) {
+		if (!triangleAlive_[triangle]) {
+			continue;
+		}
+		const int32_t cornerTo = FindCorner(triangle, to);
+		if (cornerTo < 0) {
+			continue;
+		}
+		++sharedTriangles;
+		const uint32_t fromVertex = triangles_[triangle][FindCorner(triangle, from)];
+		const uint32_t toVertex = triangles_[triangle][cornerTo];
+		auto it = std::find_if(wedgeMap_.begin(), wedgeMap_.end(), [&](const auto& pair) { return pair.first == fromVertex; });
+		if (it == wedgeMap_.end()) {
+			wedgeMap_.push_back({ fromVertex, toVertex });
+		}
+		else if (it->second != toVertex) {
+			return false;
+		}
+	}
+	if (sharedTriangles == 0) {
+		return false;
+	}
+	sharedTriangles_ = sharedTriangles;
+
+	//辺を共有しない三角形の頂点も、すべて行き先が決まっていなければならない
+	const Vector3& target = positions_[to];
+	for (uint32_t triangle : positionTriangles_[from]) {
+		if (!triangleAlive_[triangle] || FindCorner(triangle, to) >= 0) {
+			continue;
+		}
+		const int32_t cornerFrom = FindCorner(triangle, from);
+		const uint32_t fromVertex = triangles_[triangle][cornerFrom];
+		if (std::none_of(wedgeMap_.begin(), wedgeMap_.end(), [&](const auto& pair) { return pair.first == fromVertex; })) {
+			return false;
+		}
+
+		//面が裏返ったり、つぶれたりしないか
+		Vector3 p[3];
+		for (int32_t corner = 0; corner < 3; ++corner) {
+			p[corner] = positions_[vertexPositions_[triangles_[triangle][corner]]];
+		}
+		const Vector3 oldNormal = Cross(Subtract(p[1], p[0]), Subtract(p[2], p[0]));
+		p[cornerFrom] = target;
+		const Vector3 newNormal = Cross(Subtract(p[1], p[0]), Subtract(p[2], p[0]));
+		if (Dot(oldNormal, newNormal) <= kFlipThreshold * std::sqrt(Dot(oldNormal, oldNormal) * Dot(newNormal, newNormal))) {
+			return false;
+		}
+	}
+
+	Quadric quadric = quadrics_[from];
+	AddQuadric(quadric, quadrics_[to]);
+	geometricError = EvaluateQuadric(quadric, target);
+	if (geometricError > double(settings_.maxError) * settings_.maxError) {
+		return false;
+	}
+
+	//寄せた頂点のUV・法線がどれだけ変わるか
+	double attributeError = 0.0;
+	for (const auto& [fromVertex, toVertex] : wedgeMap_) {
+		const VertexData& a = vertices_[fromVertex];
+		const VertexData& b = vertices_[toVertex];
+		const Vector3 normalDifference = Subtract(a.normal, b.normal);
+		const float du = a.texcoord.x - b.texcoord.x;
+		const float dv = a.texcoord.y - b.texcoord.y;
+		attributeError = (std::max)(attributeError,
+			double(settings_.normalWeight) * Dot(normalDifference, normalDifference) + double(settings_.texcoordWeight) * (du * du + dv * dv));
+	}
+	cost = geometricError + attributeError;
+	return true;
+}
+
+bool QuadricSimplifier::CheckLinkCondition(uint32_t from, uint32_t to) {
+	//fromとtoの両方につながっている位置が、辺を挟む三角形の頂点より多いと、縮約で面が重なる
+	GatherNeighbors(from, fromNeighbors_);
+	GatherNeighbors(to, toNeighbors_);
+	uint32_t commonNeighbors = 0;
+	for (size_t i = 0, j = 0; i < fromNeighbors_.size() && j < toNeighbors_.size();) {
+		if (fromNeighbors_[i] < toNeighbors_[j]) {
+			++i;
+		}
+		else if (toNeighbors_[j] < fromNeighbors_[i]) {
+			++j;
+		}
+		else {
+			++commonNeighbors;
+			++i;
+			++j;
+		}
+	}
+	return commonNeighbors <= sharedTriangles_;
+}
+
+void QuadricSimplifier::PushCollapse(uint32_t from, uint32_t to) {
+	double cost;
+	double geometricError;
+	if (EvaluateCollapse(from, to, cost, geometricError)) {
+		queue_.push({ cost, from, to });
+	}
+}
+
+void QuadricSimplifier::ApplyCollapse(uint32_t from, uint32_t to, double geometricError) {
+	for (uint32_t triangle : positionTriangles_[from]) {
+		if (!triangleAlive_[triangle]) {
+			continue;
+		}
+		//辺を共有していた三角形はつぶれるので消す
+		if (FindCorner(triangle, to) >= 0) {
+			triangleAlive_[triangle] = false;
+			--triangleCount_;
+			continue;
+		}
+		uint32_t& vertex = triangles_[triangle][FindCorner(triangle, from)];
+		vertex = std::find_if(wedgeMap_.begin(), wedgeMap_.end(), [&](const auto& pair) { return pair.first == vertex; })->second;
+		positionTriangles_[to].push_back(triangle);
+	}
+	positionTriangles_[from] = {};
+	std::erase_if(positionTriangles_[to], [&](uint32_t triangle) { return !triangleAlive_[triangle]; });
+	AddQuadric(quadrics_[to], quadrics_[from]);
+	maxCollapseError_ = (std::max)(maxCollapseError_, geometricError);
+
+	//toの周りの辺は誤差が変わったので、候補を入れ直す
+	std::vector<uint32_t> neighbors;
+	GatherNeighbors(to, neighbors);
+	for (uint32_t neighbor : neighbors) {
+		PushCollapse(to, neighbor);
+		PushCollapse(neighbor, to);
+	}
+}
+
+void QuadricSimplifier::Simplify(size_t targetTriangleCount) {
+	while (triangleCount_ > targetTriangleCount && !queue_.empty()) {
+		const Collapse collapse = queue_.top();
+		queue_.pop();
+		if (positionTriangles_[collapse.from].empty() || positionTriangles_[collapse.to].empty()) {
+			continue;
+		}
+		double cost;
+		double geometricError;
+		if (!EvaluateCollapse(collapse.from, collapse.to, cost, geometricError)) {
+			continue;
+		}
+		//候補に入れたあとで周りが縮約されて高くなっていたら、入れ直して順番を待つ
+		if (cost > collapse.cost * (1.0 + 1e-6) + 1e-12) {
+			queue_.push({ cost, collapse.from, collapse.to });
+			continue;
+		}
+		//周りのつながりを調べるのは重いので、実際に縮約する直前だけにする
+		if (!CheckLinkCondition(collapse.from, collapse.to)) {
+			continue;
+		}
+		ApplyCollapse(collapse.from, collapse.to, geometricError);
+	}
+}
+
+void QuadricSimplifier::AppendIndices(uint32_t group, std::vector<uint32_t>& indices) const {
+	for (size_t triangle = 0; triangle < triangles_.size(); ++triangle) {
+		if (triangleAlive_[triangle] && triangleGroups_[triangle] == group) {
+			indices.insert(indices.end(), triangles_[triangle].begin(), triangles_[triangle].end());
+		}
+	}
+}
+
+}
+
+std::vector<uint32_t> SimplifyMesh(std::span<const uint32_t> indices, std::span<const VertexData> vertices, size_t targetIndexCount, const MeshSimplifySettings& settings, float* resultError) {
+	QuadricSimplifier simplifier(indices, {}, vertices, settings);
+	simplifier.Simplify(targetIndexCount / 3);
+	std::vector<uint32_t> result;
+	result.reserve(simplifier.TriangleCount() * 3);
+	simplifier.AppendIndices(0, result);
+	if (resultError) {
+		*resultError = simplifier.Error();
+	}
+	return result;
+}
+
+void GenerateMeshLods(ModelData& modelData, const MeshSimplifySettings& settings) {
+	//前に作ったLODが残っていれば捨てて、LOD0の範囲だけにする
+	modelData.lods.clear();
+	uint32_t indexCount = 0;
+	uint32_t triangleCount = 0;
+	for (const SubMesh& submesh : modelData.submeshes) {
+		indexCount = (std::max)(indexCount, submesh.indexStart + submesh.indexCount);
+		triangleCount += submesh.indexCount / 3;
+	}
+	modelData.indices.resize(indexCount);
+	modelData.lods.push_back({ modelData.submeshes, triangleCount, 0.0f, {} });
+	if (triangleCount == 0 || settings.maxLodCount <= 1) {
+		return;
+	}
+
+	//三角形がどのサブメッシュのものか。サブメッシュの境目は継ぎ目として扱われる
+	std::vector<uint32_t> triangleGroups(indexCount / 3, kInvalidIndex);
+	for (uint32_t i = 0; i < modelData.submeshes.size(); ++i) {
+		const SubMesh& submesh = modelData.submeshes[i];
+		std::fill_n(triangleGroups.begin() + submesh.indexStart / 3, submesh.indexCount / 3, i);
+	}
+
+	QuadricSimplifier simplifier(modelData.indices, triangleGroups, modelData.vertices, settings);
+	for (uint32_t lod = 1; lod < settings.maxLodCount; ++lod) {
+		const uint32_t previousTriangleCount = modelData.lods.back().triangleCount;
+		simplifier.Simplify(static_cast<size_t>(previousTriangleCount * settings.reductionRatio));
+		if (simplifier.TriangleCount() == 0 || simplifier.TriangleCount() > previousTriangleCount * kMinLodReduction) {
+			break;
+		}
+
+		MeshLod meshLod = { {}, static_cast<uint32_t>(simplifier.TriangleCount()), simplifier.Error(), {} };
+		for (uint32_t i = 0; i < modelData.submeshes.size(); ++i) {
+			const uint32_t indexStart = static_cast<uint32_t>(modelData.indices.size());
+			simplifier.AppendIndices(i, modelData.indices);
+			const uint32_t lodIndexCount = static_cast<uint32_t>(modelData.indices.size()) - indexStart;
+			if (lodIndexCount == 0) {
+				continue;
+			}
+			//縮約で三角形の並びが崩れているので、頂点キャッシュの最適化をやり直す
+			OptimizeVertexCache(std::span<uint32_t>(modelData.indices.data() + indexStart, lodIndexCount), modelData.vertices.size());
+			meshLod.submeshes.push_back({ indexStart, lodIndexCount, modelData.submeshes[i].materialIndex });
+		}
+		modelData.lods.push_back(std::move(meshLod));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include "GraphicsData.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 簡略化の設定
+struct MeshSimplifySettings {
+	uint32_t maxLodCount = 4;      //LOD0を含めたLODの最大数
+	float reductionRatio = 0.5f;   //1段ごとに三角形数をこの割合まで減らす
+	float maxError = 0.05f;        //許容する形のずれ(メッシュの大きさに対する割合)。これを超える縮約はしない
+	float normalWeight = 0.01f;    //法線の変化の重み(形のずれの2乗と足し合わせる)
+	float texcoordWeight = 0.01f;  //UVの変化の重み
+};
+
+// 二次誤差(QEM)を使った辺の縮約で、三角形数がtargetIndexCount / 3以下になるまで減らす
+// 頂点は既存の頂点に寄せるだけなので、verticesはそのまま使える
+// 開いた縁・UVや法線の継ぎ目は、その線に沿った縮約しか許さないので形が崩れない
+// resultErrorを渡すと、二次誤差から見積もった元の形からのずれ(モデル空間の距離)を入れる。同じ入力なら結果は常に同じ
+std::vector<uint32_t> SimplifyMesh(std::span<const uint32_t> indices, std::span<const VertexData> vertices, size_t targetIndexCount, const MeshSimplifySettings& settings = {}, float* resultError = nullptr);
+
+// submeshes(LOD0)から1段ずつ簡略化してmodelData.lodsを作る。LOD1以降のインデックスはindicesの後ろに足す
+// 全サブメッシュをまとめて簡略化するので、マテリアルの境目に隙間はできない
+// 三角形が十分に減らなくなったら(maxErrorに達したら)そこで打ち切る
+void GenerateMeshLods(ModelData& modelData, const MeshSimplifySettings& settings = {});
\ No newline at end of file
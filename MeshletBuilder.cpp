@@ -0,0 +1,381 @@
+#include "MeshletBuilder.h"
+#include "MyMath.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kInvalidIndex = (std::numeric_limits<uint32_t>::max)();
+// 次の三角形を選ぶときの、法線がメッシュレットの平均からずれていることへの重み(新しい頂点1つが1)
+constexpr float kConeWeight = 0.5f;
+// 法線の広がりがこれより大きい(平均との内積の最小値がこれ以下)なら、裏向きカリングはしない
+constexpr float kMinConeDot = 0.1f;
+
+Vector3 ToVector3(const Vector4& v) {
+	return { v.x, v.y, v.z };
+}
+
+Vector3 Scale(const Vector3& v, float s) {
+	return { v.x * s, v.y * s, v.z * s };
+}
+
+float Length(const Vector3& v) {
+	return std::sqrt(Dot(v, v));
+}
+
+// 位置をビット列のまま比べるためのキー
+struct PositionKey {
+	uint32_t x;
+	uint32_t y;
+	uint32_t z;
+
+	bool operator==(const PositionKey&) const = default;
+};
+
+struct PositionKeyHash {
+	size_t operator()(const PositionKey& key) const {
+		uint64_t hash = (uint64_t(key.x) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(key.y) * 0xC2B2AE3D27D4EB4Full) ^ (uint64_t(key.z) * 0x165667B19E3779F9ull);
+		return size_t(hash ^ (hash >> 32));
+	}
+};
+
+// メッシュレットの三角形からバウンディングスフィア(Ritterの方法)と法線のコーンを求める
+void ComputeMeshletBounds(Meshlet& meshlet, std::span<const uint32_t> indices, std::span<const VertexData> vertices) {
+	//各軸で一番離れた2点のうち、最も離れた組を最初の直径にする
+	uint32_t minVertex[3] = { indices[0], indices[0], indices[0] };
+	uint32_t maxVertex[3] = { indices[0], indices[0], indices[0] };
+	for (uint32_t index : indices) {
+		const Vector4& p = vertices[index].position;
+		const float coordinates[3] = { p.x, p.y, p.z };
+		for (int32_t axis = 0; axis < 3; ++axis) {
+			const Vector4& minP = vertices[minVertex[axis]].position;
+			const Vector4& maxP = vertices[maxVertex[axis]].position;
+			if (coordinates[axis] < (&minP.x)[axis]) {
+				minVertex[axis] = index;
+			}
+			if (coordinates[axis] > (&maxP.x)[axis]) {
+				maxVertex[axis] = index;
+			}
+		}
+	}
+	float maxDistance = -1.0f;
+	for (int32_t axis = 0; axis < 3; ++axis) {
+		const Vector3 a = ToVector3(vertices[minVertex[axis]].position);
+		const Vector3 b = ToVector3(vertices[maxVertex[axis]].position);
+		const Vector3 d = Subtract(b, a);
+		if (Dot(d, d) > maxDistance) {
+			maxDistance = Dot(d, d);
+			meshlet.center = Scale(Add(a, b), 0.5f);
+			meshlet.radius = std::sqrt(maxDistance) * 0.5f;
+		}
+	}
+	//外に出ている点があれば、それを含むように広げる
+	for (uint32_t index : indices) {
+		const Vector3 p = ToVector3(vertices[index].position);
+		const Vector3 d = Subtract(p, meshlet.center);
+		const float distance = Length(d);
+		if (distance > meshlet.radius) {
+			const float newRadius = (meshlet.radius + distance) * 0.5f;
+			meshlet.center = Add(meshlet.center, Scale(d, (newRadius - meshlet.radius) / distance));
+			meshlet.radius = newRadius;
+		}
+	}
+
+	//法線の平均を軸にして、軸との内積の最小値から広がりを求める
+	std::vector<Vector3> normals;
+	normals.reserve(indices.size() / 3);
+	Vector3 normalSum = {};
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const Vector3 p0 = ToVector3(vertices[indices[i]].position);
+		const Vector3 normal = Cross(Subtract(ToVector3(vertices[indices[i + 1]].position), p0), Subtract(ToVector3(vertices[indices[i + 2]].position), p0));
+		const float length = Length(normal);
+		if (length == 0.0f) {
+			continue;
+		}
+		normals.push_back(Scale(normal, 1.0f / length));
+		normalSum = Add(normalSum, normals.back());
+	}
+	meshlet.coneAxis = {};
+	meshlet.coneCutoff = 1.0f;
+	const float axisLength = Length(normalSum);
+	if (axisLength == 0.0f) {
+		return;
+	}
+	const Vector3 axis = Scale(normalSum, 1.0f / axisLength);
+	float minDot = 1.0f;
+	for (const Vector3& normal : normals) {
+		minDot = (std::min)(minDot, Dot(normal, axis));
+	}
+	if (minDot <= kMinConeDot) {
+		return;
+	}
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+// 1つのサブメッシュをメッシュレットに分け、indicesをメッシュレット順に並べ替える
+void BuildSubmeshMeshlets(std::span<uint32_t> indices, std::span<const VertexData> vertices, uint32_t indexStart, uint32_t materialIndex, std::vector<Meshlet>& meshlets) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	//頂点→それを使う三角形の表(CSR)
+	std::vector<uint32_t> vertexTriangleOffsets(vertices.size() + 1, 0);
+	for (uint32_t index : indices) {
+		++vertexTriangleOffsets[index + 1];
+	}
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		vertexTriangleOffsets[i + 1] += vertexTriangleOffsets[i];
+	}
+	std::vector<uint32_t> vertexTriangles(indices.size());
+	{
+		std::vector<uint32_t> cursor(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			vertexTriangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<Vector3> triangleNormals(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+		const Vector3 p0 = ToVector3(vertices[indices[triangle * 3]].position);
+		const Vector3 normal = Cross(Subtract(ToVector3(vertices[indices[triangle * 3 + 1]].position), p0), Subtract(ToVector3(vertices[indices[triangle * 3 + 2]].position), p0));
+		const float length = Length(normal);
+		triangleNormals[triangle] = length > 0.0f ? Scale(normal, 1.0f / length) : Vector3{};
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> vertexMeshlet(vertices.size(), kInvalidIndex);  //頂点がどのメッシュレットに入っているか
+	std::vector<uint32_t> candidates;
+	size_t scanCursor = 0;
+
+	Meshlet meshlet = {};
+	uint32_t meshletId = 0;
+	Vector3 normalSum = {};
+	auto finishMeshlet = [&]() {
+		if (meshlet.triangleCount == 0) {
+			return;
+		}
+		const size_t start = output.size() - size_t(meshlet.triangleCount) * 3;
+		meshlet.indexStart = indexStart + static_cast<uint32_t>(start);
+		meshlet.materialIndex = materialIndex;
+		ComputeMeshletBounds(meshlet, std::span<const uint32_t>(output.data() + start, size_t(meshlet.triangleCount) * 3), vertices);
+		meshlets.push_back(meshlet);
+		meshlet = {};
+		++meshletId;
+		normalSum = {};
+		candidates.clear();
+	};
+	auto countNewVertices = [&](uint32_t triangle) {
+		uint32_t count = 0;
+		for (uint32_t corner = 0; corner < 3; ++corner) {
+			count += vertexMeshlet[indices[triangle * 3 + corner]] != meshletId ? 1 : 0;
+		}
+		return count;
+	};
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		//今のメッシュレットの頂点を使う三角形の中から、新しい頂点が少なく、向きがそろっているものを選ぶ
+		const float normalLength = Length(normalSum);
+		const Vector3 averageNormal = normalLength > 0.0f ? Scale(normalSum, 1.0f / normalLength) : Vector3{};
+		uint32_t best = kInvalidIndex;
+		float bestScore = FLT_MAX;
+		size_t candidateCount = 0;
+		for (uint32_t triangle : candidates) {
+			if (emitted[triangle]) {
+				continue;
+			}
+			candidates[candidateCount++] = triangle;
+			const uint32_t newVertices = countNewVertices(triangle);
+			if (meshlet.vertexCount + newVertices > kMeshletMaxVertices) {
+				continue;
+			}
+			const float score = float(newVertices) + kConeWeight * (1.0f - Dot(triangleNormals[triangle], averageNormal));
+			if (score < bestScore || (score == bestScore && triangle < best)) {
+				best = triangle;
+				bestScore = score;
+			}
+		}
+		candidates.resize(candidateCount);
+
+		if (best == kInvalidIndex) {
+			//つながった三角形が入らないか、島を使い切った。半分以上埋まっていれば閉じ、そうでなければ離れた三角形も入れる
+			if (!candidates.empty() || meshlet.triangleCount >= kMeshletMaxTriangles / 2) {
+				finishMeshlet();
+			}
+			while (emitted[scanCursor]) {
+				++scanCursor;
+			}
+			best = static_cast<uint32_t>(scanCursor);
+			if (meshlet.vertexCount + countNewVertices(best) > kMeshletMaxVertices) {
+				finishMeshlet();
+			}
+		}
+
+		//三角形を追加して、新しく入った頂点を使う三角形を候補に足す
+		emitted[best] = true;
+		for (uint32_t corner = 0; corner < 3; ++corner) {
+			const uint32_t vertex = indices[best * 3 + corner];
+			output.push_back(vertex);
+			if (vertexMeshlet[vertex] == meshletId) {
+				continue;
+			}
+			vertexMeshlet[vertex] = meshletId;
+			++meshlet.vertexCount;
+			for (uint32_t i = vertexTriangleOffsets[vertex]; i < vertexTriangleOffsets[vertex + 1]; ++i) {
+				if (!emitted[vertexTriangles[i]]) {
+					candidates.push_back(vertexTriangles[i]);
+				}
+			}
+		}
+		normalSum = Add(normalSum, triangleNormals[best]);
+		if (++meshlet.triangleCount == kMeshletMaxTriangles) {
+			finishMeshlet();
+		}
+	}
+	finishMeshlet();
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+}
+
+std::vector<Meshlet> BuildMeshlets(ModelData& modelData, std::span<const SubMesh> submeshes) {
+	std::vector<Meshlet> meshlets;
+	for (const SubMesh& submesh : submeshes) {
+		std::span<uint32_t> indices(modelData.indices.data() + submesh.indexStart, submesh.indexCount);
+		BuildSubmeshMeshlets(indices, modelData.vertices, submesh.indexStart, submesh.materialIndex, meshlets);
+	}
+	return meshlets;
+}
+
+bool IsClosedMesh(const ModelData& modelData, std::span<const SubMesh> submeshes) {
+	//同じ位置の頂点(UV・法線の継ぎ目で分かれたもの)を1つの位置にまとめる
+	std::vector<uint32_t> vertexPositions(modelData.vertices.size(), kInvalidIndex);
+	std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positionMap;
+	auto getPosition = [&](uint32_t index) {
+		if (vertexPositions[index] == kInvalidIndex) {
+			const Vector4& p = modelData.vertices[index].position;
+			//-0と+0を同じ位置にするため、0を足してから比べる
+			const PositionKey key = { std::bit_cast<uint32_t>(p.x + 0.0f), std::bit_cast<uint32_t>(p.y + 0.0f), std::bit_cast<uint32_t>(p.z + 0.0f) };
+			vertexPositions[index] = positionMap.try_emplace(key, static_cast<uint32_t>(positionMap.size())).first->second;
+		}
+		return vertexPositions[index];
+	};
+
+	//向きのある辺(始点, 終点)ごとに使っている三角形の数を数える
+	std::unordered_map<uint64_t, uint32_t> edgeCounts;
+	for (const SubMesh& submesh : submeshes) {
+		for (uint32_t i = 0; i + 2 < submesh.indexCount; i += 3) {
+			const uint32_t* triangle = modelData.indices.data() + submesh.indexStart + i;
+			const uint32_t p[3] = { getPosition(triangle[0]), getPosition(triangle[1]), getPosition(triangle[2]) };
+			if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0]) {
+				continue;  //つぶれた三角形は面を持たないので数えない
+			}
+			for (uint32_t j = 0; j < 3; ++j) {
+				++edgeCounts[(uint64_t(p[j]) << 32) | p[(j + 1) % 3]];
+			}
+		}
+	}
+	if (edgeCounts.empty()) {
+		return false;
+	}
+
+	//開いた縁(逆向きの辺がない)、3枚以上の面が集まる辺、向きが逆の隣どうし(同じ向きの辺が2つ)があれば閉じていない
+	for (const auto& [edge, count] : edgeCounts) {
+		const uint64_t reversed = (edge << 32) | (edge >> 32);
+		auto it = edgeCounts.find(reversed);
+		if (count != 1 || it == edgeCounts.end() || it->second != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void CullMeshlets(std::span<const Meshlet> meshlets, const MeshletCullingView& view, std::vector<SubMesh>& drawList, MeshletCullingStatistics* statistics) {
+	drawList.clear();
+	MeshletCullingStatistics result = {};
+	result.meshletCount = static_cast<uint32_t>(meshlets.size());
+
+	//行ベクトルなので、クリップ座標の各成分はviewProjectionの列との内積になる。列を組み合わせて6つの平面を作る
+	const Matrix4x4& m = view.viewProjection;
+	auto column = [&](int32_t j) { return Vector4{ m.m[0][j], m.m[1][j], m.m[2][j], m.m[3][j] }; };
+	const Vector4 c0 = column(0);
+	const Vector4 c1 = column(1);
+	const Vector4 c2 = column(2);
+	const Vector4 c3 = column(3);
+	Vector4 planes[6] = {
+		{ c3.x + c0.x, c3.y + c0.y, c3.z + c0.z, c3.w + c0.w },  //左
+		{ c3.x - c0.x, c3.y - c0.y, c3.z - c0.z, c3.w - c0.w },  //右
+		{ c3.x + c1.x, c3.y + c1.y, c3.z + c1.z, c3.w + c1.w },  //下
+		{ c3.x - c1.x, c3.y - c1.y, c3.z - c1.z, c3.w - c1.w },  //上
+		c2,                                                      //手前(z >= 0)
+		{ c3.x - c2.x, c3.y - c2.y, c3.z - c2.z, c3.w - c2.w },  //奥
+	};
+	for (Vector4& plane : planes) {
+		const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		plane = { plane.x / length, plane.y / length, plane.z / length, plane.w / length };
+	}
+
+	//ワールド行列の各行が軸なので、一番長いものを半径の倍率にする
+	const Matrix4x4& world = view.world;
+	const Vector3 axisX = { world.m[0][0], world.m[0][1], world.m[0][2] };
+	const Vector3 axisY = { world.m[1][0], world.m[1][1], world.m[1][2] };
+	const Vector3 axisZ = { world.m[2][0], world.m[2][1], world.m[2][2] };
+	const float radiusScale = std::sqrt((std::max)({ Dot(axisX, axisX), Dot(axisY, axisY), Dot(axisZ, axisZ) }));
+
+	for (const Meshlet& meshlet : meshlets) {
+		result.triangleCount += meshlet.triangleCount;
+		const Vector3 center = Transform(meshlet.center, world);
+		const float radius = meshlet.radius * radiusScale;
+
+		bool outside = false;
+		for (const Vector4& plane : planes) {
+			outside = outside || plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius;
+		}
+		if (outside) {
+			++result.frustumCulled;
+			continue;
+		}
+
+		//コーンの中のどの面もカメラに背を向けているなら描かない
+		const Vector3 cameraToCenter = Subtract(center, view.cameraPosition);
+		const float distance = Length(cameraToCenter);
+		if (view.cullBackfaces && meshlet.coneCutoff < 1.0f) {
+			const Vector3 axis = Add(Add(Scale(axisX, meshlet.coneAxis.x), Scale(axisY, meshlet.coneAxis.y)), Scale(axisZ, meshlet.coneAxis.z));
+			const float axisLength = Length(axis);
+			if (axisLength > 0.0f && Dot(cameraToCenter, axis) / axisLength >= meshlet.coneCutoff * distance + radius) {
+				++result.backfaceCulled;
+				continue;
+			}
+		}
+
+		//画面上の直径が小さすぎて、ピクセルの中心をほとんど覆わないものは描かない
+		if (distance > radius && 2.0f * radius * view.pixelScale / distance < view.minPixelSize) {
+			++result.smallCulled;
+			continue;
+		}
+
+		result.visibleTriangleCount += meshlet.triangleCount;
+		const uint32_t indexCount = meshlet.triangleCount * 3;
+		if (!drawList.empty() && drawList.back().materialIndex == meshlet.materialIndex &&
+			drawList.back().indexStart + drawList.back().indexCount == meshlet.indexStart) {
+			drawList.back().indexCount += indexCount;
+		}
+		else {
+			drawList.push_back({ meshlet.indexStart, indexCount, meshlet.materialIndex });
+		}
+	}
+
+	if (statistics) {
+		*statistics = result;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include "GraphicsData.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 1つのメッシュレットに入る頂点と三角形の最大数
+constexpr uint32_t kMeshletMaxVertices = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+// カリングに使うカメラの情報
+struct MeshletCullingView {
+	Matrix4x4 world;
+	Matrix4x4 viewProjection;
+	Vector3 cameraPosition;     //ワールド座標
+	float pixelScale;           //距離1で長さ1が何ピクセルに見えるか(ComputeLodPixelScale(1.0f, fovY, 画面の高さ))
+	float minPixelSize = 1.0f;  //画面上の直径がこれより小さいメッシュレットは描かない
+	bool cullBackfaces = true;  //閉じたメッシュ(ModelData::closed)のときだけtrueにする
+};
+
+// カリングの結果(ログ・計測用)
+struct MeshletCullingStatistics {
+	uint32_t meshletCount;
+	uint32_t frustumCulled;
+	uint32_t backfaceCulled;
+	uint32_t smallCulled;
+	uint64_t triangleCount;
+	uint64_t visibleTriangleCount;
+};
+
+// submeshesの範囲をそれぞれメッシュレットに分け、その範囲のインデックスをメッシュレット順に並べ替える
+// 三角形の集まりは変わらないので、submeshesはそのまま描ける。メッシュレットはサブメッシュをまたがない
+std::vector<Meshlet> BuildMeshlets(ModelData& modelData, std::span<const SubMesh> submeshes);
+
+// submeshesの三角形が隙間なく閉じていて、向きもそろっているか(裏面が必ず表の面に隠れるか)
+// UV・法線の継ぎ目で分かれた頂点は位置でまとめ、どの辺もちょうど逆向きの2つの三角形が共有していればtrue
+bool IsClosedMesh(const ModelData& modelData, std::span<const SubMesh> submeshes);
+
+// 見えるメッシュレットだけをdrawListに入れる。隣り合っていてマテリアルが同じものは1つの範囲にまとめる
+// ワールド行列の拡大縮小は、裏向きカリングについては均等であるとみなす
+void CullMeshlets(std::span<const Meshlet> meshlets, const MeshletCullingView& view, std::vector<SubMesh>& drawList, MeshletCullingStatistics* statistics = nullptr);
\ No newline at end of file
@@ -1,374 +0,0 @@
-#include "MyMath.h"
-
-float Cot(float theta)
-{
-	return 1 / std::tan(theta);
-}
-
-#pragma region 単位行列
-Matrix4x4 MakeIdentity4x4() {
-	Matrix4x4 result = {
-		1,0,0,0,
-		0,1,0,0,
-		0,0,1,0,
-		0,0,0,1
-	};
-	return result;
-}
-#pragma endregion
-
-#pragma region 4x4Matrix同士の乗算
-Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
-	Matrix4x4 result = {};
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			for (int k = 0; k < 4; k++) {
-				result.m[i][j] += m1.m[i][k] * m2.m[k][j];
-			}
-		}
-	}
-	return result;
-}
-#pragma endregion
-
-#pragma region 回転行列の作成
-Matrix4x4 MakeRotateMatrix(const Vector3& rotate) {
-	Matrix4x4 rotateX;
-	rotateX = {
-	1,0,0,0,
-		0,std::cos(rotate.x),std::sin(rotate.x),0,
-		0,-std::sin(rotate.x),std::cos(rotate.x),0,
-		0,0,0,1
-	};
-	Matrix4x4 rotateY;
-	rotateY = {
-	std::cos(rotate.y),0,-std::sin(rotate.y),0,
-		0,1,0,0,
-		std::sin(rotate.y),0,std::cos(rotate.y),
-		0,0,0,0,1
-	};
-	Matrix4x4 rotateZ;
-	rotateZ = {
-	std::cos(rotate.z),std::sin(rotate.z),0,0,
-		-std::sin(rotate.z),std::cos(rotate.z),0,0,
-		0,0,1,0,
-		0,0,0,1
-	};
-	Matrix4x4 result = Multiply(rotateX, Multiply(rotateY, rotateZ));
-	return result;
-}
-#pragma endregion
-
-#pragma region アフィン行列の作成
-Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
-	Matrix4x4 result;
-	Matrix4x4 rotateM = MakeRotateMatrix(rotate);
-	result = {
-		scale.x * rotateM.m[0][0],scale.x * rotateM.m[0][1],scale.x * rotateM.m[0][2],0,
-		scale.y * rotateM.m[1][0],scale.y * rotateM.m[1][1],scale.y * rotateM.m[1][2],0,
-		scale.z * rotateM.m[2][0],scale.z * rotateM.m[2][1],scale.z * rotateM.m[2][2],0,
-		translate.x,translate.y,translate.z,1
-	};
-	return result;
-}
-#pragma endregion
-
-#pragma region 逆行列の作成
-Matrix4x4 Inverse(const Matrix4x4& m) {
-	float determinant =
-		+m.m[0][0] * m.m[1][1] * m.m[2][2] * m.m[3][3]
-		+ m.m[0][0] * m.m[1][2] * m.m[2][3] * m.m[3][1]
-		+ m.m[0][0] * m.m[1][3] * m.m[2][1] * m.m[3][2]
-
-		- m.m[0][0] * m.m[1][3] * m.m[2][2] * m.m[3][1]
-		- m.m[0][0] * m.m[1][2] * m.m[2][1] * m.m[3][3]
-		- m.m[0][0] * m.m[1][1] * m.m[2][3] * m.m[3][2]
-
-		- m.m[0][1] * m.m[1][0] * m.m[2][2] * m.m[3][3]
-		- m.m[0][2] * m.m[1][0] * m.m[2][3] * m.m[3][1]
-		- m.m[0][3] * m.m[1][0] * m.m[2][1] * m.m[3][2]
-
-		+ m.m[0][3] * m.m[1][0] * m.m[2][2] * m.m[3][1]
-		+ m.m[0][2] * m.m[1][0] * m.m[2][1] * m.m[3][3]
-		+ m.m[0][1] * m.m[1][0] * m.m[2][3] * m.m[3][2]
-
-		+ m.m[0][1] * m.m[1][2] * m.m[2][0] * m.m[3][3]
-		+ m.m[0][2] * m.m[1][3] * m.m[2][0] * m.m[3][1]
-		+ m.m[0][3] * m.m[1][1] * m.m[2][0] * m.m[3][2]
-
-		- m.m[0][3] * m.m[1][2] * m.m[2][0] * m.m[3][1]
-		- m.m[0][2] * m.m[1][1] * m.m[2][0] * m.m[3][3]
-		- m.m[0][1] * m.m[1][3] * m.m[2][0] * m.m[3][2]
-
-		- m.m[0][1] * m.m[1][2] * m.m[2][3] * m.m[3][0]
-		- m.m[0][2] * m.m[1][3] * m.m[2][1] * m.m[3][0]
-		- m.m[0][3] * m.m[1][1] * m.m[2][2] * m.m[3][0]
-
-		+ m.m[0][3] * m.m[1][2] * m.m[2][1] * m.m[3][0]
-		+ m.m[0][2] * m.m[1][1] * m.m[2][3] * m.m[3][0]
-		+ m.m[0][1] * m.m[1][3] * m.m[2][2] * m.m[3][0];
-
-	Matrix4x4 result = {};
-	float recpDeterminant = 1.0f / determinant;
-	result.m[0][0] = (m.m[1][1] * m.m[2][2] * m.m[3][3] + m.m[1][2] * m.m[2][3] * m.m[3][1] +
-		m.m[1][3] * m.m[2][1] * m.m[3][2] - m.m[1][3] * m.m[2][2] * m.m[3][1] -
-		m.m[1][2] * m.m[2][1] * m.m[3][3] - m.m[1][1] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
-	result.m[0][1] = (-m.m[0][1] * m.m[2][2] * m.m[3][3] - m.m[0][2] * m.m[2][3] * m.m[3][1] -
-		m.m[0][3] * m.m[2][1] * m.m[3][2] + m.m[0][3] * m.m[2][2] * m.m[3][1] +
-		m.m[0][2] * m.m[2][1] * m.m[3][3] + m.m[0][1] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
-	result.m[0][2] = (m.m[0][1] * m.m[1][2] * m.m[3][3] + m.m[0][2] * m.m[1][3] * m.m[3][1] +
-		m.m[0][3] * m.m[1][1] * m.m[3][2] - m.m[0][3] * m.m[1][2] * m.m[3][1] -
-		m.m[0][2] * m.m[1][1] * m.m[3][3] - m.m[0][1] * m.m[1][3] * m.m[3][2]) * recpDeterminant;
-	result.m[0][3] = (-m.m[0][1] * m.m[1][2] * m.m[2][3] - m.m[0][2] * m.m[1][3] * m.m[2][1] -
-		m.m[0][3] * m.m[1][1] * m.m[2][2] + m.m[0][3] * m.m[1][2] * m.m[2][1] +
-		m.m[0][2] * m.m[1][1] * m.m[2][3] + m.m[0][1] * m.m[1][3] * m.m[2][2]) * recpDeterminant;
-
-	result.m[1][0] = (-m.m[1][0] * m.m[2][2] * m.m[3][3] - m.m[1][2] * m.m[2][3] * m.m[3][0] -
-		m.m[1][3] * m.m[2][0] * m.m[3][2] + m.m[1][3] * m.m[2][2] * m.m[3][0] +
-		m.m[1][2] * m.m[2][0] * m.m[3][3] + m.m[1][0] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
-	result.m[1][1] = (m.m[0][0] * m.m[2][2] * m.m[3][3] + m.m[0][2] * m.m[2][3] * m.m[3][0] +
-		m.m[0][3] * m.m[2][0] * m.m[3][2] - m.m[0][3] * m.m[2][2] * m.m[3][0] -
-		m.m[0][2] * m.m[2][0] * m.m[3][3] - m.m[0][0] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
-	result.m[1][2] = (-m.m[0][0] * m.m[1][2] * m.m[3][3] - m.m[0][2] * m.m[1][3] * m.m[3][0] -
-		m.m[0][3] * m.m[1][0] * m.m[3][2] + m.m[0][3] * m.m[1][2] * m.m[3][0] +
-		m.m[0][2] * m.m[1][0] * m.m[3][3] + m.m[0][0] * m.m[1][3] * m.m[3][2]) * recpDeterminant;
-	result.m[1][3] = (m.m[0][0] * m.m[1][2] * m.m[2][3] + m.m[0][2] * m.m[1][3] * m.m[2][0] +
-		m.m[0][3] * m.m[1][0] * m.m[2][2] - m.m[0][3] * m.m[1][2] * m.m[2][0] -
-		m.m[0][2] * m.m[1][0] * m.m[2][3] - m.m[0][0] * m.m[1][3] * m.m[2][2]) * recpDeterminant;
-
-	result.m[2][0] = (m.m[1][0] * m.m[2][1] * m.m[3][3] + m.m[1][1] * m.m[2][3] * m.m[3][0] +
-		m.m[1][3] * m.m[2][0] * m.m[3][1] - m.m[1][3] * m.m[2][1] * m.m[3][0] -
-		m.m[1][1] * m.m[2][0] * m.m[3][3] - m.m[1][0] * m.m[2][3] * m.m[3][1]) * recpDeterminant;
-	result.m[2][1] = (-m.m[0][0] * m.m[2][1] * m.m[3][3] - m.m[0][1] * m.m[2][3] * m.m[3][0] -
-		m.m[0][3] * m.m[2][0] * m.m[3][1] + m.m[0][3] * m.m[2][1] * m.m[3][0] +
-		m.m[0][1] * m.m[2][0] * m.m[3][3] + m.m[0][0] * m.m[2][3] * m.m[3][1]) * recpDeterminant;
-	result.m[2][2] = (m.m[0][0] * m.m[1][1] * m.m[3][3] + m.m[0][1] * m.m[1][3] * m.m[3][0] +
-		m.m[0][3] * m.m[1][0] * m.m[3][1] - m.m[0][3] * m.m[1][1] * m.m[3][0] -
-		m.m[0][1] * m.m[1][0] * m.m[3][3] - m.m[0][0] * m.m[1][3] * m.m[3][1]) * recpDeterminant;
-	result.m[2][3] = (-m.m[0][0] * m.m[1][1] * m.m[2][3] - m.m[0][1] * m.m[1][3] * m.m[2][0] -
-		m.m[0][3] * m.m[1][0] * m.m[2][1] + m.m[0][3] * m.m[1][1] * m.m[2][0] +
-		m.m[0][1] * m.m[1][0] * m.m[2][3] + m.m[0][0] * m.m[1][3] * m.m[2][1]) * recpDeterminant;
-
-	result.m[3][0] = (-m.m[1][0] * m.m[2][1] * m.m[3][2] - m.m[1][1] * m.m[2][2] * m.m[3][0] -
-		m.m[1][2] * m.m[2][0] * m.m[3][1] + m.m[1][2] * m.m[2][1] * m.m[3][0] +
-		m.m[1][1] * m.m[2][0] * m.m[3][2] + m.m[1][0] * m.m[2][2] * m.m[3][1]) * recpDeterminant;
-	result.m[3][1] = (m.m[0][0] * m.m[2][1] * m.m[3][2] + m.m[0][1] * m.m[2][2] * m.m[3][0] +
-		m.m[0][2] * m.m[2][0] * m.m[3][1] - m.m[0][2] * m.m[2][1] * m.m[3][0] -
-		m.m[0][1] * m.m[2][0] * m.m[3][2] - m.m[0][0] * m.m[2][2] * m.m[3][1]) * recpDeterminant;
-	result.m[3][2] = (-m.m[0][0] * m.m[1][1] * m.m[3][2] - m.m[0][1] * m.m[1][2] * m.m[3][0] -
-		m.m[0][2] * m.m[1][0] * m.m[3][1] + m.m[0][2] * m.m[1][1] * m.m[3][0] +
-		m.m[0][1] * m.m[1][0] * m.m[3][2] + m.m[0][0] * m.m[1][2] * m.m[3][1]) * recpDeterminant;
-	result.m[3][3] = (m.m[0][0] * m.m[1][1] * m.m[2][2] + m.m[0][1] * m.m[1][2] * m.m[2][0] +
-		m.m[0][2] * m.m[1][0] * m.m[2][1] - m.m[0][2] * m.m[1][1] * m.m[2][0] -
-		m.m[0][1] * m.m[1][0] * m.m[2][2] - m.m[0][0] * m.m[1][2] * m.m[2][1]) * recpDeterminant;
-
-	return result;
-}
-#pragma endregion
-
-#pragma region コタンジェント
-float cot(float x) {
-	float cot;
-	cot = 1 / std::tan(x);
-	return cot;
-}
-#pragma endregion
-
-#pragma region 透視投影行列
-Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip) {
-	Matrix4x4 result;
-	result = {
-		(1 / aspectRatio) * cot(fovY / 2),0,0,0,
-		0,cot(fovY / 2),0,0,
-		0,0,farClip / (farClip - nearClip),1,
-		0,0,(-nearClip * farClip) / (farClip - nearClip),0
-	};
-	return result;
-}
-#pragma endregion
-
-#pragma region 平行投影行列
-Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
-
-	Matrix4x4 result;
-
-	result = {
-	2 / (right - left),0.0f,0.0f,0.0f,
-	0.0f,2 / (top - bottom),0.0f,0.0f,
-	0.0f,0.0f,1 / (farClip - nearClip),0.0f,
-	(left + right) / (left - right),(top + bottom) / (bottom - top),nearClip / (nearClip - farClip),1.0f
-	};
-
-	return result;
-}
-#pragma endregion
-
-#pragma region ビューポート
-Matrix4x4 MakeViewportMatrix(float left, float top, float width, float height, float minDepth, float maxDepth)
-{
-	Matrix4x4 ans;
-
-
-
-	ans.m[0][0] = width / 2;
-	ans.m[0][1] = 0;
-	ans.m[0][2] = 0;
-	ans.m[0][3] = 0;
-
-	ans.m[1][0] = 0;
-	ans.m[1][1] = -(height / 2);
-	ans.m[1][2] = 0;
-	ans.m[1][3] = 0;
-
-	ans.m[2][0] = 0;
-	ans.m[2][1] = 0;
-	ans.m[2][2] = maxDepth - minDepth;
-	ans.m[2][3] = 0;
-
-	ans.m[3][0] = left + (width / 2);
-	ans.m[3][1] = top + (height / 2);
-	ans.m[3][2] = minDepth;
-	ans.m[3][3] = 1;
-
-
-
-
-	return ans;
-
-}
-#pragma endregion
-
-Matrix4x4 MakeScaleMatrix(const Vector3& scale)
-{
-	Matrix4x4 ans;
-
-	ans.m[0][0] = scale.x;
-	ans.m[0][1] = 0;
-	ans.m[0][2] = 0;
-	ans.m[0][3] = 0;
-
-	ans.m[1][0] = 0;
-	ans.m[1][1] = scale.y;
-	ans.m[1][2] = 0;
-	ans.m[1][3] = 0;
-
-	ans.m[2][0] = 0;
-	ans.m[2][1] = 0;
-	ans.m[2][2] = scale.z;
-	ans.m[2][3] = 0;
-
-	ans.m[3][0] = 0;
-	ans.m[3][1] = 0;
-	ans.m[3][2] = 0;
-	ans.m[3][3] = 1;
-	return ans;
-}
-
-Matrix4x4 MakeRotateXMatrix(float radian)
-{
-	Matrix4x4 ans;
-
-	ans.m[0][0] = 1;
-	ans.m[0][1] = 0;
-	ans.m[0][2] = 0;
-	ans.m[0][3] = 0;
-
-	ans.m[1][0] = 0;
-	ans.m[1][1] = std::cos(radian);;
-	ans.m[1][2] = std::sin(radian);;
-	ans.m[1][3] = 0;
-
-	ans.m[2][0] = 0;
-	ans.m[2][1] = -std::sin(radian);;
-	ans.m[2][2] = std::cos(radian);;
-	ans.m[2][3] = 0;
-
-	ans.m[3][0] = 0;
-	ans.m[3][1] = 0;
-	ans.m[3][2] = 0;
-	ans.m[3][3] = 1;
-
-	return ans;
-}
-
-Matrix4x4 MakeRotateYMatrix(float radian)
-{
-	Matrix4x4 ans;
-
-	ans.m[0][0] = std::cos(radian);
-	ans.m[0][1] = 0;
-	ans.m[0][2] = -std::sin(radian);
-	ans.m[0][3] = 0;
-
-	ans.m[1][0] = 0;
-	ans.m[1][1] = 1;
-	ans.m[1][2] = 0;
-	ans.m[1][3] = 0;
-
-	ans.m[2][0] = std::sin(radian);;
-	ans.m[2][1] = 0;
-	ans.m[2][2] = std::cos(radian);;
-	ans.m[2][3] = 0;
-
-	ans.m[3][0] = 0;
-	ans.m[3][1] = 0;
-	ans.m[3][2] = 0;
-	ans.m[3][3] = 1;
-
-	return ans;
-}
-
-Matrix4x4 MakeRotateZMatrix(float radian)
-{
-	Matrix4x4 ans;
-
-	ans.m[0][0] = std::cos(radian);
-	ans.m[0][1] = std::sin(radian);
-	ans.m[0][2] = 0;
-	ans.m[0][3] = 0;
-
-	ans.m[1][0] = -std::sin(radian);
-	ans.m[1][1] = std::cos(radian);
-	ans.m[1][2] = 0;
-	ans.m[1][3] = 0;
-
-	ans.m[2][0] = 0;
-	ans.m[2][1] = 0;
-	ans.m[2][2] = 1;
-	ans.m[2][3] = 0;
-
-	ans.m[3][0] = 0;
-	ans.m[3][1] = 0;
-	ans.m[3][2] = 0;
-	ans.m[3][3] = 1;
-
-
-	return ans;
-}
-
-Matrix4x4 MakeTranslateMatrix(const Vector3& translate)
-{
-	Matrix4x4 ans;
-
-	ans.m[0][0] = 1;
-	ans.m[0][1] = 0;
-	ans.m[0][2] = 0;
-	ans.m[0][3] = 0;
-
-	ans.m[1][0] = 0;
-	ans.m[1][1] = 1;
-	ans.m[1][2] = 0;
-	ans.m[1][3] = 0;
-
-	ans.m[2][0] = 0;
-	ans.m[2][1] = 0;
-	ans.m[2][2] = 1;
-	ans.m[2][3] = 0;
-
-	ans.m[3][0] = translate.x;
-	ans.m[3][1] = translate.y;
-	ans.m[3][2] = translate.z;
-	ans.m[3][3] = 1;
-
-	return ans;
-}
\ No newline at end of file
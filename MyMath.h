@@ -1,40 +1,30 @@
 #pragma once
 #include "Matrix4x4.h"
 #include "Matrix3x3.h"
+#include "Matrix3x4.h"
+#include "Matrix2x4.h"
 #include "Vector4.h"
 #include "Vector3.h"
 #include "Vector2.h"
+#include "Quaternion.h"
 #include <assert.h>
 #include <cmath>
-#include <stdio.h>
-#include <vector>
-#include <string>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 
-float Cot(float theta);
+// 数学関数はすべてこのヘッダーに定義する(ヘッダーオンリー)
+// Windows・DirectXに依存しないので、標準C++20のコンパイラだけでビルドできる
+// 呼び出し側の翻訳単位でインライン展開でき、constexprの関数はコンパイル時にも計算できる
+// #pragma regionはMSVC以外では-Wunknown-pragmasの警告になるので、このヘッダーでは区切りをコメントで書く
 
-struct VertexData {
-	Vector4 position;
-	Vector2 texcoord;
-	Vector3 normal;
-};
-
-struct Material {
-	Vector4 color;
-	int32_t enableLighting;
-	float padding[3];
-	Matrix4x4 uvTransform;
-};
-
-struct TransformationMatrix {
-	Matrix4x4 WVP;
-	Matrix4x4 World;
-};
-
-struct DirectionalLight {
-	Vector4 color;
-	Vector3 direction;
-	float intensity;
-};
+// SIMD実装の切り替え
+// x64(SSE2が必ず使える環境)ではSSE版を使い、MYMATH_NO_SIMDを定義するとスカラー版になる
+// コンパイル時に評価されるときは常にスカラー版を使う
+#if !defined(MYMATH_NO_SIMD) && (defined(_M_X64) || defined(__SSE2__))
+#define MYMATH_USE_SSE
+#include <emmintrin.h>
+#endif
 
 struct Transform {
 	Vector3 scale;
@@ -42,26 +32,997 @@ struct Transform {
 	Vector3 translate;
 };
 
-struct MaterialData {
-	std::string textureFilePath;
+// SoA(x,y,zを別々の配列)で持つVector3の列。一括変換関数で使う
+struct Vector3SoA {
+	std::span<float> x;
+	std::span<float> y;
+	std::span<float> z;
 };
 
-struct ModelData {
-	std::vector<VertexData>vertices;
-	MaterialData material;
+struct ConstVector3SoA {
+	std::span<const float> x;
+	std::span<const float> y;
+	std::span<const float> z;
 };
 
 
-Matrix4x4 MakeIdentity4x4();
-Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2);
-Matrix4x4 MakeRotateMatrix(const Vector3& rotate);
-Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
-Matrix4x4 Inverse(const Matrix4x4& m);
-Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip);
-Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearclip, float farclip);
-Matrix4x4 MakeViewportMatrix(float left, float top, float width, float height, float minDepth, float maxDepth);
-Matrix4x4 MakeScaleMatrix(const Vector3& scale);
-Matrix4x4 MakeRotateXMatrix(float radian);
-Matrix4x4 MakeRotateYMatrix(float radian);
-Matrix4x4 MakeRotateZMatrix(float radian);
-Matrix4x4 MakeTranslateMatrix(const Vector3& translate);
\ No newline at end of file
+#ifdef MYMATH_USE_SSE
+//==== SSE版の実装 ====
+namespace MyMathSimd {
+	// _mm_shuffle_psの並びを読みやすくする(結果のx,yはaから、z,wはbから取る要素番号)
+	// マクロにするとインクルードした側に漏れるので、テンプレート関数にする
+	template<int x, int y, int z, int w>
+	inline __m128 Shuffle(__m128 a, __m128 b) {
+		return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+	}
+
+	// 2x2行列(行優先でxyzwに格納)の積 A*B
+	inline __m128 Mat2Mul(__m128 a, __m128 b) {
+		return _mm_add_ps(
+			_mm_mul_ps(a, Shuffle<0, 3, 0, 3>(b, b)),
+			_mm_mul_ps(Shuffle<1, 0, 3, 2>(a, a), Shuffle<2, 1, 2, 1>(b, b)));
+	}
+
+	// 2x2行列の余因子行列との積 adj(A)*B
+	inline __m128 Mat2AdjMul(__m128 a, __m128 b) {
+		return _mm_sub_ps(
+			_mm_mul_ps(Shuffle<3, 3, 0, 0>(a, a), b),
+			_mm_mul_ps(Shuffle<1, 1, 2, 2>(a, a), Shuffle<2, 3, 0, 1>(b, b)));
+	}
+
+	// 2x2行列と余因子行列の積 A*adj(B)
+	inline __m128 Mat2MulAdj(__m128 a, __m128 b) {
+		return _mm_sub_ps(
+			_mm_mul_ps(a, Shuffle<3, 0, 3, 0>(b, b)),
+			_mm_mul_ps(Shuffle<1, 0, 3, 2>(a, a), Shuffle<2, 1, 2, 1>(b, b)));
+	}
+
+	inline Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
+		Matrix4x4 result;
+		const __m128 b0 = _mm_loadu_ps(m2.m[0]);
+		const __m128 b1 = _mm_loadu_ps(m2.m[1]);
+		const __m128 b2 = _mm_loadu_ps(m2.m[2]);
+		const __m128 b3 = _mm_loadu_ps(m2.m[3]);
+		for (int i = 0; i < 4; i++) {
+			__m128 row = _mm_setzero_ps();
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m1.m[i][0]), b0));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m1.m[i][1]), b1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m1.m[i][2]), b2));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m1.m[i][3]), b3));
+			_mm_storeu_ps(result.m[i], row);
+		}
+		return result;
+	}
+
+	inline Matrix4x4 Inverse(const Matrix4x4& m) {
+		const __m128 r0 = _mm_loadu_ps(m.m[0]);
+		const __m128 r1 = _mm_loadu_ps(m.m[1]);
+		const __m128 r2 = _mm_loadu_ps(m.m[2]);
+		const __m128 r3 = _mm_loadu_ps(m.m[3]);
+
+		// | A B |
+		// | C D | の2x2ブロックに分ける
+		const __m128 A = _mm_movelh_ps(r0, r1);
+		const __m128 B = _mm_movehl_ps(r1, r0);
+		const __m128 C = _mm_movelh_ps(r2, r3);
+		const __m128 D = _mm_movehl_ps(r3, r2);
+
+		// 各ブロックの行列式 (|A|, |B|, |C|, |D|)
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(Shuffle<0, 2, 0, 2>(r0, r2), Shuffle<1, 3, 1, 3>(r1, r3)),
+			_mm_mul_ps(Shuffle<1, 3, 1, 3>(r0, r2), Shuffle<0, 2, 0, 2>(r1, r3)));
+		const __m128 detA = Shuffle<0, 0, 0, 0>(detSub, detSub);
+		const __m128 detB = Shuffle<1, 1, 1, 1>(detSub, detSub);
+		const __m128 detC = Shuffle<2, 2, 2, 2>(detSub, detSub);
+		const __m128 detD = Shuffle<3, 3, 3, 3>(detSub, detSub);
+
+		const __m128 D_C = Mat2AdjMul(D, C);
+		const __m128 A_B = Mat2AdjMul(A, B);
+		__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+		__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+		__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+		__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+		// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		__m128 determinant = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+		__m128 trace = _mm_mul_ps(A_B, Shuffle<0, 2, 1, 3>(D_C, D_C));
+		trace = _mm_add_ps(trace, Shuffle<1, 0, 3, 2>(trace, trace));
+		trace = _mm_add_ps(trace, Shuffle<2, 3, 0, 1>(trace, trace));
+		determinant = _mm_sub_ps(determinant, trace);
+
+		const __m128 recpDeterminant = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+		X = _mm_mul_ps(X, recpDeterminant);
+		Y = _mm_mul_ps(Y, recpDeterminant);
+		Z = _mm_mul_ps(Z, recpDeterminant);
+		W = _mm_mul_ps(W, recpDeterminant);
+
+		// 余因子行列の並び替えと格納をまとめて行う
+		Matrix4x4 result;
+		_mm_storeu_ps(result.m[0], Shuffle<3, 1, 3, 1>(X, Y));
+		_mm_storeu_ps(result.m[1], Shuffle<2, 0, 2, 0>(X, Y));
+		_mm_storeu_ps(result.m[2], Shuffle<3, 1, 3, 1>(Z, W));
+		_mm_storeu_ps(result.m[3], Shuffle<2, 0, 2, 0>(Z, W));
+		return result;
+	}
+
+	inline Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
+		Vector3 result;
+		__m128 v = _mm_mul_ps(_mm_set1_ps(vector.x), _mm_loadu_ps(matrix.m[0]));
+		v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(vector.y), _mm_loadu_ps(matrix.m[1])));
+		v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(vector.z), _mm_loadu_ps(matrix.m[2])));
+		v = _mm_add_ps(v, _mm_loadu_ps(matrix.m[3]));
+		const __m128 w = Shuffle<3, 3, 3, 3>(v, v);
+		assert(_mm_cvtss_f32(w) != 0.0f);
+		alignas(16) float xyzw[4];
+		_mm_store_ps(xyzw, _mm_div_ps(v, w));
+		result = { xyzw[0], xyzw[1], xyzw[2] };
+		return result;
+	}
+}
+#endif
+
+//==== 三角関数 ====
+// sin/cosの多項式近似。分岐がないのでループ内ではコンパイラがベクトル化できる
+// π/2単位で範囲を縮めてから[-π/4, π/4]の多項式で求める
+// 誤差: |radian| <= 8192 でsin/cosとも絶対誤差1.0e-7以下(floatの1ULP程度)。それより大きい角度は精度が落ちる
+inline void SinCosApprox(float radian, float& sinValue, float& cosValue) {
+	// radian = quadrant * π/2 + r (π/2は3つに分けて引くことで桁落ちを防ぐ)
+	// quadrantは1.5*2^23を足して引くことで最も近い整数に丸める。std::floorはSSE2では関数呼び出しになり、ループのベクトル化も止まる
+	// (足して引く計算を消されないよう、-ffast-math・/fp:fastではビルドしないこと)
+	float quadrant = (radian * 0.636619772f + 12582912.0f) - 12582912.0f;
+	float r = radian - quadrant * 1.5703125f;
+	r = r - quadrant * 4.837512969970703125e-4f;
+	r = r - quadrant * 7.54978995489188216e-8f;
+	float r2 = r * r;
+	float sinR = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+	float cosR = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+	// 象限に応じてsin/cosの入れ替えと符号を決める
+	int q = static_cast<int>(quadrant) & 3;
+	float s = (q & 1) ? cosR : sinR;
+	float c = (q & 1) ? sinR : cosR;
+	sinValue = (q & 2) ? -s : s;
+	cosValue = ((q + 1) & 2) ? -c : c;
+}
+
+// MYMATH_FAST_TRIGを定義すると近似版、定義しなければ標準ライブラリのsin/cosを使う
+inline void SinCos(float radian, float& sinValue, float& cosValue) {
+#ifdef MYMATH_FAST_TRIG
+	SinCosApprox(radian, sinValue, cosValue);
+#else
+	sinValue = std::sin(radian);
+	cosValue = std::cos(radian);
+#endif
+}
+
+// 配列をまとめて処理する版
+inline void SinCos(std::span<const float> radians, std::span<float> sinValues, std::span<float> cosValues) {
+	assert(sinValues.size() == radians.size() && cosValues.size() == radians.size());
+	for (size_t i = 0; i < radians.size(); i++) {
+		SinCos(radians[i], sinValues[i], cosValues[i]);
+	}
+}
+
+//==== コタンジェント ====
+inline float Cot(float theta) {
+#ifdef MYMATH_FAST_TRIG
+	float sinValue, cosValue;
+	SinCosApprox(theta, sinValue, cosValue);
+	return cosValue / sinValue;
+#else
+	return 1 / std::tan(theta);
+#endif
+}
+
+//==== 単位行列 ====
+constexpr Matrix4x4 MakeIdentity4x4() {
+	Matrix4x4 result = {
+		1,0,0,0,
+		0,1,0,0,
+		0,0,1,0,
+		0,0,0,1
+	};
+	return result;
+}
+
+//==== 行列の加法 / 減法 / 転置 ====
+constexpr Matrix4x4 Add(const Matrix4x4& m1, const Matrix4x4& m2) {
+	Matrix4x4 result = {};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m1.m[i][j] + m2.m[i][j];
+		}
+	}
+	return result;
+}
+
+constexpr Matrix4x4 Subtract(const Matrix4x4& m1, const Matrix4x4& m2) {
+	Matrix4x4 result = {};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m1.m[i][j] - m2.m[i][j];
+		}
+	}
+	return result;
+}
+
+constexpr Matrix4x4 Transpose(const Matrix4x4& m) {
+	Matrix4x4 result = {};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+	}
+	return result;
+}
+
+//==== 4x4Matrix同士の乗算 ====
+// SSE版はスカラー版と同じ順番(0から k=0..3 の順に加算)で計算するので結果はビット単位で一致する
+// g++ではスカラー版も自動でベクトル化されるので速度はほぼ同じ(bench/math_bench, g++ -O3)。コンパイラの自動ベクトル化に頼らないためにSSE版を残している
+constexpr Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
+#ifdef MYMATH_USE_SSE
+	if (!std::is_constant_evaluated()) {
+		return MyMathSimd::Multiply(m1, m2);
+	}
+#endif
+	Matrix4x4 result = {};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			for (int k = 0; k < 4; k++) {
+				result.m[i][j] += m1.m[i][k] * m2.m[k][j];
+			}
+		}
+	}
+	return result;
+}
+
+//==== 逆行列の作成 ====
+// SSE版は2x2ブロックに分けて余因子を求める。展開の順番がスカラー版と異なるので、
+// アフィン変換・カメラ行列などの条件数の小さい行列では、スカラー版との差は
+// 結果の最大絶対値要素を基準にして8ULP以内(0に近い要素ほど相対誤差は大きくなる)
+// 速度はスカラー版の約4.5倍(bench/math_bench, g++ -O3)
+constexpr Matrix4x4 Inverse(const Matrix4x4& m) {
+#ifdef MYMATH_USE_SSE
+	if (!std::is_constant_evaluated()) {
+		return MyMathSimd::Inverse(m);
+	}
+#endif
+	float determinant =
+		+m.m[0][0] * m.m[1][1] * m.m[2][2] * m.m[3][3]
+		+ m.m[0][0] * m.m[1][2] * m.m[2][3] * m.m[3][1]
+		+ m.m[0][0] * m.m[1][3] * m.m[2][1] * m.m[3][2]
+
+		- m.m[0][0] * m.m[1][3] * m.m[2][2] * m.m[3][1]
+		- m.m[0][0] * m.m[1][2] * m.m[2][1] * m.m[3][3]
+		- m.m[0][0] * m.m[1][1] * m.m[2][3] * m.m[3][2]
+
+		- m.m[0][1] * m.m[1][0] * m.m[2][2] * m.m[3][3]
+		- m.m[0][2] * m.m[1][0] * m.m[2][3] * m.m[3][1]
+		- m.m[0][3] * m.m[1][0] * m.m[2][1] * m.m[3][2]
+
+		+ m.m[0][3] * m.m[1][0] * m.m[2][2] * m.m[3][1]
+		+ m.m[0][2] * m.m[1][0] * m.m[2][1] * m.m[3][3]
+		+ m.m[0][1] * m.m[1][0] * m.m[2][3] * m.m[3][2]
+
+		+ m.m[0][1] * m.m[1][2] * m.m[2][0] * m.m[3][3]
+		+ m.m[0][2] * m.m[1][3] * m.m[2][0] * m.m[3][1]
+		+ m.m[0][3] * m.m[1][1] * m.m[2][0] * m.m[3][2]
+
+		- m.m[0][3] * m.m[1][2] * m.m[2][0] * m.m[3][1]
+		- m.m[0][2] * m.m[1][1] * m.m[2][0] * m.m[3][3]
+		- m.m[0][1] * m.m[1][3] * m.m[2][0] * m.m[3][2]
+
+		- m.m[0][1] * m.m[1][2] * m.m[2][3] * m.m[3][0]
+		- m.m[0][2] * m.m[1][3] * m.m[2][1] * m.m[3][0]
+		- m.m[0][3] * m.m[1][1] * m.m[2][2] * m.m[3][0]
+
+		+ m.m[0][3] * m.m[1][2] * m.m[2][1] * m.m[3][0]
+		+ m.m[0][2] * m.m[1][1] * m.m[2][3] * m.m[3][0]
+		+ m.m[0][1] * m.m[1][3] * m.m[2][2] * m.m[3][0];
+
+	Matrix4x4 result = {};
+	float recpDeterminant = 1.0f / determinant;
+	result.m[0][0] = (m.m[1][1] * m.m[2][2] * m.m[3][3] + m.m[1][2] * m.m[2][3] * m.m[3][1] +
+		m.m[1][3] * m.m[2][1] * m.m[3][2] - m.m[1][3] * m.m[2][2] * m.m[3][1] -
+		m.m[1][2] * m.m[2][1] * m.m[3][3] - m.m[1][1] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
+	result.m[0][1] = (-m.m[0][1] * m.m[2][2] * m.m[3][3] - m.m[0][2] * m.m[2][3] * m.m[3][1] -
+		m.m[0][3] * m.m[2][1] * m.m[3][2] + m.m[0][3] * m.m[2][2] * m.m[3][1] +
+		m.m[0][2] * m.m[2][1] * m.m[3][3] + m.m[0][1] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
+	result.m[0][2] = (m.m[0][1] * m.m[1][2] * m.m[3][3] + m.m[0][2] * m.m[1][3] * m.m[3][1] +
+		m.m[0][3] * m.m[1][1] * m.m[3][2] - m.m[0][3] * m.m[1][2] * m.m[3][1] -
+		m.m[0][2] * m.m[1][1] * m.m[3][3] - m.m[0][1] * m.m[1][3] * m.m[3][2]) * recpDeterminant;
+	result.m[0][3] = (-m.m[0][1] * m.m[1][2] * m.m[2][3] - m.m[0][2] * m.m[1][3] * m.m[2][1] -
+		m.m[0][3] * m.m[1][1] * m.m[2][2] + m.m[0][3] * m.m[1][2] * m.m[2][1] +
+		m.m[0][2] * m.m[1][1] * m.m[2][3] + m.m[0][1] * m.m[1][3] * m.m[2][2]) * recpDeterminant;
+
+	result.m[1][0] = (-m.m[1][0] * m.m[2][2] * m.m[3][3] - m.m[1][2] * m.m[2][3] * m.m[3][0] -
+		m.m[1][3] * m.m[2][0] * m.m[3][2] + m.m[1][3] * m.m[2][2] * m.m[3][0] +
+		m.m[1][2] * m.m[2][0] * m.m[3][3] + m.m[1][0] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
+	result.m[1][1] = (m.m[0][0] * m.m[2][2] * m.m[3][3] + m.m[0][2] * m.m[2][3] * m.m[3][0] +
+		m.m[0][3] * m.m[2][0] * m.m[3][2] - m.m[0][3] * m.m[2][2] * m.m[3][0] -
+		m.m[0][2] * m.m[2][0] * m.m[3][3] - m.m[0][0] * m.m[2][3] * m.m[3][2]) * recpDeterminant;
+	result.m[1][2] = (-m.m[0][0] * m.m[1][2] * m.m[3][3] - m.m[0][2] * m.m[1][3] * m.m[3][0] -
+		m.m[0][3] * m.m[1][0] * m.m[3][2] + m.m[0][3] * m.m[1][2] * m.m[3][0] +
+		m.m[0][2] * m.m[1][0] * m.m[3][3] + m.m[0][0] * m.m[1][3] * m.m[3][2]) * recpDeterminant;
+	result.m[1][3] = (m.m[0][0] * m.m[1][2] * m.m[2][3] + m.m[0][2] * m.m[1][3] * m.m[2][0] +
+		m.m[0][3] * m.m[1][0] * m.m[2][2] - m.m[0][3] * m.m[1][2] * m.m[2][0] -
+		m.m[0][2] * m.m[1][0] * m.m[2][3] - m.m[0][0] * m.m[1][3] * m.m[2][2]) * recpDeterminant;
+
+	result.m[2][0] = (m.m[1][0] * m.m[2][1] * m.m[3][3] + m.m[1][1] * m.m[2][3] * m.m[3][0] +
+		m.m[1][3] * m.m[2][0] * m.m[3][1] - m.m[1][3] * m.m[2][1] * m.m[3][0] -
+		m.m[1][1] * m.m[2][0] * m.m[3][3] - m.m[1][0] * m.m[2][3] * m.m[3][1]) * recpDeterminant;
+	result.m[2][1] = (-m.m[0][0] * m.m[2][1] * m.m[3][3] - m.m[0][1] * m.m[2][3] * m.m[3][0] -
+		m.m[0][3] * m.m[2][0] * m.m[3][1] + m.m[0][3] * m.m[2][1] * m.m[3][0] +
+		m.m[0][1] * m.m[2][0] * m.m[3][3] + m.m[0][0] * m.m[2][3] * m.m[3][1]) * recpDeterminant;
+	result.m[2][2] = (m.m[0][0] * m.m[1][1] * m.m[3][3] + m.m[0][1] * m.m[1][3] * m.m[3][0] +
+		m.m[0][3] * m.m[1][0] * m.m[3][1] - m.m[0][3] * m.m[1][1] * m.m[3][0] -
+		m.m[0][1] * m.m[1][0] * m.m[3][3] - m.m[0][0] * m.m[1][3] * m.m[3][1]) * recpDeterminant;
+	result.m[2][3] = (-m.m[0][0] * m.m[1][1] * m.m[2][3] - m.m[0][1] * m.m[1][3] * m.m[2][0] -
+		m.m[0][3] * m.m[1][0] * m.m[2][1] + m.m[0][3] * m.m[1][1] * m.m[2][0] +
+		m.m[0][1] * m.m[1][0] * m.m[2][3] + m.m[0][0] * m.m[1][3] * m.m[2][1]) * recpDeterminant;
+
+	result.m[3][0] = (-m.m[1][0] * m.m[2][1] * m.m[3][2] - m.m[1][1] * m.m[2][2] * m.m[3][0] -
+		m.m[1][2] * m.m[2][0] * m.m[3][1] + m.m[1][2] * m.m[2][1] * m.m[3][0] +
+		m.m[1][1] * m.m[2][0] * m.m[3][2] + m.m[1][0] * m.m[2][2] * m.m[3][1]) * recpDeterminant;
+	result.m[3][1] = (m.m[0][0] * m.m[2][1] * m.m[3][2] + m.m[0][1] * m.m[2][2] * m.m[3][0] +
+		m.m[0][2] * m.m[2][0] * m.m[3][1] - m.m[0][2] * m.m[2][1] * m.m[3][0] -
+		m.m[0][1] * m.m[2][0] * m.m[3][2] - m.m[0][0] * m.m[2][2] * m.m[3][1]) * recpDeterminant;
+	result.m[3][2] = (-m.m[0][0] * m.m[1][1] * m.m[3][2] - m.m[0][1] * m.m[1][2] * m.m[3][0] -
+		m.m[0][2] * m.m[1][0] * m.m[3][1] + m.m[0][2] * m.m[1][1] * m.m[3][0] +
+		m.m[0][1] * m.m[1][0] * m.m[3][2] + m.m[0][0] * m.m[1][2] * m.m[3][1]) * recpDeterminant;
+	result.m[3][3] = (m.m[0][0] * m.m[1][1] * m.m[2][2] + m.m[0][1] * m.m[1][2] * m.m[2][0] +
+		m.m[0][2] * m.m[1][0] * m.m[2][1] - m.m[0][2] * m.m[1][1] * m.m[2][0] -
+		m.m[0][1] * m.m[1][0] * m.m[2][2] - m.m[0][0] * m.m[1][2] * m.m[2][1]) * recpDeterminant;
+
+	return result;
+}
+
+//==== 座標変換 ====
+// SSE版もスカラー版と同じ順番で加算するので結果はビット単位で一致する
+constexpr Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
+#ifdef MYMATH_USE_SSE
+	if (!std::is_constant_evaluated()) {
+		return MyMathSimd::Transform(vector, matrix);
+	}
+#endif
+	Vector3 result = {};
+	result.x = vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] + 1.0f * matrix.m[3][0];
+	result.y = vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] + 1.0f * matrix.m[3][1];
+	result.z = vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] + 1.0f * matrix.m[3][2];
+	float w = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] + 1.0f * matrix.m[3][3];
+	assert(w != 0.0f);
+	result.x /= w;
+	result.y /= w;
+	result.z /= w;
+	return result;
+}
+
+//==== ベクトル演算 ====
+constexpr Vector3 Add(const Vector3& v1, const Vector3& v2) {
+	return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z };
+}
+
+constexpr Vector3 Subtract(const Vector3& v1, const Vector3& v2) {
+	return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z };
+}
+
+constexpr float Dot(const Vector3& v1, const Vector3& v2) {
+	return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
+
+constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2) {
+	return { v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x };
+}
+
+inline Vector3 Normalize(const Vector3& v) {
+	float length = std::sqrt(Dot(v, v));
+	assert(length != 0.0f);
+	return { v.x / length, v.y / length, v.z / length };
+}
+
+//==== 拡大縮小 / 平行移動 / 回転行列 ====
+constexpr Matrix4x4 MakeScaleMatrix(const Vector3& scale)
+{
+	Matrix4x4 ans = {};
+
+	ans.m[0][0] = scale.x;
+	ans.m[0][1] = 0;
+	ans.m[0][2] = 0;
+	ans.m[0][3] = 0;
+
+	ans.m[1][0] = 0;
+	ans.m[1][1] = scale.y;
+	ans.m[1][2] = 0;
+	ans.m[1][3] = 0;
+
+	ans.m[2][0] = 0;
+	ans.m[2][1] = 0;
+	ans.m[2][2] = scale.z;
+	ans.m[2][3] = 0;
+
+	ans.m[3][0] = 0;
+	ans.m[3][1] = 0;
+	ans.m[3][2] = 0;
+	ans.m[3][3] = 1;
+	return ans;
+}
+
+constexpr Matrix4x4 MakeTranslateMatrix(const Vector3& translate)
+{
+	Matrix4x4 ans = {};
+
+	ans.m[0][0] = 1;
+	ans.m[0][1] = 0;
+	ans.m[0][2] = 0;
+	ans.m[0][3] = 0;
+
+	ans.m[1][0] = 0;
+	ans.m[1][1] = 1;
+	ans.m[1][2] = 0;
+	ans.m[1][3] = 0;
+
+	ans.m[2][0] = 0;
+	ans.m[2][1] = 0;
+	ans.m[2][2] = 1;
+	ans.m[2][3] = 0;
+
+	ans.m[3][0] = translate.x;
+	ans.m[3][1] = translate.y;
+	ans.m[3][2] = translate.z;
+	ans.m[3][3] = 1;
+
+	return ans;
+}
+
+inline Matrix4x4 MakeRotateXMatrix(float radian)
+{
+	Matrix4x4 ans;
+	float sinValue, cosValue;
+	SinCos(radian, sinValue, cosValue);
+
+	ans.m[0][0] = 1;
+	ans.m[0][1] = 0;
+	ans.m[0][2] = 0;
+	ans.m[0][3] = 0;
+
+	ans.m[1][0] = 0;
+	ans.m[1][1] = cosValue;
+	ans.m[1][2] = sinValue;
+	ans.m[1][3] = 0;
+
+	ans.m[2][0] = 0;
+	ans.m[2][1] = -sinValue;
+	ans.m[2][2] = cosValue;
+	ans.m[2][3] = 0;
+
+	ans.m[3][0] = 0;
+	ans.m[3][1] = 0;
+	ans.m[3][2] = 0;
+	ans.m[3][3] = 1;
+
+	return ans;
+}
+
+inline Matrix4x4 MakeRotateYMatrix(float radian)
+{
+	Matrix4x4 ans;
+	float sinValue, cosValue;
+	SinCos(radian, sinValue, cosValue);
+
+	ans.m[0][0] = cosValue;
+	ans.m[0][1] = 0;
+	ans.m[0][2] = -sinValue;
+	ans.m[0][3] = 0;
+
+	ans.m[1][0] = 0;
+	ans.m[1][1] = 1;
+	ans.m[1][2] = 0;
+	ans.m[1][3] = 0;
+
+	ans.m[2][0] = sinValue;
+	ans.m[2][1] = 0;
+	ans.m[2][2] = cosValue;
+	ans.m[2][3] = 0;
+
+	ans.m[3][0] = 0;
+	ans.m[3][1] = 0;
+	ans.m[3][2] = 0;
+	ans.m[3][3] = 1;
+
+	return ans;
+}
+
+inline Matrix4x4 MakeRotateZMatrix(float radian)
+{
+	Matrix4x4 ans;
+	float sinValue, cosValue;
+	SinCos(radian, sinValue, cosValue);
+
+	ans.m[0][0] = cosValue;
+	ans.m[0][1] = sinValue;
+	ans.m[0][2] = 0;
+	ans.m[0][3] = 0;
+
+	ans.m[1][0] = -sinValue;
+	ans.m[1][1] = cosValue;
+	ans.m[1][2] = 0;
+	ans.m[1][3] = 0;
+
+	ans.m[2][0] = 0;
+	ans.m[2][1] = 0;
+	ans.m[2][2] = 1;
+	ans.m[2][3] = 0;
+
+	ans.m[3][0] = 0;
+	ans.m[3][1] = 0;
+	ans.m[3][2] = 0;
+	ans.m[3][3] = 1;
+
+
+	return ans;
+}
+
+//==== 回転行列の作成 ====
+// Multiply(rotateX, Multiply(rotateY, rotateZ))を展開した形で直接書く
+// 掛ける順番は展開前と同じなので結果も一致する
+inline Matrix4x4 MakeRotateMatrix(const Vector3& rotate) {
+	float sx, cx, sy, cy, sz, cz;
+	SinCos(rotate.x, sx, cx);
+	SinCos(rotate.y, sy, cy);
+	SinCos(rotate.z, sz, cz);
+	Matrix4x4 result = {
+		cy * cz, cy * sz, -sy, 0,
+		cx * -sz + sx * (sy * cz), cx * cz + sx * (sy * sz), sx * cy, 0,
+		-sx * -sz + cx * (sy * cz), -sx * cz + cx * (sy * sz), cx * cy, 0,
+		0, 0, 0, 1
+	};
+	return result;
+}
+
+//==== アフィン行列の作成 ====
+inline Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	Matrix4x4 result;
+	Matrix4x4 rotateM = MakeRotateMatrix(rotate);
+	result = {
+		scale.x * rotateM.m[0][0],scale.x * rotateM.m[0][1],scale.x * rotateM.m[0][2],0,
+		scale.y * rotateM.m[1][0],scale.y * rotateM.m[1][1],scale.y * rotateM.m[1][2],0,
+		scale.z * rotateM.m[2][0],scale.z * rotateM.m[2][1],scale.z * rotateM.m[2][2],0,
+		translate.x,translate.y,translate.z,1
+	};
+	return result;
+}
+
+//==== クォータニオン ====
+constexpr Quaternion IdentityQuaternion() {
+	return { 0.0f, 0.0f, 0.0f, 1.0f };
+}
+
+// q1*q2 (q2の回転のあとにq1の回転)
+constexpr Quaternion Multiply(const Quaternion& q1, const Quaternion& q2) {
+	return {
+		q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
+		q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x,
+		q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w,
+		q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z
+	};
+}
+
+constexpr Quaternion Conjugate(const Quaternion& q) {
+	return { -q.x, -q.y, -q.z, q.w };
+}
+
+constexpr float Dot(const Quaternion& q1, const Quaternion& q2) {
+	return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+}
+
+inline Quaternion Normalize(const Quaternion& q) {
+	float length = std::sqrt(Dot(q, q));
+	assert(length != 0.0f);
+	return { q.x / length, q.y / length, q.z / length, q.w / length };
+}
+
+// 単位クォータニオンの逆は共役
+inline Quaternion Inverse(const Quaternion& q) {
+	float norm = Dot(q, q);
+	assert(norm != 0.0f);
+	return { -q.x / norm, -q.y / norm, -q.z / norm, q.w / norm };
+}
+
+// axisは正規化されていること
+inline Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle) {
+	float s, c;
+	SinCos(angle * 0.5f, s, c);
+	return { axis.x * s, axis.y * s, axis.z * s, c };
+}
+
+// MakeRotateMatrix(rotate)と同じ回転(X→Y→Zの順に回す)を表すクォータニオン
+inline Quaternion MakeRotateQuaternion(const Vector3& rotate) {
+	float sx, cx, sy, cy, sz, cz;
+	SinCos(rotate.x * 0.5f, sx, cx);
+	SinCos(rotate.y * 0.5f, sy, cy);
+	SinCos(rotate.z * 0.5f, sz, cz);
+	return {
+		sx * cy * cz - cx * sy * sz,
+		cx * sy * cz + sx * cy * sz,
+		cx * cy * sz - sx * sy * cz,
+		cx * cy * cz + sx * sy * sz
+	};
+}
+
+// ベクトルをクォータニオンで回転させる
+constexpr Vector3 RotateVector(const Vector3& vector, const Quaternion& q) {
+	// v' = v + 2w(u×v) + 2u×(u×v) (uはqの虚部)
+	Vector3 u = { q.x, q.y, q.z };
+	Vector3 t = Cross(u, vector);
+	t = { t.x * 2.0f, t.y * 2.0f, t.z * 2.0f };
+	Vector3 ut = Cross(u, t);
+	return { vector.x + q.w * t.x + ut.x, vector.y + q.w * t.y + ut.y, vector.z + q.w * t.z + ut.z };
+}
+
+// 正規化線形補間。角度の変化は一定にならないが、slerpより軽い
+inline Quaternion Nlerp(const Quaternion& q0, const Quaternion& q1, float t) {
+	// 遠回りしないように向きを揃える
+	float sign = Dot(q0, q1) < 0.0f ? -1.0f : 1.0f;
+	return Normalize(Quaternion{
+		q0.x + (sign * q1.x - q0.x) * t,
+		q0.y + (sign * q1.y - q0.y) * t,
+		q0.z + (sign * q1.z - q0.z) * t,
+		q0.w + (sign * q1.w - q0.w) * t });
+}
+
+// 球面線形補間
+inline Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t) {
+	float dot = Dot(q0, q1);
+	Quaternion end = q1;
+	if (dot < 0.0f) {
+		end = { -q1.x, -q1.y, -q1.z, -q1.w };
+		dot = -dot;
+	}
+	// ほぼ同じ向きのときはsinθが0に近く不安定なのでnlerpにする
+	if (dot > 0.9995f) {
+		return Nlerp(q0, end, t);
+	}
+	float theta = std::acos(dot);
+	float sinTheta = std::sin(theta);
+	float scale0 = std::sin((1.0f - t) * theta) / sinTheta;
+	float scale1 = std::sin(t * theta) / sinTheta;
+	return {
+		scale0 * q0.x + scale1 * end.x,
+		scale0 * q0.y + scale1 * end.y,
+		scale0 * q0.z + scale1 * end.z,
+		scale0 * q0.w + scale1 * end.w };
+}
+
+constexpr Matrix4x4 MakeRotateMatrix(const Quaternion& q) {
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	Matrix4x4 result = {
+		1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f,
+		2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f,
+		2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	return result;
+}
+
+// 拡縮・回転・平行移動の12要素を途中の行列を作らずに直接書き込む
+// MakeAffineMatrixのオーバーロードにすると、{ }で渡したときにVector3とQuaternionのどちらか決まらなくなるので名前を分ける
+constexpr Matrix4x4 MakeAffineMatrixQuaternion(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	const Quaternion& q = rotate;
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	Matrix4x4 result = {
+		scale.x * (1.0f - 2.0f * (yy + zz)), scale.x * 2.0f * (xy + wz), scale.x * 2.0f * (xz - wy), 0.0f,
+		scale.y * 2.0f * (xy - wz), scale.y * (1.0f - 2.0f * (xx + zz)), scale.y * 2.0f * (yz + wx), 0.0f,
+		scale.z * 2.0f * (xz + wy), scale.z * 2.0f * (yz - wx), scale.z * (1.0f - 2.0f * (xx + yy)), 0.0f,
+		translate.x, translate.y, translate.z, 1.0f
+	};
+	return result;
+}
+
+//==== アフィン行列 / 剛体行列の逆行列 ====
+// 精度は倍精度のGauss-Jordan法との差で一般のInverseと同程度(tests/math_test)
+// 速度はスカラー版Inverseの約3~4倍だが、SSE版Inverseよりは遅い(bench/math_bench, g++ -O3)
+constexpr Matrix4x4 InverseAffine(const Matrix4x4& m) {
+	// 3x3部分の余因子
+	float c00 = m.m[1][1] * m.m[2][2] - m.m[1][2] * m.m[2][1];
+	float c01 = m.m[1][2] * m.m[2][0] - m.m[1][0] * m.m[2][2];
+	float c02 = m.m[1][0] * m.m[2][1] - m.m[1][1] * m.m[2][0];
+	float determinant = m.m[0][0] * c00 + m.m[0][1] * c01 + m.m[0][2] * c02;
+	assert(determinant != 0.0f);
+	float recpDeterminant = 1.0f / determinant;
+
+	Matrix4x4 result = {};
+	result.m[0][0] = c00 * recpDeterminant;
+	result.m[1][0] = c01 * recpDeterminant;
+	result.m[2][0] = c02 * recpDeterminant;
+	result.m[0][1] = (m.m[0][2] * m.m[2][1] - m.m[0][1] * m.m[2][2]) * recpDeterminant;
+	result.m[1][1] = (m.m[0][0] * m.m[2][2] - m.m[0][2] * m.m[2][0]) * recpDeterminant;
+	result.m[2][1] = (m.m[0][1] * m.m[2][0] - m.m[0][0] * m.m[2][1]) * recpDeterminant;
+	result.m[0][2] = (m.m[0][1] * m.m[1][2] - m.m[0][2] * m.m[1][1]) * recpDeterminant;
+	result.m[1][2] = (m.m[0][2] * m.m[1][0] - m.m[0][0] * m.m[1][2]) * recpDeterminant;
+	result.m[2][2] = (m.m[0][0] * m.m[1][1] - m.m[0][1] * m.m[1][0]) * recpDeterminant;
+	result.m[0][3] = 0.0f;
+	result.m[1][3] = 0.0f;
+	result.m[2][3] = 0.0f;
+
+	// 平行移動は -t * A^-1
+	for (int j = 0; j < 3; j++) {
+		result.m[3][j] = -(m.m[3][0] * result.m[0][j] + m.m[3][1] * result.m[1][j] + m.m[3][2] * result.m[2][j]);
+	}
+	result.m[3][3] = 1.0f;
+	return result;
+}
+
+constexpr Matrix4x4 InverseRigid(const Matrix4x4& m) {
+	Matrix4x4 result = {};
+	// 回転行列の逆行列は転置
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+		result.m[i][3] = 0.0f;
+	}
+	// 平行移動は -t * R^T
+	for (int j = 0; j < 3; j++) {
+		result.m[3][j] = -(m.m[3][0] * m.m[j][0] + m.m[3][1] * m.m[j][1] + m.m[3][2] * m.m[j][2]);
+	}
+	result.m[3][3] = 1.0f;
+	return result;
+}
+
+//==== アフィン行列(3x4) / UV変換行列(2x4) ====
+// 4x4のアフィン行列から3x4へ(4列目は捨てる)
+constexpr Matrix3x4 ToMatrix3x4(const Matrix4x4& m) {
+	Matrix3x4 result = {};
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+	}
+	return result;
+}
+
+constexpr Matrix4x4 ToMatrix4x4(const Matrix3x4& m) {
+	Matrix4x4 result = {};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 3; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+	}
+	result.m[3][3] = 1.0f;
+	return result;
+}
+
+// Multiply(ToMatrix4x4(m1), ToMatrix4x4(m2))と同じ(m1の変換のあとにm2の変換)
+constexpr Matrix3x4 Multiply(const Matrix3x4& m1, const Matrix3x4& m2) {
+	Matrix3x4 result = {};
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m2.m[i][0] * m1.m[0][j] + m2.m[i][1] * m1.m[1][j] + m2.m[i][2] * m1.m[2][j];
+		}
+		result.m[i][3] += m2.m[i][3];
+	}
+	return result;
+}
+
+constexpr Matrix3x4 Inverse(const Matrix3x4& m) {
+	return ToMatrix3x4(InverseAffine(ToMatrix4x4(m)));
+}
+
+constexpr Vector3 Transform(const Vector3& vector, const Matrix3x4& matrix) {
+	return {
+		matrix.m[0][0] * vector.x + matrix.m[0][1] * vector.y + matrix.m[0][2] * vector.z + matrix.m[0][3],
+		matrix.m[1][0] * vector.x + matrix.m[1][1] * vector.y + matrix.m[1][2] * vector.z + matrix.m[1][3],
+		matrix.m[2][0] * vector.x + matrix.m[2][1] * vector.y + matrix.m[2][2] * vector.z + matrix.m[2][3]
+	};
+}
+
+inline Matrix3x4 MakeAffineMatrix3x4(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	return ToMatrix3x4(MakeAffineMatrix(scale, rotate, translate));
+}
+
+// UV変換として使う4x4行列(x,yと平行移動だけ)から2x4へ
+constexpr Matrix2x4 ToMatrix2x4(const Matrix4x4& m) {
+	Matrix2x4 result = {};
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+	}
+	return result;
+}
+
+// 拡縮→Z回転→平行移動のUV変換行列
+// Multiply(Multiply(MakeScaleMatrix(scale), MakeRotateZMatrix(rotateZ)), MakeTranslateMatrix(translate))と同じ
+inline Matrix2x4 MakeUVTransformMatrix(const Vector3& scale, float rotateZ, const Vector3& translate) {
+	float sinValue, cosValue;
+	SinCos(rotateZ, sinValue, cosValue);
+	Matrix2x4 result = {
+		scale.x * cosValue, scale.y * -sinValue, 0.0f, translate.x,
+		scale.x * sinValue, scale.y * cosValue, 0.0f, translate.y
+	};
+	return result;
+}
+
+//==== ビュー行列 ====
+inline Matrix4x4 MakeViewMatrix(const Vector3& rotate, const Vector3& translate) {
+	Matrix4x4 rotateM = MakeRotateMatrix(rotate);
+	rotateM.m[3][0] = translate.x;
+	rotateM.m[3][1] = translate.y;
+	rotateM.m[3][2] = translate.z;
+	return InverseRigid(rotateM);
+}
+
+inline Matrix4x4 MakeLookAtMatrix(const Vector3& eye, const Vector3& target, const Vector3& up) {
+	Vector3 zAxis = Normalize(Subtract(target, eye));
+	Vector3 xAxis = Normalize(Cross(up, zAxis));
+	Vector3 yAxis = Cross(zAxis, xAxis);
+	Matrix4x4 result = {
+		xAxis.x, yAxis.x, zAxis.x, 0.0f,
+		xAxis.y, yAxis.y, zAxis.y, 0.0f,
+		xAxis.z, yAxis.z, zAxis.z, 0.0f,
+		-Dot(xAxis, eye), -Dot(yAxis, eye), -Dot(zAxis, eye), 1.0f
+	};
+	return result;
+}
+
+//==== 透視投影行列 ====
+inline Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip) {
+	Matrix4x4 result;
+	result = {
+		(1 / aspectRatio) * Cot(fovY / 2),0,0,0,
+		0,Cot(fovY / 2),0,0,
+		0,0,farClip / (farClip - nearClip),1,
+		0,0,(-nearClip * farClip) / (farClip - nearClip),0
+	};
+	return result;
+}
+
+//==== 平行投影行列 ====
+constexpr Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
+
+	Matrix4x4 result;
+
+	result = {
+	2 / (right - left),0.0f,0.0f,0.0f,
+	0.0f,2 / (top - bottom),0.0f,0.0f,
+	0.0f,0.0f,1 / (farClip - nearClip),0.0f,
+	(left + right) / (left - right),(top + bottom) / (bottom - top),nearClip / (nearClip - farClip),1.0f
+	};
+
+	return result;
+}
+
+//==== ビューポート ====
+constexpr Matrix4x4 MakeViewportMatrix(float left, float top, float width, float height, float minDepth, float maxDepth)
+{
+	Matrix4x4 ans = {};
+
+
+
+	ans.m[0][0] = width / 2;
+	ans.m[0][1] = 0;
+	ans.m[0][2] = 0;
+	ans.m[0][3] = 0;
+
+	ans.m[1][0] = 0;
+	ans.m[1][1] = -(height / 2);
+	ans.m[1][2] = 0;
+	ans.m[1][3] = 0;
+
+	ans.m[2][0] = 0;
+	ans.m[2][1] = 0;
+	ans.m[2][2] = maxDepth - minDepth;
+	ans.m[2][3] = 0;
+
+	ans.m[3][0] = left + (width / 2);
+	ans.m[3][1] = top + (height / 2);
+	ans.m[3][2] = minDepth;
+	ans.m[3][3] = 1;
+
+
+
+
+	return ans;
+
+}
+
+//==== 一括処理 ====
+// 1回の呼び出しで配列全体を処理し、関数呼び出しのコストを要素数で割る
+// results[i] = m1[i] * m2 (ワールド行列の配列にビュープロジェクション行列を掛けるなど)
+inline void Multiply(std::span<const Matrix4x4> m1, const Matrix4x4& m2, std::span<Matrix4x4> results) {
+	assert(m1.size() == results.size());
+#ifdef MYMATH_USE_SSE
+	// m2の4行はループの外で1回だけ読み込む
+	const __m128 b0 = _mm_loadu_ps(m2.m[0]);
+	const __m128 b1 = _mm_loadu_ps(m2.m[1]);
+	const __m128 b2 = _mm_loadu_ps(m2.m[2]);
+	const __m128 b3 = _mm_loadu_ps(m2.m[3]);
+	for (size_t n = 0; n < m1.size(); n++) {
+		const Matrix4x4& a = m1[n];
+		Matrix4x4& result = results[n];
+		for (int i = 0; i < 4; i++) {
+			__m128 row = _mm_setzero_ps();
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][0]), b0));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][1]), b1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][2]), b2));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][3]), b3));
+			_mm_storeu_ps(result.m[i], row);
+		}
+	}
+#else
+	for (size_t n = 0; n < m1.size(); n++) {
+		results[n] = Multiply(m1[n], m2);
+	}
+#endif
+}
+
+// results[i] = Transform(points[i], matrix) (w除算あり)
+inline void TransformPoints(const ConstVector3SoA& points, const Matrix4x4& matrix, const Vector3SoA& results) {
+	const size_t count = points.x.size();
+	assert(points.y.size() == count && points.z.size() == count);
+	assert(results.x.size() == count && results.y.size() == count && results.z.size() == count);
+
+	size_t i = 0;
+#ifdef MYMATH_USE_SSE
+	const Matrix4x4& m = matrix;
+	// 4要素ずつ処理する。加算の順番はTransformと同じなので結果も一致する
+	const __m128 m00 = _mm_set1_ps(m.m[0][0]), m01 = _mm_set1_ps(m.m[0][1]), m02 = _mm_set1_ps(m.m[0][2]), m03 = _mm_set1_ps(m.m[0][3]);
+	const __m128 m10 = _mm_set1_ps(m.m[1][0]), m11 = _mm_set1_ps(m.m[1][1]), m12 = _mm_set1_ps(m.m[1][2]), m13 = _mm_set1_ps(m.m[1][3]);
+	const __m128 m20 = _mm_set1_ps(m.m[2][0]), m21 = _mm_set1_ps(m.m[2][1]), m22 = _mm_set1_ps(m.m[2][2]), m23 = _mm_set1_ps(m.m[2][3]);
+	const __m128 m30 = _mm_set1_ps(m.m[3][0]), m31 = _mm_set1_ps(m.m[3][1]), m32 = _mm_set1_ps(m.m[3][2]), m33 = _mm_set1_ps(m.m[3][3]);
+	for (; i + 4 <= count; i += 4) {
+		const __m128 x = _mm_loadu_ps(&points.x[i]);
+		const __m128 y = _mm_loadu_ps(&points.y[i]);
+		const __m128 z = _mm_loadu_ps(&points.z[i]);
+		const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20)), m30);
+		const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21)), m31);
+		const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22)), m32);
+		const __m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m03), _mm_mul_ps(y, m13)), _mm_mul_ps(z, m23)), m33);
+		_mm_storeu_ps(&results.x[i], _mm_div_ps(rx, w));
+		_mm_storeu_ps(&results.y[i], _mm_div_ps(ry, w));
+		_mm_storeu_ps(&results.z[i], _mm_div_ps(rz, w));
+	}
+#endif
+	// 端数(SIMDが使えない場合は全部)
+	for (; i < count; i++) {
+		Vector3 result = Transform({ points.x[i], points.y[i], points.z[i] }, matrix);
+		results.x[i] = result.x;
+		results.y[i] = result.y;
+		results.z[i] = result.z;
+	}
+}
+
+// 法線・方向ベクトル用。平行移動を無視して3x3部分だけを掛ける
+inline void TransformNormals(const ConstVector3SoA& normals, const Matrix4x4& matrix, const Vector3SoA& results) {
+	const size_t count = normals.x.size();
+	assert(normals.y.size() == count && normals.z.size() == count);
+	assert(results.x.size() == count && results.y.size() == count && results.z.size() == count);
+
+	const Matrix4x4& m = matrix;
+	size_t i = 0;
+#ifdef MYMATH_USE_SSE
+	const __m128 m00 = _mm_set1_ps(m.m[0][0]), m01 = _mm_set1_ps(m.m[0][1]), m02 = _mm_set1_ps(m.m[0][2]);
+	const __m128 m10 = _mm_set1_ps(m.m[1][0]), m11 = _mm_set1_ps(m.m[1][1]), m12 = _mm_set1_ps(m.m[1][2]);
+	const __m128 m20 = _mm_set1_ps(m.m[2][0]), m21 = _mm_set1_ps(m.m[2][1]), m22 = _mm_set1_ps(m.m[2][2]);
+	for (; i + 4 <= count; i += 4) {
+		const __m128 x = _mm_loadu_ps(&normals.x[i]);
+		const __m128 y = _mm_loadu_ps(&normals.y[i]);
+		const __m128 z = _mm_loadu_ps(&normals.z[i]);
+		_mm_storeu_ps(&results.x[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20)));
+		_mm_storeu_ps(&results.y[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21)));
+		_mm_storeu_ps(&results.z[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22)));
+	}
+#endif
+	for (; i < count; i++) {
+		const float x = normals.x[i];
+		const float y = normals.y[i];
+		const float z = normals.z[i];
+		results.x[i] = x * m.m[0][0] + y * m.m[1][0] + z * m.m[2][0];
+		results.y[i] = x * m.m[0][1] + y * m.m[1][1] + z * m.m[2][1];
+		results.z[i] = x * m.m[0][2] + y * m.m[1][2] + z * m.m[2][2];
+	}
+}
\ No newline at end of file
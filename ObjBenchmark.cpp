@@ -0,0 +1,420 @@
+#include "ObjBenchmark.h"
+#include "ObjLoader.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+#pragma region 合成objの書き出し
+// 実装によって結果が変わらないように、乱数は標準の分布を使わずにsplitmix64から直接作る
+class SplitMix64 {
+public:
+	explicit SplitMix64(uint64_t seed)
+		: state_(seed) {}
+
+	uint64_t Next() {
+		uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+	// [0, 1)
+	float NextFloat() {
+		return static_cast<float>(Next() >> 40) * (1.0f / 16777216.0f);
+	}
+
+private:
+	uint64_t state_;
+};
+
+// テキストをまとめてファイルに書き出す
+class TextWriter {
+public:
+	explicit TextWriter(const std::string& path)
+		: file_(path, std::ios::binary) {
+		buffer_.reserve(kFlushSize + 4096);
+	}
+	~TextWriter() {
+		if (file_.is_open()) {
+			Flush();
+		}
+	}
+
+	bool IsOpen() const { return file_.is_open(); }
+	uint64_t Bytes() const { return written_ + buffer_.size(); }
+
+	TextWriter& operator<<(std::string_view text) {
+		buffer_ += text;
+		if (buffer_.size() >= kFlushSize) {
+			Flush();
+		}
+		return *this;
+	}
+	TextWriter& operator<<(uint64_t value) {
+		char text[24];
+		auto [end, error] = std::to_chars(text, text + sizeof(text), value);
+		return *this << std::string_view(text, static_cast<size_t>(end - text));
+	}
+	TextWriter& operator<<(float value) {
+		char text[48];
+		auto [end, error] = std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, 6);
+		return *this << std::string_view(text, static_cast<size_t>(end - text));
+	}
+
+	void Flush() {
+		file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+		written_ += buffer_.size();
+		buffer_.clear();
+	}
+
+	// 残りを書き出して閉じる。ディスクがいっぱいなどで書けなかったものがあればfalse
+	bool Finish() {
+		Flush();
+		file_.close();
+		return !file_.fail();
+	}
+
+private:
+	static constexpr size_t kFlushSize = 1 << 20;
+	std::ofstream file_;
+	std::string buffer_;
+	uint64_t written_ = 0;
+};
+
+// 1つのパッチの四角形の数(一辺)。パッチは一辺1の正方形で、これを横に並べていく
+constexpr uint32_t kPatchQuads = 16;
+constexpr uint32_t kPatchesPerRow = 256;
+
+// 合成objを1行ずつ書く
+class SyntheticObjWriter {
+public:
+	SyntheticObjWriter(TextWriter& writer, const SyntheticObjSettings& settings)
+		: writer_(writer), settings_(settings), random_(settings.seed) {}
+
+	// パッチの中の位置(0~kPatchQuads)の頂点の「v・vt・vn」を書く
+	void WriteVertex(uint32_t patchIndex, uint32_t x, uint32_t z) {
+		const float worldX = static_cast<float>(patchIndex % kPatchesPerRow) + static_cast<float>(x) / kPatchQuads;
+		const float worldZ = static_cast<float>(patchIndex / kPatchesPerRow) + static_cast<float>(z) / kPatchQuads;
+		//なだらかな起伏にして、法線はその傾きから求める
+		const float height = 0.1f * std::sin(worldX * 3.0f) * std::cos(worldZ * 2.0f);
+		const float slopeX = 0.3f * std::cos(worldX * 3.0f) * std::cos(worldZ * 2.0f);
+		const float slopeZ = -0.2f * std::sin(worldX * 3.0f) * std::sin(worldZ * 2.0f);
+		const float inverseLength = 1.0f / std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+		Comment();
+		writer_ << "v " << worldX << " " << height << " " << worldZ << "\n";
+		Comment();
+		writer_ << "vt " << static_cast<float>(x) / kPatchQuads << " " << static_cast<float>(z) / kPatchQuads << "\n";
+		Comment();
+		writer_ << "vn " << -slopeX * inverseLength << " " << inverseLength << " " << -slopeZ * inverseLength << "\n";
+		++positionCount_;
+	}
+
+	// 三角形を1つ書く。インデックスは1始まりで、位置・UV・法線は同じ番号
+	void WriteFace(uint64_t a, uint64_t b, uint64_t c) {
+		if (settings_.materialCount > 0 && faceCount_ % (std::max)(settings_.facesPerMaterialRun, 1u) == 0) {
+			writer_ << "usemtl material_" << random_.Next() % settings_.materialCount << "\n";
+		}
+		if (settings_.facesPerGroup > 0 && faceCount_ % settings_.facesPerGroup == 0) {
+			const uint64_t group = faceCount_ / settings_.facesPerGroup;
+			writer_ << "o object_" << group << "\n";
+			writer_ << "g group_" << group << "\n";
+		}
+		Comment();
+		writer_ << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " " << c << "/" << c << "/" << c << "\n";
+		++faceCount_;
+	}
+
+	// 頂点を共有するグリッドか、三角形ごとに頂点を持つパッチを1つ書く
+	void WritePatch(uint32_t patchIndex) {
+		if (random_.NextFloat() < settings_.sharedVertexRatio) {
+			const uint64_t base = positionCount_ + 1;
+			for (uint32_t z = 0; z <= kPatchQuads; ++z) {
+				for (uint32_t x = 0; x <= kPatchQuads; ++x) {
+					WriteVertex(patchIndex, x, z);
+				}
+			}
+			for (uint32_t z = 0; z < kPatchQuads; ++z) {
+				for (uint32_t x = 0; x < kPatchQuads; ++x) {
+					const uint64_t v00 = base + z * (kPatchQuads + 1) + x;
+					const uint64_t v10 = v00 + 1;
+					const uint64_t v01 = v00 + kPatchQuads + 1;
+					const uint64_t v11 = v01 + 1;
+					WriteFace(v00, v01, v10);
+					WriteFace(v10, v01, v11);
+				}
+			}
+		}
+		else {
+			for (uint32_t z = 0; z < kPatchQuads; ++z) {
+				for (uint32_t x = 0; x < kPatchQuads; ++x) {
+					const uint32_t triangles[2][3][2] = { { {x, z}, {x, z + 1}, {x + 1, z} }, { {x + 1, z}, {x, z + 1}, {x + 1, z + 1} } };
+					for (const auto& triangle : triangles) {
+						const uint64_t base = positionCount_ + 1;
+						for (const auto& corner : triangle) {
+							WriteVertex(patchIndex, corner[0], corner[1]);
+						}
+						WriteFace(base, base + 1, base + 2);
+					}
+				}
+			}
+		}
+	}
+
+	uint64_t PositionCount() const { return positionCount_; }
+	uint64_t FaceCount() const { return faceCount_; }
+
+private:
+	// 決められた割合でコメント行を入れる
+	void Comment() {
+		if (settings_.commentRatio > 0.0f && random_.NextFloat() < settings_.commentRatio) {
+			writer_ << "# synthetic comment " << random_.Next() << "\n";
+		}
+	}
+
+	TextWriter& writer_;
+	const SyntheticObjSettings& settings_;
+	SplitMix64 random_;
+	uint64_t positionCount_ = 0;
+	uint64_t faceCount_ = 0;
+};
+#pragma endregion
+
+#pragma region 計測
+#ifndef _WIN32
+// /proc/self/statusの「name: 値 kB」の行をバイト数で返す。読めなければ0
+uint64_t ReadProcStatusBytes(const char* name) {
+	FILE* file = std::fopen("/proc/self/status", "r");
+	if (!file) {
+		return 0;
+	}
+	const size_t nameLength = std::strlen(name);
+	uint64_t bytes = 0;
+	char line[256];
+	while (std::fgets(line, sizeof(line), file)) {
+		if (std::strncmp(line, name, nameLength) == 0 && line[nameLength] == ':') {
+			bytes = std::strtoull(line + nameLength + 1, nullptr, 10) * 1024;
+			break;
+		}
+	}
+	std::fclose(file);
+	return bytes;
+}
+#endif
+#pragma endregion
+
+}
+
+uint64_t GetCurrentResidentBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#else
+	return ReadProcStatusBytes("VmRSS");
+#endif
+}
+
+uint64_t GetPeakResidentBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+#else
+	//VmHWMはResetPeakResidentBytesで戻せる。読めなければ戻せないgetrusageの値を使う
+	if (const uint64_t bytes = ReadProcStatusBytes("VmHWM")) {
+		return bytes;
+	}
+	rusage usage = {};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  //Linuxではキロバイト単位
+#endif
+}
+
+bool ResetPeakResidentBytes() {
+#ifdef _WIN32
+	return false;
+#else
+	//Linux 4.0以降は/proc/self/clear_refsに5を書くとVmHWMが今の使用量に戻る
+	FILE* file = std::fopen("/proc/self/clear_refs", "w");
+	if (!file) {
+		return false;
+	}
+	const bool succeeded = std::fputs("5", file) >= 0;
+	return std::fclose(file) == 0 && succeeded;
+#endif
+}
+
+SyntheticObjInfo WriteSyntheticObj(const std::string& directoryPath, const std::string& filename, const SyntheticObjSettings& settings) {
+	SyntheticObjInfo info;
+	const std::string materialFilename = std::filesystem::path(filename).replace_extension(".mtl").string();
+	//途中までのファイルが残ると次回にそのまま使われてしまうので、objは別の名前に書いて最後に付け替え、失敗したら消す
+	const std::string objPath = directoryPath + "/" + filename;
+	const std::string partialPath = objPath + ".partial";
+	auto fail = [&]() {
+		std::error_code error;
+		std::filesystem::remove(partialPath, error);
+		std::filesystem::remove(objPath, error);
+		std::filesystem::remove(directoryPath + "/" + materialFilename, error);
+		return SyntheticObjInfo{};
+	};
+	if (settings.materialCount > 0) {
+		TextWriter mtl(directoryPath + "/" + materialFilename);
+		if (!mtl.IsOpen()) {
+			return fail();
+		}
+		SplitMix64 random(settings.seed ^ 0x6D746Cull);
+		mtl << "# synthetic material library\n";
+		for (uint32_t i = 0; i < settings.materialCount; ++i) {
+			mtl << "newmtl material_" << static_cast<uint64_t>(i) << "\n";
+			mtl << "Kd " << random.NextFloat() << " " << random.NextFloat() << " " << random.NextFloat() << "\n";
+			mtl << "d " << 1.0f << "\n";
+		}
+		if (!mtl.Finish()) {
+			return fail();
+		}
+	}
+
+	TextWriter obj(partialPath);
+	if (!obj.IsOpen()) {
+		return fail();
+	}
+	obj << "# synthetic obj\n";
+	if (settings.materialCount > 0) {
+		obj << "mtllib " << materialFilename << "\n";
+	}
+	SyntheticObjWriter writer(obj, settings);
+	for (uint32_t patchIndex = 0; obj.Bytes() < settings.targetBytes; ++patchIndex) {
+		writer.WritePatch(patchIndex);
+	}
+	info.bytes = obj.Bytes();
+	if (!obj.Finish()) {
+		return fail();
+	}
+	std::error_code error;
+	std::filesystem::rename(partialPath, objPath, error);
+	if (error) {
+		return fail();
+	}
+	info.succeeded = true;
+	info.positionCount = writer.PositionCount();
+	info.faceCount = writer.FaceCount();
+	return info;
+}
+
+std::string MakeSyntheticObjFilename(const SyntheticObjSettings& settings) {
+	//設定を並べてFNV-1aでハッシュする。書き出し方を変えたらkSyntheticObjVersionを上げる
+	constexpr uint32_t kSyntheticObjVersion = 1;
+	uint64_t hash = 0xCBF29CE484222325ull;
+	auto add = [&](const auto& value) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+		for (size_t i = 0; i < sizeof(value); ++i) {
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		}
+	};
+	add(kSyntheticObjVersion);
+	add(settings.targetBytes);
+	add(settings.seed);
+	add(settings.sharedVertexRatio);
+	add(settings.materialCount);
+	add(settings.facesPerMaterialRun);
+	add(settings.facesPerGroup);
+	add(settings.commentRatio);
+	char name[96];
+	std::snprintf(name, sizeof(name), "synthetic_%llu_%016llx.obj", static_cast<unsigned long long>(settings.targetBytes), static_cast<unsigned long long>(hash));
+	return name;
+}
+
+bool PrepareSyntheticObj(const std::string& directoryPath, const SyntheticObjSettings& settings, std::string& filename) {
+	filename = MakeSyntheticObjFilename(settings);
+	//objは書き終わってから今の名前に付け替えるので、あれば最後まで書けている
+	std::error_code error;
+	const bool hasObj = std::filesystem::exists(directoryPath + "/" + filename, error);
+	const bool hasMaterial = settings.materialCount == 0 ||
+		std::filesystem::exists(directoryPath + "/" + std::filesystem::path(filename).replace_extension(".mtl").string(), error);
+	if (hasObj && hasMaterial) {
+		return true;
+	}
+	std::filesystem::create_directories(directoryPath, error);
+	return WriteSyntheticObj(directoryPath, filename, settings).succeeded;
+}
+
+ObjLoadBenchmarkResult BenchmarkObjLoad(const std::string& directoryPath, const std::string& filename, uint32_t iterations, uint32_t threadCount, AllocationCounter allocationCounter) {
+	ObjLoadBenchmarkResult result;
+	std::error_code error;
+	result.fileBytes = std::filesystem::file_size(directoryPath + "/" + filename, error);
+	if (error) {
+		return result;
+	}
+
+	result.peakResidentReset = ResetPeakResidentBytes();
+	result.baseResidentBytes = GetCurrentResidentBytes();
+	for (uint32_t iteration = 0; iteration < (std::max)(iterations, 1u); ++iteration) {
+		const uint64_t allocationsBefore = allocationCounter ? allocationCounter() : 0;
+		const auto start = std::chrono::steady_clock::now();
+		ModelData modelData = LoadObjFile(directoryPath, filename, threadCount);
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (allocationCounter) {
+			result.allocationCount = static_cast<int64_t>(allocationCounter() - allocationsBefore);
+		}
+		if (iteration == 0 || milliseconds < result.milliseconds) {
+			result.milliseconds = milliseconds;
+		}
+		result.vertexCount = modelData.vertices.size();
+		result.triangleCount = modelData.indices.size() / 3;
+		result.materialCount = modelData.materials.size();
+	}
+	result.megabytesPerSecond = static_cast<double>(result.fileBytes) / (1024.0 * 1024.0) / (result.milliseconds / 1000.0);
+	result.peakResidentBytes = GetPeakResidentBytes();
+	return result;
+}
+
+std::string FormatObjLoadBenchmark(const std::string& name, const ObjLoadBenchmarkResult& result) {
+	//<format>がない環境(g++12など)でもビルドできるようにsnprintfで書く
+	//ピークを戻せなかったときは、それまでのプロセス全体のピークなので「process」と付ける
+	char line[512];
+	std::snprintf(line, sizeof(line), "%s: %.1fMB %.3fms %.1fMB/s vertices %zu triangles %zu materials %zu peakRSS %.1fMB (base %.1fMB%s) allocations %lld\n",
+		name.c_str(), static_cast<double>(result.fileBytes) / (1024.0 * 1024.0), result.milliseconds, result.megabytesPerSecond,
+		result.vertexCount, result.triangleCount, result.materialCount, static_cast<double>(result.peakResidentBytes) / (1024.0 * 1024.0),
+		static_cast<double>(result.baseResidentBytes) / (1024.0 * 1024.0), result.peakResidentReset ? "" : ", process", static_cast<long long>(result.allocationCount));
+	return line;
+}
+
+std::vector<std::string> RunObjLoadBenchmarks(const std::string& directoryPath, std::span<const uint64_t> sizes, const SyntheticObjSettings& settings, uint32_t iterations, AllocationCounter allocationCounter) {
+	//ピークのメモリ使用量を戻せない環境もあるので、小さいものから測る
+	std::vector<uint64_t> sortedSizes(sizes.begin(), sizes.end());
+	std::sort(sortedSizes.begin(), sortedSizes.end());
+
+	std::vector<std::string> lines;
+	for (uint64_t size : sortedSizes) {
+		SyntheticObjSettings sizeSettings = settings;
+		sizeSettings.targetBytes = size;
+		std::string filename;
+		if (!PrepareSyntheticObj(directoryPath, sizeSettings, filename)) {
+			lines.push_back(filename + ": failed to write\n");
+			continue;
+		}
+		lines.push_back(FormatObjLoadBenchmark(filename, BenchmarkObjLoad(directoryPath, filename, iterations, 0, allocationCounter)));
+	}
+	return lines;
+}
\ No newline at end of file
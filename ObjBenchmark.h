@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// 合成objファイルの中身の混ぜ方
+struct SyntheticObjSettings {
+	uint64_t targetBytes = 1ull << 20;  //objファイルのおおよそのサイズ(パッチ単位で超えたところで止める)
+	uint64_t seed = 1;                  //同じ設定・同じseedなら、同じ内容のファイルになる
+	float sharedVertexRatio = 0.75f;    //頂点を共有するグリッドのパッチの割合。残りは三角形ごとに頂点を持つバラバラのパッチ
+	uint32_t materialCount = 4;         //mtlに書くマテリアルの数。0ならmtlもusemtlも書かない
+	uint32_t facesPerMaterialRun = 512; //usemtlでマテリアルを切り替える間隔(面の数)
+	uint32_t facesPerGroup = 4096;      //o・gを書く間隔(面の数)。0なら書かない
+	float commentRatio = 0.02f;         //行の前に「#」のコメント行を入れる割合
+};
+
+// 書き出した合成objの内容
+struct SyntheticObjInfo {
+	bool succeeded = false;
+	uint64_t bytes = 0;  //objファイルのサイズ
+	uint64_t positionCount = 0;
+	uint64_t faceCount = 0;
+};
+
+// directoryPath/filenameに合成objを、同じ名前で拡張子を.mtlにしたファイルにmtlを書き出す
+// 少しずつ書き出すので、2GBのファイルでも使うメモリは数MBで済む
+// objは「filename.partial」に書いてから付け替える。書き込みに失敗したら(ディスクがいっぱいなど)、書いたファイルを消してsucceededをfalseにする
+SyntheticObjInfo WriteSyntheticObj(const std::string& directoryPath, const std::string& filename, const SyntheticObjSettings& settings);
+
+// settingsの合成objのファイル名。「synthetic_(バイト数)_(設定のハッシュ).obj」なので、設定が違えば別の名前になる
+std::string MakeSyntheticObjFilename(const SyntheticObjSettings& settings);
+
+// directoryPathにsettingsの合成obj・mtlがそろっていなければ作り、filenameにその名前を入れる。作れなければfalse
+bool PrepareSyntheticObj(const std::string& directoryPath, const SyntheticObjSettings& settings, std::string& filename);
+
+// 今までに行ったメモリ確保の回数を返す関数。ベンチマークの実行ファイルがoperator newを置き換えて数える
+using AllocationCounter = uint64_t (*)();
+
+// プロセスの今の物理メモリ使用量と、その最大値
+uint64_t GetCurrentResidentBytes();
+uint64_t GetPeakResidentBytes();
+// 最大値を今の使用量に戻す(Linuxだけ)。戻せなければfalseで、GetPeakResidentBytesはプロセス全体の最大値のまま
+bool ResetPeakResidentBytes();
+
+// LoadObjFileを1ファイルについて計測した結果
+struct ObjLoadBenchmarkResult {
+	uint64_t fileBytes = 0;
+	size_t vertexCount = 0;
+	size_t triangleCount = 0;
+	size_t materialCount = 0;
+	double milliseconds = 0.0;        //iterations回のうち一番速かった時間
+	double megabytesPerSecond = 0.0;  //fileBytesをmillisecondsで割ったもの
+	uint64_t baseResidentBytes = 0;   //読み込む前の物理メモリ使用量
+	uint64_t peakResidentBytes = 0;   //読み込んでいる間の物理メモリ使用量の最大値
+	bool peakResidentReset = false;   //計測の前に最大値を戻せたか。falseならプロセス全体の最大値
+	int64_t allocationCount = -1;     //1回の読み込みでのメモリ確保の回数(全スレッド)。AllocationCounterを渡さなければ-1
+};
+
+// キャッシュを使わずにLoadObjFileで読んで計測する
+ObjLoadBenchmarkResult BenchmarkObjLoad(const std::string& directoryPath, const std::string& filename, uint32_t iterations = 3, uint32_t threadCount = 0, AllocationCounter allocationCounter = nullptr);
+
+// 計測結果をログ用の1行にする
+std::string FormatObjLoadBenchmark(const std::string& name, const ObjLoadBenchmarkResult& result);
+
+// sizesの大きさの合成objをPrepareSyntheticObjでdirectoryPathに用意し、小さい順に計測してログ用の行を返す
+// サイズ以外の設定はsettingsを使う
+std::vector<std::string> RunObjLoadBenchmarks(const std::string& directoryPath, std::span<const uint64_t> sizes, const SyntheticObjSettings& settings = {}, uint32_t iterations = 3, AllocationCounter allocationCounter = nullptr);
\ No newline at end of file
@@ -0,0 +1,494 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+// ファイルはメモリマップして直接走査する
+// 1行ごと・1トークンごとにstringやstreamを作らないので、読み込み中のメモリ確保は出力先のvectorの拡張だけになる
+namespace {
+
+bool IsSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// 行内の空白を飛ばす
+const char* SkipSpace(const char* p, const char* end) {
+	while (p < end && IsSpace(*p)) {
+		++p;
+	}
+	return p;
+}
+
+// 空白区切りのトークンを1つ切り出す
+std::string_view NextToken(const char*& p, const char* end) {
+	p = SkipSpace(p, end);
+	const char* begin = p;
+	while (p < end && !IsSpace(*p)) {
+		++p;
+	}
+	return { begin, static_cast<size_t>(p - begin) };
+}
+
+// 浮動小数点数を1つ読む。読めなければ0を返す
+// from_charsはロケールに依存せず、istreamより大幅に速い
+float ParseFloat(const char*& p, const char* end) {
+	p = SkipSpace(p, end);
+	//from_charsは先頭の'+'を受け付けないので飛ばす
+	if (p < end && *p == '+') {
+		++p;
+	}
+	float value = 0.0f;
+	auto [next, error] = std::from_chars(p, end, value);
+	if (error != std::errc()) {
+		value = 0.0f;
+		NextToken(p, end);
+		return value;
+	}
+	p = next;
+	return value;
+}
+
+// 1から始まるインデックスを1つ読む
+// 数字がない(「v//vn」の省略)・負の数(末尾からの相対指定)・0・uint32_tに収まらない数は読めずにfalseを返す
+bool ParseIndex(const char*& p, const char* end, uint32_t& value) {
+	auto [next, error] = std::from_chars(p, end, value);
+	if (error != std::errc() || value == 0) {
+		return false;
+	}
+	p = next;
+	return true;
+}
+
+// 次の行の先頭を返す。lineEndには改行を除いた行末が入る
+const char* NextLine(const char* p, const char* end, const char*& lineEnd) {
+	const char* newLine = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+	if (newLine == nullptr) {
+		lineEnd = end;
+		return end;
+	}
+	lineEnd = newLine;
+	return newLine + 1;
+}
+
+}
+
+#pragma region MaterialData
+std::vector<MaterialData> LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename) {
+	std::vector<MaterialData> materials;//構築するMaterialData
+	MappedFile file(directoryPath + "/" + filename);//ファイルを開く
+	assert(file.IsOpen());//とりあえず開けなっかたら止める
+
+	const char* p = file.Data();
+	const char* end = p + file.Size();
+	while (p < end) {
+		const char* lineEnd;
+		const char* nextLine = NextLine(p, end, lineEnd);
+		std::string_view identifier = NextToken(p, lineEnd);
+
+		//identifierの応じた処理
+		if (identifier == "newmtl") {
+			MaterialData& material = materials.emplace_back();
+			material.name = NextToken(p, lineEnd);
+		}
+		else if (materials.empty()) {
+			//newmtlより前の行は対象のマテリアルがないので読まない
+		}
+		else if (identifier == "Kd") {
+			Vector4& color = materials.back().color;
+			color.x = ParseFloat(p, lineEnd);
+			color.y = ParseFloat(p, lineEnd);
+			color.z = ParseFloat(p, lineEnd);
+		}
+		else if (identifier == "d") {
+			materials.back().color.w = ParseFloat(p, lineEnd);
+		}
+		else if (identifier == "map_Kd") {
+			std::string_view textureFilename = NextToken(p, lineEnd);
+			//連結してファイルパスにする
+			materials.back().textureFilePath = directoryPath + "/" + std::string(textureFilename);
+		}
+		p = nextLine;
+	}
+	return materials;
+}
+#pragma endregion
+
+
+#pragma region LoadObjFile
+namespace {
+
+// 頂点を区別するための「位置/UV/法線」のインデックスの組
+struct ObjVertexKey {
+	uint32_t position;
+	uint32_t texcoord;
+	uint32_t normal;
+
+	bool operator==(const ObjVertexKey&) const = default;
+};
+
+struct ObjVertexKeyHash {
+	size_t operator()(const ObjVertexKey& key) const {
+		uint64_t hash = (uint64_t(key.position) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(key.texcoord) * 0xC2B2AE3D27D4EB4Full) ^ (uint64_t(key.normal) * 0x165667B19E3779F9ull);
+		return size_t(hash ^ (hash >> 32));
+	}
+};
+
+using ObjVertexMap = std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash>;
+
+// usemtlで切り替わったマテリアルと、それが使われ始める面
+struct ObjMaterialRun {
+	uint32_t faceStart;  //区間内での面の番号
+	std::string_view materialName;
+};
+
+// ファイルを行単位で分割した1区間の読み込み結果
+struct ObjChunk {
+	std::vector<Vector4> positions;
+	std::vector<Vector2> texcoords;
+	std::vector<Vector3> normals;
+	std::vector<uint32_t> faceIndices;  //1面につき「位置/UV/法線」x3の9個。インデックスはファイル全体での通し番号
+	std::vector<std::string_view> materialFilenames;  //区間内で出てきたmtllib
+	std::vector<ObjMaterialRun> materialRuns;          //区間内で出てきたusemtl
+
+	uint64_t skippedFaceCount = 0;                     //読めなかった・範囲外を指していたので飛ばした面の数
+
+	std::vector<ObjVertexKey> uniqueKeys;   //区間内で出てきた順の、重複のない頂点
+	std::vector<uint32_t> localIndices;     //uniqueKeysへのインデックス(周り順は反転済み)
+};
+
+// 進み具合を書き込む間隔。行ごとに書くと他のスレッドとキャッシュラインを取り合うので、ある程度まとめる
+constexpr size_t kProgressInterval = 256 * 1024;
+
+// 1区間を読む。面のインデックスはここでは解決せずにそのまま持っておく
+// 中断の要求があったら途中で戻る
+void ParseObjChunk(const char* p, const char* end, ObjChunk& chunk, ObjLoadControl* control) {
+	const char* reported = p;  //進み具合を書き込んだところ
+	size_t reportedFaceIndexCount = 0;
+	while (p < end) {
+		if (control && static_cast<size_t>(p - reported) >= kProgressInterval) {
+			control->bytesParsed += static_cast<uint64_t>(p - reported);
+			control->facesParsed += (chunk.faceIndices.size() - reportedFaceIndexCount) / 9;
+			reported = p;
+			reportedFaceIndexCount = chunk.faceIndices.size();
+			if (control->cancelRequested) {
+				return;
+			}
+		}
+		const char* lineEnd;
+		const char* nextLine = NextLine(p, end, lineEnd);
+		std::string_view identifier = NextToken(p, lineEnd);  //先頭の識別子を読む
+
+		if (identifier == "v") {
+			Vector4 position;
+			position.x = ParseFloat(p, lineEnd);
+			position.y = ParseFloat(p, lineEnd);
+			position.z = ParseFloat(p, lineEnd);
+			position.w = 1.0f;
+			position.x *= -1;
+			chunk.positions.push_back(position);
+		}
+		else if (identifier == "vt") {
+			Vector2 texcoord;
+			texcoord.x = ParseFloat(p, lineEnd);
+			texcoord.y = ParseFloat(p, lineEnd);
+			texcoord.y = 1 - texcoord.y;
+			chunk.texcoords.push_back(texcoord);
+		}
+		else if (identifier == "vn") {
+			Vector3 normal;
+			normal.x = ParseFloat(p, lineEnd);
+			normal.y = ParseFloat(p, lineEnd);
+			normal.z = ParseFloat(p, lineEnd);
+			normal.x *= -1;
+			chunk.normals.push_back(normal);
+		}
+		else if (identifier == "f") {
+			//面は三角形限定。その他は未対応
+			//頂点の要素へのIndexは「位置/UV/法線」で格納されているので、分解してIndexを取得する
+			//1つでも読めなければ面ごと飛ばす(読めたところまでを入れると、あとの面の並びがずれる)
+			uint32_t faceIndices[9];
+			bool valid = true;
+			for (int32_t faceVertex = 0; valid && faceVertex < 3; ++faceVertex) {
+				p = SkipSpace(p, lineEnd);
+				for (int32_t element = 0; valid && element < 3; ++element) {
+					if (element > 0) {
+						if (p >= lineEnd || *p != '/') {
+							valid = false;
+							break;
+						}
+						++p;//区切りの'/'を飛ばす
+					}
+					valid = ParseIndex(p, lineEnd, faceIndices[faceVertex * 3 + element]);
+				}
+			}
+			if (valid) {
+				chunk.faceIndices.insert(chunk.faceIndices.end(), std::begin(faceIndices), std::end(faceIndices));
+			} else {
+				++chunk.skippedFaceCount;
+			}
+		}
+		else if (identifier == "usemtl") {
+			//以降の面で使うマテリアルを切り替える。o・gはマテリアルごとにまとめて描くので区別しない
+			chunk.materialRuns.push_back({ static_cast<uint32_t>(chunk.faceIndices.size() / 9), NextToken(p, lineEnd) });
+		}
+		else if (identifier == "mtllib") {
+			//materialTemlateLibraryファイルの名前を取得する
+			chunk.materialFilenames.push_back(NextToken(p, lineEnd));
+		}
+		p = nextLine;
+	}
+	if (control) {
+		control->bytesParsed += static_cast<uint64_t>(end - reported);
+		control->facesParsed += (chunk.faceIndices.size() - reportedFaceIndexCount) / 9;
+	}
+}
+
+// 中断の要求があったか
+bool IsCancelled(const ObjLoadControl* control) {
+	return control && control->cancelRequested;
+}
+
+// 各区間の配列をファイル順に1つの配列へまとめる
+template<typename T, typename Member>
+std::vector<T> ConcatChunks(std::vector<ObjChunk>& chunks, Member member, uint32_t threadCount) {
+	std::vector<size_t> offsets(chunks.size() + 1, 0);
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		offsets[i + 1] = offsets[i] + (chunks[i].*member).size();
+	}
+	std::vector<T> result(offsets.back());
+	ParallelFor(static_cast<uint32_t>(chunks.size()), [&](uint32_t chunkIndex) {
+		const std::vector<T>& source = chunks[chunkIndex].*member;
+		std::copy(source.begin(), source.end(), result.begin() + offsets[chunkIndex]);
+	}, threadCount);
+	return result;
+}
+
+}
+
+ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename, uint32_t threadCount, std::vector<std::string>* sourceFiles, ObjLoadControl* control) {
+	ModelData modelData;  //構築するModelData
+
+	MappedFile file(directoryPath + "/" + filename);  //fileを開く
+	assert(file.IsOpen());                            //開けなかったら止める
+	if (sourceFiles) {
+		sourceFiles->push_back(directoryPath + "/" + filename);
+	}
+
+	if (control) {
+		control->bytesTotal = file.Size();
+	}
+
+	if (threadCount == 0) {
+		threadCount = GetHardwareThreadCount();
+	}
+	//小さいファイルはスレッドを立てるほうが遅いので、1区間あたり最低でもこのサイズにする
+	constexpr size_t kMinChunkSize = 256 * 1024;
+	const char* begin = file.Data();
+	const char* end = begin + file.Size();
+	size_t chunkCount = (std::min)(static_cast<size_t>(threadCount), file.Size() / kMinChunkSize);
+	chunkCount = (std::max)(chunkCount, size_t(1));
+
+	//ほぼ均等な大きさで、行の途中で切れないように区切る
+	std::vector<const char*> boundaries(chunkCount + 1);
+	boundaries[0] = begin;
+	boundaries[chunkCount] = end;
+	for (size_t i = 1; i < chunkCount; ++i) {
+		const char* p = (std::max)(begin + file.Size() * i / chunkCount, boundaries[i - 1]);
+		const char* newLine = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+		boundaries[i] = newLine ? newLine + 1 : end;
+	}
+
+	//1.各区間を並列に読む。読むのが一番時間がかかるので、中断はここで区間の途中でも受け付ける
+	std::vector<ObjChunk> chunks(chunkCount);
+	ParallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t chunkIndex) {
+		ParseObjChunk(boundaries[chunkIndex], boundaries[chunkIndex + 1], chunks[chunkIndex], control);
+	}, threadCount);
+	if (IsCancelled(control)) {
+		return {};
+	}
+
+	//2.位置・UV・法線をファイル順につなげる。面のインデックスはこの通し番号を指している
+	std::vector<Vector4> positions = ConcatChunks<Vector4>(chunks, &ObjChunk::positions, threadCount);
+	std::vector<Vector2> texcoords = ConcatChunks<Vector2>(chunks, &ObjChunk::texcoords, threadCount);
+	std::vector<Vector3> normals = ConcatChunks<Vector3>(chunks, &ObjChunk::normals, threadCount);
+
+	//3.区間ごとに並列で、同じ「位置/UV/法線」の頂点をまとめる
+	//ファイルにない位置・UV・法線を指している面はここで飛ばし、usemtlの切り替え位置を残った面の番号に直す
+	ParallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t chunkIndex) {
+		ObjChunk& chunk = chunks[chunkIndex];
+		ObjVertexMap vertexMap;
+		vertexMap.reserve(chunk.faceIndices.size() / 9);
+		chunk.localIndices.reserve(chunk.faceIndices.size() / 3);
+		size_t materialRun = 0;
+		for (size_t face = 0; face < chunk.faceIndices.size(); face += 9) {
+			const uint32_t keptFaceCount = static_cast<uint32_t>(chunk.localIndices.size() / 3);
+			for (; materialRun < chunk.materialRuns.size() && chunk.materialRuns[materialRun].faceStart <= face / 9; ++materialRun) {
+				chunk.materialRuns[materialRun].faceStart = keptFaceCount;
+			}
+			bool inRange = true;
+			for (size_t element = 0; element < 9; element += 3) {
+				inRange = inRange &&
+					chunk.faceIndices[face + element + 0] <= positions.size() &&
+					chunk.faceIndices[face + element + 1] <= texcoords.size() &&
+					chunk.faceIndices[face + element + 2] <= normals.size();
+			}
+			if (!inRange) {
+				++chunk.skippedFaceCount;
+				continue;
+			}
+			//頂点を逆順で登録することで、周り順を逆にする
+			for (int32_t faceVertex = 2; faceVertex >= 0; --faceVertex) {
+				const uint32_t* elementIndices = &chunk.faceIndices[face + faceVertex * 3];
+				ObjVertexKey key = { elementIndices[0], elementIndices[1], elementIndices[2] };
+				auto [it, inserted] = vertexMap.try_emplace(key, static_cast<uint32_t>(chunk.uniqueKeys.size()));
+				if (inserted) {
+					chunk.uniqueKeys.push_back(key);
+				}
+				chunk.localIndices.push_back(it->second);
+			}
+		}
+		for (; materialRun < chunk.materialRuns.size(); ++materialRun) {
+			chunk.materialRuns[materialRun].faceStart = static_cast<uint32_t>(chunk.localIndices.size() / 3);
+		}
+		chunk.faceIndices = {};
+	}, threadCount);
+	if (control) {
+		for (const ObjChunk& chunk : chunks) {
+			control->facesSkipped += chunk.skippedFaceCount;
+		}
+	}
+	if (IsCancelled(control)) {
+		return {};
+	}
+
+	//4.区間をまたいで重複をまとめ、頂点を作る。区間内の重複は除いてあるので、ここで見る数は面の数よりずっと少ない
+	size_t uniqueKeyCount = 0;
+	for (const ObjChunk& chunk : chunks) {
+		uniqueKeyCount += chunk.uniqueKeys.size();
+	}
+	ObjVertexMap vertexMap;
+	vertexMap.reserve(uniqueKeyCount);
+	modelData.vertices.reserve(uniqueKeyCount);
+	std::vector<std::vector<uint32_t>> remaps(chunkCount);  //区間内のインデックス→全体のインデックス
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+		const ObjChunk& chunk = chunks[chunkIndex];
+		remaps[chunkIndex].resize(chunk.uniqueKeys.size());
+		for (size_t i = 0; i < chunk.uniqueKeys.size(); ++i) {
+			const ObjVertexKey& key = chunk.uniqueKeys[i];
+			auto [it, inserted] = vertexMap.try_emplace(key, static_cast<uint32_t>(modelData.vertices.size()));
+			if (inserted) {
+				//要素へのIndexから、実際の要素の値を取得して、頂点を構築する(範囲は3.で確かめてある)
+				modelData.vertices.push_back({ positions[key.position - 1], texcoords[key.texcoord - 1], normals[key.normal - 1] });
+			}
+			remaps[chunkIndex][i] = it->second;
+		}
+	}
+
+	//5.インデックスを全体の番号に置き換える。区間ごとに書き込み先をずらしておけばファイル順のまま並列に書ける
+	std::vector<size_t> indexOffsets(chunkCount + 1, 0);
+	for (size_t i = 0; i < chunkCount; ++i) {
+		indexOffsets[i + 1] = indexOffsets[i] + chunks[i].localIndices.size();
+	}
+	modelData.indices.resize(indexOffsets.back());
+	ParallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t chunkIndex) {
+		const std::vector<uint32_t>& localIndices = chunks[chunkIndex].localIndices;
+		const std::vector<uint32_t>& remap = remaps[chunkIndex];
+		uint32_t* out = modelData.indices.data() + indexOffsets[chunkIndex];
+		for (uint32_t localIndex : localIndices) {
+			*out++ = remap[localIndex];
+		}
+	}, threadCount);
+	if (IsCancelled(control)) {
+		return {};
+	}
+
+	//6.mtllibをすべて読み、マテリアルを名前で引けるようにする
+	std::unordered_map<std::string_view, uint32_t> materialIndices;
+	std::vector<std::string_view> loadedMaterialFilenames;
+	for (const ObjChunk& chunk : chunks) {
+		for (std::string_view materialFilename : chunk.materialFilenames) {
+			if (std::find(loadedMaterialFilenames.begin(), loadedMaterialFilenames.end(), materialFilename) != loadedMaterialFilenames.end()) {
+				continue;
+			}
+			loadedMaterialFilenames.push_back(materialFilename);
+			//基本的にobjファイルと同一階層にmtlは存在させるので、ディレクトリ名とファイル名を渡す
+			for (MaterialData& material : LoadMaterialTemplateFile(directoryPath, std::string(materialFilename))) {
+				modelData.materials.push_back(std::move(material));
+			}
+			if (sourceFiles) {
+				sourceFiles->push_back(directoryPath + "/" + std::string(materialFilename));
+			}
+		}
+	}
+	for (uint32_t i = 0; i < modelData.materials.size(); ++i) {
+		materialIndices.try_emplace(modelData.materials[i].name, i);
+	}
+
+	//7.各面のマテリアルを決める。区間の先頭の面は、前の区間で最後にusemtlしたマテリアルを引き継ぐ
+	//usemtlがない・mtlにない名前の面は、最後に追加する既定のマテリアルを使う
+	const uint32_t defaultMaterialIndex = static_cast<uint32_t>(modelData.materials.size());
+	auto findMaterial = [&](std::string_view name) {
+		auto it = materialIndices.find(name);
+		return it != materialIndices.end() ? it->second : defaultMaterialIndex;
+	};
+	std::vector<uint32_t> chunkStartMaterials(chunkCount);
+	uint32_t currentMaterial = defaultMaterialIndex;
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+		chunkStartMaterials[chunkIndex] = currentMaterial;
+		if (!chunks[chunkIndex].materialRuns.empty()) {
+			currentMaterial = findMaterial(chunks[chunkIndex].materialRuns.back().materialName);
+		}
+	}
+	std::vector<uint32_t> faceMaterials(modelData.indices.size() / 3);
+	ParallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t chunkIndex) {
+		const ObjChunk& chunk = chunks[chunkIndex];
+		uint32_t* out = faceMaterials.data() + indexOffsets[chunkIndex] / 3;
+		const uint32_t faceCount = static_cast<uint32_t>(chunk.localIndices.size() / 3);
+		uint32_t material = chunkStartMaterials[chunkIndex];
+		uint32_t face = 0;
+		for (const ObjMaterialRun& run : chunk.materialRuns) {
+			for (; face < run.faceStart; ++face) {
+				out[face] = material;
+			}
+			material = findMaterial(run.materialName);
+		}
+		for (; face < faceCount; ++face) {
+			out[face] = material;
+		}
+	}, threadCount);
+
+	//8.マテリアルごとに1回で描けるように、面をマテリアル順に並べ替える(同じマテリアル内ではファイル順のまま)
+	std::vector<uint32_t> materialFaceCounts(defaultMaterialIndex + 1, 0);
+	for (uint32_t material : faceMaterials) {
+		++materialFaceCounts[material];
+	}
+	if (materialFaceCounts[defaultMaterialIndex] > 0) {
+		modelData.materials.push_back(MaterialData{});
+	}
+	std::vector<uint32_t> materialFaceStarts(materialFaceCounts.size(), 0);
+	for (size_t material = 1; material < materialFaceCounts.size(); ++material) {
+		materialFaceStarts[material] = materialFaceStarts[material - 1] + materialFaceCounts[material - 1];
+	}
+	for (uint32_t material = 0; material < materialFaceCounts.size(); ++material) {
+		if (materialFaceCounts[material] > 0) {
+			modelData.submeshes.push_back({ materialFaceStarts[material] * 3, materialFaceCounts[material] * 3, material });
+		}
+	}
+	if (modelData.submeshes.size() > 1) {
+		std::vector<uint32_t> sortedIndices(modelData.indices.size());
+		for (size_t face = 0; face < faceMaterials.size(); ++face) {
+			uint32_t* out = &sortedIndices[size_t(materialFaceStarts[faceMaterials[face]]++) * 3];
+			out[0] = modelData.indices[face * 3 + 0];
+			out[1] = modelData.indices[face * 3 + 1];
+			out[2] = modelData.indices[face * 3 + 2];
+		}
+		modelData.indices = std::move(sortedIndices);
+	}
+	return modelData;
+}
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include "GraphicsData.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// mtlファイルを読み込んで、newmtlごとのMaterialDataを作る(Kd・d・map_Kdを読む)
+std::vector<MaterialData> LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename);
+
+// 読み込みの進み具合の取得と中断の要求を、別のスレッドから行うためのもの
+struct ObjLoadControl {
+	std::atomic<uint64_t> bytesTotal{ 0 };        //objファイルのサイズ
+	std::atomic<uint64_t> bytesParsed{ 0 };       //読み終わったバイト数
+	std::atomic<uint64_t> facesParsed{ 0 };       //読み終わった面の数
+	std::atomic<uint64_t> facesSkipped{ 0 };      //読めなかった・範囲外を指していたので飛ばした面の数
+	std::atomic<bool> cancelRequested{ false };  //trueにすると、なるべく早く空のModelDataを返して終わる
+};
+
+// objファイルを読み込んでModelDataを作る
+// 右手系→左手系の変換としてxを反転し、vを反転し、三角形の周り順を逆にする
+// 面は三角形のみ、頂点は「位置/UV/法線」の形式のみ対応
+// それ以外の面(「v//vn」・負のインデックスなど)と、ファイルにない位置・UV・法線を指す面は飛ばし、controlのfacesSkippedに数える
+// 同じ「位置/UV/法線」の組み合わせの頂点は1つにまとめ、三角形はインデックスで返す
+// 三角形はusemtlのマテリアルごとにまとめて並べ替え、マテリアルごとの範囲をsubmeshesに入れる
+// 大きいファイルは行単位で区切って複数スレッドで読む。threadCountが0ならハードウェアスレッド数を使う
+// 結果はスレッド数によらず1スレッドで読んだときと同じになる
+// sourceFilesを渡すと、読み込んだobj・mtlファイルのパスを追加する(キャッシュの更新判定用)
+// controlを渡すと、読みながら進み具合を書き込み、中断の要求があれば空のModelDataを返す
+ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename, uint32_t threadCount = 0, std::vector<std::string>* sourceFiles = nullptr, ObjLoadControl* control = nullptr);
\ No newline at end of file
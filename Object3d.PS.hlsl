@@ -4,7 +4,7 @@ struct Material
 {
     float32_t4 color;
     int32_t enableLighting;
-    float32_t4x4 uvTransform;
+    float32_t2x4 uvTransform;
 };
 
 struct DirectionalLight
@@ -26,8 +26,8 @@ struct PixelShaderOutput
 
 PixelShaderOutput main(VertexShaderOutput input)
 {
-    float4 transformedUV = mul(float32_t4(input.texcoord, 0.0f, 1.0f), gMaterial.uvTransform);
-    float32_t4 textureColor = gTexture.Sample(gSampler, transformedUV.xy);
+    float32_t2 transformedUV = mul(gMaterial.uvTransform, float32_t4(input.texcoord, 0.0f, 1.0f));
+    float32_t4 textureColor = gTexture.Sample(gSampler, transformedUV);
     
     PixelShaderOutput output;
     if (gMaterial.enableLighting != 0)
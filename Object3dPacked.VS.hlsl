@@ -0,0 +1,32 @@
+#include "Object3d.hlsli"
+
+struct TransformationMatrix
+{
+    float32_t4x4 WVP;
+    float32_t3x4 World;
+};
+ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
+
+struct VertexShaderInput
+{
+    float32_t3 position : POSITION0;
+    float32_t2 normal : NORMAL0;
+    float32_t2 texcoord : TEXCOORD0;
+};
+
+float32_t3 DecodeOctahedralNormal(float32_t2 encoded)
+{
+    float32_t3 normal = float32_t3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float32_t t = saturate(-normal.z);
+    normal.xy += (1.0f - 2.0f * step(0.0f, normal.xy)) * t;
+    return normalize(normal);
+}
+
+VertexShaderOutput main(VertexShaderInput input)
+{
+    VertexShaderOutput output;
+    output.position = mul(float32_t4(input.position, 1.0f), gTransformationMatrix.WVP);
+    output.texcoord = input.texcoord;
+    output.normal = normalize(mul((float32_t3x3) gTransformationMatrix.World, DecodeOctahedralNormal(input.normal)));
+    return output;
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 1回のParallelForの状態。呼び出し元が戻ったあとにワーカーが触ることがあるので、shared_ptrで持つ
+struct ParallelJob {
+	const std::function<void(uint32_t)>* func;
+	uint32_t taskCount;
+	std::atomic<uint32_t> nextTask = 0;       //次に取るタスク
+	std::atomic<uint32_t> completedTasks = 0;  //終わったタスクの数
+
+	// タスクがなくなるまで取って実行する
+	void Run() {
+		for (uint32_t taskIndex = nextTask++; taskIndex < taskCount; taskIndex = nextTask++) {
+			(*func)(taskIndex);
+			if (++completedTasks == taskCount) {
+				completedTasks.notify_all();
+			}
+		}
+	}
+};
+
+/// <summary>
+/// ParallelForで使うスレッドを最初に使われたときに作って、プロセスの終わりまで使い回す
+/// ジョブは「手伝ってほしいスレッド数」ぶんの参加券としてキューに入れ、空いているワーカーが取って手伝う
+/// </summary>
+class ThreadPool {
+public:
+	ThreadPool() {
+		const uint32_t workerCount = GetHardwareThreadCount() - 1;
+		workers_.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i) {
+			workers_.emplace_back([this]() { WorkerMain(); });
+		}
+	}
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			quit_ = true;
+		}
+		condition_.notify_all();
+		for (std::thread& worker : workers_) {
+			worker.join();
+		}
+	}
+
+	uint32_t WorkerCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+	// helperCount個のワーカーにjobを手伝ってもらう
+	void Submit(const std::shared_ptr<ParallelJob>& job, uint32_t helperCount) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (uint32_t i = 0; i < helperCount; ++i) {
+				tickets_.push_back(job);
+			}
+		}
+		if (helperCount == 1) {
+			condition_.notify_one();
+		}
+		else {
+			condition_.notify_all();
+		}
+	}
+
+private:
+	void WorkerMain() {
+		for (;;) {
+			std::shared_ptr<ParallelJob> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [this]() { return quit_ || !tickets_.empty(); });
+				if (quit_) {
+					return;
+				}
+				job = std::move(tickets_.front());
+				tickets_.pop_front();
+			}
+			//すでにほかのスレッドが全部取っていたら、何もせずに次へ行く
+			job->Run();
+		}
+	}
+
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::shared_ptr<ParallelJob>> tickets_;  //mutex_で守る
+	bool quit_ = false;                                 //mutex_で守る
+};
+
+ThreadPool& GetThreadPool() {
+	static ThreadPool threadPool;
+	return threadPool;
+}
+
+}
+
+uint32_t GetHardwareThreadCount() {
+	return (std::max)(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& func, uint32_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = GetHardwareThreadCount();
+	}
+	threadCount = (std::min)(threadCount, taskCount);
+	if (threadCount <= 1) {
+		for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex) {
+			func(taskIndex);
+		}
+		return;
+	}
+
+	//呼び出したスレッドも参加する。ワーカーがほかのジョブで埋まっていても、呼び出したスレッドだけで最後まで進む
+	ThreadPool& threadPool = GetThreadPool();
+	auto job = std::make_shared<ParallelJob>();
+	job->func = &func;
+	job->taskCount = taskCount;
+	threadPool.Submit(job, (std::min)(threadCount - 1, threadPool.WorkerCount()));
+	job->Run();
+	//ワーカーが実行中のタスクが終わるのを待つ
+	for (uint32_t completed = job->completedTasks; completed != taskCount; completed = job->completedTasks) {
+		job->completedTasks.wait(completed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+// 使えるハードウェアスレッド数(最低1)
+uint32_t GetHardwareThreadCount();
+
+// func(taskIndex)をtaskIndex = 0 ~ taskCount-1について1回ずつ、複数スレッドで呼ぶ
+// スレッドは毎回作らず、最初に呼ばれたときに作ったスレッドプールを使い回す
+// 呼び出したスレッドも処理に参加し、すべて終わってから戻る。別々のスレッドから同時に呼んでも、funcの中から呼んでもよい
+// threadCountが0ならハードウェアスレッド数を使う。1ならその場で順番に実行する
+void ParallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& func, uint32_t threadCount = 0);
\ No newline at end of file
@@ -0,0 +1,439 @@
+#include "ProceduralMesh.h"
+#include "MyMath.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <numbers>
+#include <utility>
+
+namespace {
+
+// 1つのタスクで最低これだけの頂点を書く。小さい形はスレッドを起こさずにその場で作る
+constexpr uint32_t kMinVerticesPerTask = 4096;
+
+// start + step * i (i = 0 ~ count-1)の角度のsin/cos
+struct AngleTable {
+	std::vector<float> sinValues;
+	std::vector<float> cosValues;
+
+	AngleTable(uint32_t count, float start, float step)
+		: sinValues(count), cosValues(count) {
+		std::vector<float> angles(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			angles[i] = start + step * float(i);
+		}
+		SinCos(angles, sinValues, cosValues);
+	}
+
+	// 1周(0~2π)を等分した表。最後を最初と同じ値にして、継ぎ目の頂点の位置がぴったり重なるようにする
+	static AngleTable FullCircle(uint32_t divisions) {
+		AngleTable table(divisions + 1, 0.0f, 2.0f * std::numbers::pi_v<float> / float(divisions));
+		table.sinValues[divisions] = table.sinValues[0];
+		table.cosValues[divisions] = table.cosValues[0];
+		return table;
+	}
+};
+
+// i / divisions (i = 0 ~ divisions)。UVや格子の座標に使う
+std::vector<float> MakeFractionTable(uint32_t divisions) {
+	std::vector<float> fractions(divisions + 1);
+	for (uint32_t i = 0; i <= divisions; ++i) {
+		fractions[i] = float(i) / float(divisions);
+	}
+	return fractions;
+}
+
+// rows x columnsの四角形の格子のインデックス数。skipFirst・skipLastは極でつぶれる三角形を除くか
+constexpr uint32_t GetGridIndexCount(uint32_t rows, uint32_t columns, bool skipFirst = false, bool skipLast = false) {
+	return rows * columns * 6 - columns * 3 * ((skipFirst ? 1 : 0) + (skipLast ? 1 : 0));
+}
+
+// (rows+1) x (columns+1)の格子点の頂点をvertexFunc(row, column, vertex)で作り、四角形を三角形にする
+// 四角形はa=(row, column), b=(row+1, column), c=(row, column+1), d=(row+1, column+1)として、a,b,cとc,b,dの2枚
+// 行方向 x 列方向が表になるように呼ぶ側で向きを決める。skipFirstなら最初の行のa,b,cを、skipLastなら最後の行のc,b,dを除く
+// 行の帯ごとに並列に書く。インデックスにはbaseVertexを足す
+template<typename VertexFunc>
+void WriteGrid(uint32_t rows, uint32_t columns, const VertexFunc& vertexFunc, VertexData* vertices, uint32_t* indices, uint32_t baseVertex,
+	bool skipFirst = false, bool skipLast = false) {
+	const uint32_t columnCount = columns + 1;
+	const uint32_t rowsPerTask = (std::max)(1u, kMinVerticesPerTask / columnCount);
+	const uint32_t taskCount = (rows + rowsPerTask - 1) / rowsPerTask;
+	ParallelFor(taskCount, [&](uint32_t taskIndex) {
+		const uint32_t rowBegin = taskIndex * rowsPerTask;
+		const uint32_t rowEnd = (std::min)(rows, rowBegin + rowsPerTask);
+		//最後の帯は、一番上の頂点の行も書く
+		const uint32_t vertexRowEnd = rowEnd == rows ? rows + 1 : rowEnd;
+		for (uint32_t row = rowBegin; row < vertexRowEnd; ++row) {
+			VertexData* rowVertices = vertices + row * columnCount;
+			for (uint32_t column = 0; column < columnCount; ++column) {
+				vertexFunc(row, column, rowVertices[column]);
+			}
+		}
+		//行ごとの書き込み先は、それより前の行の三角形の数から決まる
+		uint32_t* out = indices + rowBegin * columns * 6 - (skipFirst && rowBegin > 0 ? columns * 3 : 0);
+		for (uint32_t row = rowBegin; row < rowEnd; ++row) {
+			for (uint32_t column = 0; column < columns; ++column) {
+				const uint32_t a = baseVertex + row * columnCount + column;
+				const uint32_t b = a + columnCount;
+				const uint32_t c = a + 1;
+				const uint32_t d = b + 1;
+				if (!(skipFirst && row == 0)) {
+					*out++ = a;
+					*out++ = b;
+					*out++ = c;
+				}
+				if (!(skipLast && row == rows - 1)) {
+					*out++ = c;
+					*out++ = b;
+					*out++ = d;
+				}
+			}
+		}
+	});
+}
+
+#pragma region 各形の頂点数・インデックス数
+uint32_t GetIcosphereFaceVertexCount(uint32_t segments) {
+	return (segments + 1) * (segments + 2) / 2;
+}
+
+uint32_t GetCylinderSideVertexCount(uint32_t segments, uint32_t rings) {
+	return (segments + 1) * (rings + 1);
+}
+#pragma endregion
+
+#pragma region 形ごとの生成
+void GenerateIcosphere(uint32_t segments, float w, VertexData* vertices, uint32_t* indices) {
+	//正二十面体。頂点は(±1, ±φ, 0)・(0, ±1, ±φ)・(±φ, 0, ±1)
+	constexpr float phi = std::numbers::phi_v<float>;
+	const Vector3 corners[12] = {
+		{-1.0f, phi, 0.0f}, {1.0f, phi, 0.0f}, {-1.0f, -phi, 0.0f}, {1.0f, -phi, 0.0f},
+		{0.0f, -1.0f, phi}, {0.0f, 1.0f, phi}, {0.0f, -1.0f, -phi}, {0.0f, 1.0f, -phi},
+		{phi, 0.0f, -1.0f}, {phi, 0.0f, 1.0f}, {-phi, 0.0f, -1.0f}, {-phi, 0.0f, 1.0f},
+	};
+	const uint32_t faces[20][3] = {
+		{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+		{1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+		{3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+		{4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1},
+	};
+	const uint32_t faceVertexCount = GetIcosphereFaceVertexCount(segments);
+	const uint32_t faceIndexCount = segments * segments * 3;
+
+	//UVは緯度経度から求めるので、継ぎ目をまたぐ面があるため頂点は面ごとに持つ
+	//辺の上の点は、両側の面で同じ値になるように頂点番号の小さい順に足す
+	ParallelFor(20, [&](uint32_t faceIndex) {
+		uint32_t face[3] = { faces[faceIndex][0], faces[faceIndex][1], faces[faceIndex][2] };
+		const Vector3 faceNormal = Cross(Subtract(corners[face[1]], corners[face[0]]), Subtract(corners[face[2]], corners[face[0]]));
+		const Vector3 faceCenter = Add(Add(corners[face[0]], corners[face[1]]), corners[face[2]]);
+		if (Dot(faceNormal, faceCenter) < 0.0f) {
+			std::swap(face[1], face[2]);
+		}
+		uint32_t order[3] = { 0, 1, 2 };
+		std::sort(order, order + 3, [&](uint32_t lhs, uint32_t rhs) { return face[lhs] < face[rhs]; });
+		//面の中心の経度。継ぎ目をまたぐ頂点のuをこれに近い側へずらす
+		const float centerU = 0.5f + std::atan2(faceCenter.z, faceCenter.x) * (0.5f / std::numbers::pi_v<float>);
+
+		VertexData* faceVertices = vertices + faceIndex * faceVertexCount;
+		for (uint32_t row = 0; row <= segments; ++row) {
+			for (uint32_t s = 0; s <= row; ++s) {
+				//(row, s)は face[0]*(segments-row) + face[1]*(row-s) + face[2]*s
+				const float weights[3] = { float(segments - row), float(row - s), float(s) };
+				Vector3 point = { 0.0f, 0.0f, 0.0f };
+				for (uint32_t k : order) {
+					point = Add(point, Vector3{ corners[face[k]].x * weights[k], corners[face[k]].y * weights[k], corners[face[k]].z * weights[k] });
+				}
+				const Vector3 normal = Normalize(point);
+				float u = centerU;
+				if (std::abs(normal.x) + std::abs(normal.z) > 1e-6f) {
+					u = 0.5f + std::atan2(normal.z, normal.x) * (0.5f / std::numbers::pi_v<float>);
+					if (u - centerU > 0.5f) {
+						u -= 1.0f;
+					}
+					else if (u - centerU < -0.5f) {
+						u += 1.0f;
+					}
+				}
+				const float v = 0.5f - std::asin(std::clamp(normal.y, -1.0f, 1.0f)) / std::numbers::pi_v<float>;
+				VertexData& vertex = faceVertices[row * (row + 1) / 2 + s];
+				vertex.position = { normal.x, normal.y, normal.z, w };
+				vertex.normal = normal;
+				vertex.texcoord = { u, v };
+			}
+		}
+
+		uint32_t* out = indices + faceIndex * faceIndexCount;
+		const uint32_t base = faceIndex * faceVertexCount;
+		for (uint32_t row = 0; row < segments; ++row) {
+			const uint32_t rowStart = base + row * (row + 1) / 2;
+			const uint32_t nextRowStart = base + (row + 1) * (row + 2) / 2;
+			for (uint32_t s = 0; s <= row; ++s) {
+				*out++ = rowStart + s;
+				*out++ = nextRowStart + s;
+				*out++ = nextRowStart + s + 1;
+				if (s < row) {
+					*out++ = rowStart + s;
+					*out++ = nextRowStart + s + 1;
+					*out++ = rowStart + s + 1;
+				}
+			}
+		}
+	});
+}
+
+void GenerateCube(uint32_t segments, float w, VertexData* vertices, uint32_t* indices) {
+	//面の法線と、行・列の向き(行 x 列 = 法線)
+	struct CubeFace {
+		Vector3 normal;
+		Vector3 rowAxis;
+		Vector3 columnAxis;
+	};
+	const CubeFace faces[6] = {
+		{ {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f} },
+		{ {-1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f} },
+		{ {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f} },
+		{ {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f} },
+		{ {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f} },
+		{ {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f} },
+	};
+	const std::vector<float> fractions = MakeFractionTable(segments);
+	const uint32_t faceVertexCount = (segments + 1) * (segments + 1);
+	const uint32_t faceIndexCount = GetGridIndexCount(segments, segments);
+	for (uint32_t faceIndex = 0; faceIndex < 6; ++faceIndex) {
+		const CubeFace& face = faces[faceIndex];
+		WriteGrid(segments, segments, [&](uint32_t row, uint32_t column, VertexData& vertex) {
+			const float rowCoordinate = fractions[row] * 2.0f - 1.0f;
+			const float columnCoordinate = fractions[column] * 2.0f - 1.0f;
+			vertex.position = {
+				face.normal.x + face.rowAxis.x * rowCoordinate + face.columnAxis.x * columnCoordinate,
+				face.normal.y + face.rowAxis.y * rowCoordinate + face.columnAxis.y * columnCoordinate,
+				face.normal.z + face.rowAxis.z * rowCoordinate + face.columnAxis.z * columnCoordinate, w };
+			vertex.normal = face.normal;
+			vertex.texcoord = { fractions[column], 1.0f - fractions[row] };
+		}, vertices + faceIndex * faceVertexCount, indices + faceIndex * faceIndexCount, faceIndex * faceVertexCount);
+	}
+}
+
+void GenerateCylinder(uint32_t segments, uint32_t rings, float w, VertexData* vertices, uint32_t* indices) {
+	const AngleTable lons = AngleTable::FullCircle(segments);
+	const std::vector<float> uFractions = MakeFractionTable(segments);
+	const std::vector<float> vFractions = MakeFractionTable(rings);
+	//側面。行は下から上、列は経度の順
+	WriteGrid(rings, segments, [&](uint32_t row, uint32_t column, VertexData& vertex) {
+		vertex.position = { lons.cosValues[column], vFractions[row] * 2.0f - 1.0f, lons.sinValues[column], w };
+		vertex.normal = { lons.cosValues[column], 0.0f, lons.sinValues[column] };
+		vertex.texcoord = { uFractions[column], 1.0f - vFractions[row] };
+	}, vertices, indices, 0);
+
+	//ふた。中心と周の頂点で扇形に張る。上は+y、下は-yを向くように周り順を逆にする
+	const uint32_t sideVertexCount = GetCylinderSideVertexCount(segments, rings);
+	uint32_t* out = indices + GetGridIndexCount(rings, segments);
+	for (uint32_t cap = 0; cap < 2; ++cap) {
+		const float y = cap == 0 ? 1.0f : -1.0f;
+		const uint32_t center = sideVertexCount + cap * (segments + 1);
+		vertices[center] = { { 0.0f, y, 0.0f, w }, { 0.5f, 0.5f }, { 0.0f, y, 0.0f } };
+		for (uint32_t column = 0; column < segments; ++column) {
+			vertices[center + 1 + column] = { { lons.cosValues[column], y, lons.sinValues[column], w },
+				{ 0.5f + 0.5f * lons.cosValues[column], 0.5f - 0.5f * lons.sinValues[column] * y }, { 0.0f, y, 0.0f } };
+			const uint32_t current = center + 1 + column;
+			const uint32_t next = center + 1 + (column + 1) % segments;
+			*out++ = center;
+			*out++ = cap == 0 ? next : current;
+			*out++ = cap == 0 ? current : next;
+		}
+	}
+}
+
+void GenerateTorus(uint32_t segments, uint32_t rings, float minorRadius, float w, VertexData* vertices, uint32_t* indices) {
+	const AngleTable majors = AngleTable::FullCircle(segments);
+	const AngleTable minors = AngleTable::FullCircle(rings);
+	const std::vector<float> uFractions = MakeFractionTable(segments);
+	const std::vector<float> vFractions = MakeFractionTable(rings);
+	//行は管の周(外側から上へ)、列は大きい円の周
+	WriteGrid(rings, segments, [&](uint32_t row, uint32_t column, VertexData& vertex) {
+		const float radius = 1.0f + minorRadius * minors.cosValues[row];
+		vertex.position = { radius * majors.cosValues[column], minorRadius * minors.sinValues[row], radius * majors.sinValues[column], w };
+		vertex.normal = { minors.cosValues[row] * majors.cosValues[column], minors.sinValues[row], minors.cosValues[row] * majors.sinValues[column] };
+		vertex.texcoord = { uFractions[column], vFractions[row] };
+	}, vertices, indices, 0);
+}
+
+void GeneratePlane(uint32_t segments, float w, VertexData* vertices, uint32_t* indices) {
+	const std::vector<float> fractions = MakeFractionTable(segments);
+	//行は+z、列は+xの向き
+	WriteGrid(segments, segments, [&](uint32_t row, uint32_t column, VertexData& vertex) {
+		vertex.position = { fractions[column] * 2.0f - 1.0f, 0.0f, fractions[row] * 2.0f - 1.0f, w };
+		vertex.normal = { 0.0f, 1.0f, 0.0f };
+		vertex.texcoord = { fractions[column], 1.0f - fractions[row] };
+	}, vertices, indices, 0);
+}
+#pragma endregion
+
+}
+
+void GenerateUvSphere(uint32_t segments, uint32_t rings, float w, std::span<VertexData> vertices, std::span<uint32_t> indices) {
+	assert(segments >= 1 && rings >= 2);
+	assert(vertices.size() >= GetUvSphereVertexCount(segments, rings) && indices.size() >= GetUvSphereIndexCount(segments, rings));
+	//緯度・経度のsin/cosとUVは、段・列ごとに1回だけ求めておく。latIndexが0で南極、ringsで北極
+	AngleTable lats(rings + 1, -std::numbers::pi_v<float> / 2.0f, std::numbers::pi_v<float> / float(rings));
+	//極はfloatのπ/2の誤差でcosが0にならず経度ごとに少しずれるので、ちょうど極に置く
+	lats.sinValues[0] = -1.0f;
+	lats.cosValues[0] = 0.0f;
+	lats.sinValues[rings] = 1.0f;
+	lats.cosValues[rings] = 0.0f;
+	const AngleTable lons = AngleTable::FullCircle(segments);
+	const std::vector<float> uFractions = MakeFractionTable(segments);
+	const std::vector<float> vFractions = MakeFractionTable(rings);
+	//南極の段はa,cが、北極の段はb,dが極に重なるので、その三角形は除く
+	WriteGrid(rings, segments, [&](uint32_t row, uint32_t column, VertexData& vertex) {
+		vertex.position = { lats.cosValues[row] * lons.cosValues[column], lats.sinValues[row], lats.cosValues[row] * lons.sinValues[column], w };
+		vertex.normal = { vertex.position.x, vertex.position.y, vertex.position.z };
+		vertex.texcoord = { uFractions[column], 1.0f - vFractions[row] };
+	}, vertices.data(), indices.data(), 0, true, true);
+}
+
+uint32_t GetPrimitiveVertexCount(const PrimitiveDesc& desc) {
+	switch (desc.shape) {
+	case PrimitiveShape::UvSphere:
+		return GetUvSphereVertexCount(desc.segments, desc.rings);
+	case PrimitiveShape::Icosphere:
+		return GetIcosphereFaceVertexCount(desc.segments) * 20;
+	case PrimitiveShape::Cube:
+		return (desc.segments + 1) * (desc.segments + 1) * 6;
+	case PrimitiveShape::Cylinder:
+		return GetCylinderSideVertexCount(desc.segments, desc.rings) + (desc.segments + 1) * 2;
+	case PrimitiveShape::Torus:
+		return (desc.segments + 1) * (desc.rings + 1);
+	case PrimitiveShape::Plane:
+		return (desc.segments + 1) * (desc.segments + 1);
+	}
+	return 0;
+}
+
+uint32_t GetPrimitiveIndexCount(const PrimitiveDesc& desc) {
+	switch (desc.shape) {
+	case PrimitiveShape::UvSphere:
+		return GetUvSphereIndexCount(desc.segments, desc.rings);
+	case PrimitiveShape::Icosphere:
+		return desc.segments * desc.segments * 3 * 20;
+	case PrimitiveShape::Cube:
+		return GetGridIndexCount(desc.segments, desc.segments) * 6;
+	case PrimitiveShape::Cylinder:
+		return GetGridIndexCount(desc.rings, desc.segments) + desc.segments * 3 * 2;
+	case PrimitiveShape::Torus:
+		return GetGridIndexCount(desc.rings, desc.segments);
+	case PrimitiveShape::Plane:
+		return GetGridIndexCount(desc.segments, desc.segments);
+	}
+	return 0;
+}
+
+void GeneratePrimitive(const PrimitiveDesc& desc, std::span<VertexData> vertices, std::span<uint32_t> indices) {
+	assert(desc.segments >= 1);
+	assert(vertices.size() >= GetPrimitiveVertexCount(desc) && indices.size() >= GetPrimitiveIndexCount(desc));
+	switch (desc.shape) {
+	case PrimitiveShape::UvSphere:
+		GenerateUvSphere(desc.segments, desc.rings, desc.w, vertices, indices);
+		break;
+	case PrimitiveShape::Icosphere:
+		GenerateIcosphere(desc.segments, desc.w, vertices.data(), indices.data());
+		break;
+	case PrimitiveShape::Cube:
+		GenerateCube(desc.segments, desc.w, vertices.data(), indices.data());
+		break;
+	case PrimitiveShape::Cylinder:
+		assert(desc.segments >= 3 && desc.rings >= 1);
+		GenerateCylinder(desc.segments, desc.rings, desc.w, vertices.data(), indices.data());
+		break;
+	case PrimitiveShape::Torus:
+		assert(desc.segments >= 3 && desc.rings >= 3);
+		GenerateTorus(desc.segments, desc.rings, desc.minorRadius, desc.w, vertices.data(), indices.data());
+		break;
+	case PrimitiveShape::Plane:
+		GeneratePlane(desc.segments, desc.w, vertices.data(), indices.data());
+		break;
+	}
+}
+
+float GetPrimitiveTessellationError(const PrimitiveDesc& desc) {
+	//円周をdivisions等分した弦と円弧の最大の距離(半径1あたり)
+	auto chordError = [](uint32_t divisions) {
+		return 1.0f - std::cos(std::numbers::pi_v<float> / float(divisions));
+	};
+	switch (desc.shape) {
+	case PrimitiveShape::UvSphere:
+		//緯度は半周を分けるので、1周に直すと2倍の分割になる
+		return (std::max)(chordError(desc.segments), chordError(desc.rings * 2));
+	case PrimitiveShape::Icosphere: {
+		//正二十面体の辺が中心から見て約1.107rad。分けた三角形の外接円の角度から近似する
+		const float edgeAngle = 1.1071487f / float(desc.segments);
+		return 1.0f - std::cos(edgeAngle / std::numbers::sqrt3_v<float>);
+	}
+	case PrimitiveShape::Cylinder:
+		return chordError(desc.segments);
+	case PrimitiveShape::Torus:
+		return (std::max)((1.0f + desc.minorRadius) * chordError(desc.segments), desc.minorRadius * chordError(desc.rings));
+	case PrimitiveShape::Cube:
+	case PrimitiveShape::Plane:
+		return 0.0f;
+	}
+	return 0.0f;
+}
+
+std::vector<PrimitiveLodLevel> MakePrimitiveLodLevels(const PrimitiveDesc& desc, uint32_t levelCount, uint32_t minSegments) {
+	std::vector<PrimitiveLodLevel> levels;
+	uint32_t vertexStart = 0;
+	uint32_t indexStart = 0;
+	for (uint32_t level = 0; level < levelCount; ++level) {
+		PrimitiveDesc levelDesc = desc;
+		levelDesc.segments = (std::max)(desc.segments >> level, (std::min)(desc.segments, minSegments));
+		levelDesc.rings = (std::max)(desc.rings >> level, (std::min)(desc.rings, minSegments));
+		const float error = GetPrimitiveTessellationError(levelDesc);
+		//誤差が変わらない段(立方体・平面のように平らな形)は見分けがつかないので作らない
+		if (!levels.empty() && (levels.back().desc == levelDesc || levels.back().error == error)) {
+			break;
+		}
+		const uint32_t vertexCount = GetPrimitiveVertexCount(levelDesc);
+		const uint32_t indexCount = GetPrimitiveIndexCount(levelDesc);
+		levels.push_back({ levelDesc, vertexStart, vertexCount, indexStart, indexCount, error });
+		vertexStart += vertexCount;
+		indexStart += indexCount;
+	}
+	return levels;
+}
+
+void GeneratePrimitiveLods(std::span<const PrimitiveLodLevel> levels, std::span<VertexData> vertices, std::span<uint32_t> indices) {
+	for (const PrimitiveLodLevel& level : levels) {
+		GeneratePrimitive(level.desc, vertices.subspan(level.vertexStart, level.vertexCount), indices.subspan(level.indexStart, level.indexCount));
+	}
+}
+
+#pragma region キャッシュ
+namespace {
+
+std::mutex primitiveCacheMutex;
+std::vector<std::pair<PrimitiveDesc, std::shared_ptr<const PrimitiveMesh>>> primitiveCache;  //数は多くならないので線形に探す
+
+}
+
+std::shared_ptr<const PrimitiveMesh> GetCachedPrimitive(const PrimitiveDesc& desc) {
+	std::lock_guard<std::mutex> lock(primitiveCacheMutex);
+	for (const auto& [cachedDesc, mesh] : primitiveCache) {
+		if (cachedDesc == desc) {
+			return mesh;
+		}
+	}
+	auto mesh = std::make_shared<PrimitiveMesh>();
+	mesh->vertices.resize(GetPrimitiveVertexCount(desc));
+	mesh->indices.resize(GetPrimitiveIndexCount(desc));
+	GeneratePrimitive(desc, mesh->vertices, mesh->indices);
+	primitiveCache.emplace_back(desc, mesh);
+	return mesh;
+}
+
+void ClearPrimitiveCache() {
+	std::lock_guard<std::mutex> lock(primitiveCacheMutex);
+	primitiveCache.clear();
+}
+#pragma endregion
\ No newline at end of file
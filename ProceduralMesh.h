@@ -0,0 +1,87 @@
+#pragma once
+#include "GraphicsData.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// 手続き的に作れる形
+enum class PrimitiveShape : uint32_t {
+	UvSphere,   //半径1。segmentsが経度、ringsが緯度の分割数
+	Icosphere,  //半径1。正二十面体の各辺をsegments等分する
+	Cube,       //中心から各面まで1。各面の辺をsegments等分する
+	Cylinder,   //半径1・高さ2(y = -1~1)。segmentsが周、ringsが高さの分割数。上下にふたがある
+	Torus,      //中心から管の中心まで1、管の半径minorRadius。segmentsが大きい円、ringsが管の周の分割数
+	Plane,      //xz平面の-1~1の正方形で、+yを向く。各辺をsegments等分する
+};
+
+// 形と分割数。キャッシュのキーにもなる
+struct PrimitiveDesc {
+	PrimitiveShape shape = PrimitiveShape::UvSphere;
+	uint32_t segments = 32;
+	uint32_t rings = 16;         //UvSphere・Cylinder・Torusだけ使う
+	float minorRadius = 0.25f;   //Torusだけ使う
+	float w = 1.0f;              //頂点の位置のwに入れる値
+
+	bool operator==(const PrimitiveDesc&) const = default;
+};
+
+// CPU側に持っておく生成結果
+struct PrimitiveMesh {
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+};
+
+// UV球の頂点数。緯度・経度の格子点ごとに1つ
+constexpr uint32_t GetUvSphereVertexCount(uint32_t segments, uint32_t rings) {
+	return (segments + 1) * (rings + 1);
+}
+
+// UV球のインデックス数。極の1周ぶんはつぶれた三角形を除くので、四角形1つにつき三角形1つになる
+constexpr uint32_t GetUvSphereIndexCount(uint32_t segments, uint32_t rings) {
+	return segments * (rings - 1) * 6;
+}
+
+// 半径1のUV球を経度をsegments、緯度をringsに分けて作り、verticesとindicesに書く(Mapしたバッファに直接書いてよい)
+// 頂点は格子点ごとに1つで、まわりの三角形で共有する。経度0と2πの列はUVが違うので、継ぎ目として両方持つ
+// 極の頂点も経度ごとにUVが違うので列の数だけ持つが、極に2点が集まる三角形は面積がないので入れない
+// 三角形の並びと周り順は、四角形ごとに6頂点を並べていたときと同じ。位置のwにはwを入れる
+void GenerateUvSphere(uint32_t segments, uint32_t rings, float w, std::span<VertexData> vertices, std::span<uint32_t> indices);
+
+// descの形の頂点数・インデックス数
+uint32_t GetPrimitiveVertexCount(const PrimitiveDesc& desc);
+uint32_t GetPrimitiveIndexCount(const PrimitiveDesc& desc);
+
+// descの形を作り、verticesとindicesに書く(Mapしたバッファに直接書いてよい)
+// sin/cosは周・段ごとに表にして1回だけ求め、段(行)の帯ごとにParallelForで並列に書く
+// どの形も三角形abcの外積(b-a)x(c-a)が外を向く
+void GeneratePrimitive(const PrimitiveDesc& desc, std::span<VertexData> vertices, std::span<uint32_t> indices);
+
+// 分割が粗いことによる、本来の曲面からの最大のずれ(形の大きさ1あたり)。平面だけの形は0
+// 画面上で何ピクセルずれるかはComputeLodPixelScaleを掛けて求める
+float GetPrimitiveTessellationError(const PrimitiveDesc& desc);
+
+// 1つの形を分割数を変えて複数作り、1つの頂点バッファ・インデックスバッファに並べたときの1段
+// インデックスは段の中での番号なので、描くときはvertexStartをBaseVertexLocationに渡す
+struct PrimitiveLodLevel {
+	PrimitiveDesc desc;
+	uint32_t vertexStart;
+	uint32_t vertexCount;
+	uint32_t indexStart;
+	uint32_t indexCount;
+	float error;  //GetPrimitiveTessellationError(desc)
+};
+
+// descを0段目として、分割数を半分ずつにした最大levelCount段の並べ方を決める
+// 分割数はminSegmentsより細かいところまでは減らさない(元がそれより粗ければ元のまま)。減らせなくなったらそこで終わる
+// 誤差が前の段と変わらなくなっても終わるので、立方体・平面は1段だけになる
+std::vector<PrimitiveLodLevel> MakePrimitiveLodLevels(const PrimitiveDesc& desc, uint32_t levelCount, uint32_t minSegments = 8);
+
+// levelsの各段を作り、verticesとindicesのそれぞれの範囲に書く(Mapしたバッファに直接書いてよい)
+void GeneratePrimitiveLods(std::span<const PrimitiveLodLevel> levels, std::span<VertexData> vertices, std::span<uint32_t> indices);
+
+// descの形を作ってキャッシュする。同じdescなら作らずに前の結果を返す。どのスレッドから呼んでもよい
+std::shared_ptr<const PrimitiveMesh> GetCachedPrimitive(const PrimitiveDesc& desc);
+
+// キャッシュを空にする(使っている側が持っているものは消えない)
+void ClearPrimitiveCache();
\ No newline at end of file
@@ -1,9 +1,9 @@
 #pragma once
 
 /// <summary>
-/// 4次元ベクトル
+/// クォータニオン(x,y,zが虚部、wが実部)
 /// </summary>
-struct Vector4 final {
+struct Quaternion final {
 	float x;
 	float y;
 	float z;
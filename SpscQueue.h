@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// 1つのスレッドが入れて、別の1つのスレッドが取り出すためのロックなしのキュー
+/// 容量は作るときに決めた2のべき乗で固定。いっぱいのときはTryPushが失敗する
+/// </summary>
+template<typename T>
+class SpscQueue {
+public:
+	explicit SpscQueue(size_t capacity)
+		: slots_(capacity), mask_(capacity - 1) {
+		assert(capacity > 0 && (capacity & (capacity - 1)) == 0);  //2のべき乗にする
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// 入れる側のスレッドだけが呼ぶ。いっぱいならvalueはそのままでfalseを返す
+	bool TryPush(T&& value) {
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+			return false;
+		}
+		slots_[tail & mask_] = std::move(value);
+		tail_.store(tail + 1, std::memory_order_release);  //書き込んだ要素が取り出す側から見えるようにする
+		return true;
+	}
+
+	// 取り出す側のスレッドだけが呼ぶ。空ならfalseを返す
+	bool TryPop(T& value) {
+		const size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) {
+			return false;
+		}
+		value = std::move(slots_[head & mask_]);
+		slots_[head & mask_] = T{};  //持っているメモリをすぐに手放す
+		head_.store(head + 1, std::memory_order_release);  //読み終わった場所を入れる側に返す
+		return true;
+	}
+
+	size_t Capacity() const { return slots_.size(); }
+
+private:
+	std::vector<T> slots_;
+	size_t mask_;
+	//入れる側と取り出す側で別のキャッシュラインにして、取り合わないようにする
+	alignas(64) std::atomic<size_t> head_ = 0;  //次に取り出す位置(取り出す側だけが書く)
+	alignas(64) std::atomic<size_t> tail_ = 0;  //次に入れる位置(入れる側だけが書く)
+};
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace {
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+void TlsfAllocator::Mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) {
+	if (size < kSmallBlockSize) {
+		firstLevel = 0;
+		secondLevel = uint32_t(size / (kSmallBlockSize / kSecondLevelCount));
+		return;
+	}
+	const uint32_t topBit = uint32_t(std::bit_width(size)) - 1;
+	secondLevel = uint32_t(size >> (topBit - kSecondLevelShift)) ^ kSecondLevelCount;
+	firstLevel = topBit - (kFirstLevelShift - 1);
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity)
+	: capacity_(capacity & ~((1ull << kAlignShift) - 1)) {
+	assert(capacity_ > 0);
+	for (auto& heads : freeHeads_) {
+		std::fill(std::begin(heads), std::end(heads), kNone);
+	}
+	firstPhysical_ = NewBlock(0, capacity_);
+	InsertFree(firstPhysical_);
+}
+
+uint32_t TlsfAllocator::NewBlock(uint64_t offset, uint64_t size) {
+	uint32_t block;
+	if (!unusedNodes_.empty()) {
+		block = unusedNodes_.back();
+		unusedNodes_.pop_back();
+	}
+	else {
+		block = uint32_t(nodes_.size());
+		nodes_.emplace_back();
+	}
+	nodes_[block] = { offset, size, 0, kNone, kNone, kNone, kNone, false };
+	return block;
+}
+
+void TlsfAllocator::DeleteBlock(uint32_t block) {
+	unusedNodes_.push_back(block);
+}
+
+void TlsfAllocator::InsertFree(uint32_t block) {
+	uint32_t firstLevel, secondLevel;
+	Mapping(nodes_[block].size, firstLevel, secondLevel);
+	const uint32_t head = freeHeads_[firstLevel][secondLevel];
+	nodes_[block].isFree = true;
+	nodes_[block].prevFree = kNone;
+	nodes_[block].nextFree = head;
+	if (head != kNone) {
+		nodes_[head].prevFree = block;
+	}
+	freeHeads_[firstLevel][secondLevel] = block;
+	firstLevelBitmap_ |= 1ull << firstLevel;
+	secondLevelBitmaps_[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t block) {
+	uint32_t firstLevel, secondLevel;
+	Mapping(nodes_[block].size, firstLevel, secondLevel);
+	Block& node = nodes_[block];
+	if (node.prevFree != kNone) {
+		nodes_[node.prevFree].nextFree = node.nextFree;
+	}
+	else {
+		freeHeads_[firstLevel][secondLevel] = node.nextFree;
+		//その区分が空になったらビットを落とす
+		if (node.nextFree == kNone) {
+			secondLevelBitmaps_[firstLevel] &= ~(1u << secondLevel);
+			if (secondLevelBitmaps_[firstLevel] == 0) {
+				firstLevelBitmap_ &= ~(1ull << firstLevel);
+			}
+		}
+	}
+	if (node.nextFree != kNone) {
+		nodes_[node.nextFree].prevFree = node.prevFree;
+	}
+	node.isFree = false;
+	node.prevFree = kNone;
+	node.nextFree = kNone;
+}
+
+void TlsfAllocator::SplitTail(uint32_t block, uint64_t size) {
+	const uint64_t rest = nodes_[block].size - size;
+	if (rest == 0) {
+		return;
+	}
+	const uint32_t tail = NewBlock(nodes_[block].offset + size, rest);
+	nodes_[block].size = size;
+	nodes_[tail].prevPhysical = block;
+	nodes_[tail].nextPhysical = nodes_[block].nextPhysical;
+	if (nodes_[block].nextPhysical != kNone) {
+		nodes_[nodes_[block].nextPhysical].prevPhysical = tail;
+	}
+	nodes_[block].nextPhysical = tail;
+	InsertFree(tail);
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t size) const {
+	//区分の中の大きさはばらつくので、1つ上の区分から探せばどのブロックでも必ず入る
+	uint64_t roundedSize = size;
+	if (size >= kSmallBlockSize) {
+		roundedSize += (1ull << (std::bit_width(size) - 1 - kSecondLevelShift)) - 1;
+	}
+	uint32_t firstLevel, secondLevel;
+	Mapping(roundedSize, firstLevel, secondLevel);
+	if (firstLevel < kFirstLevelCount) {
+		uint32_t secondLevelMap = secondLevelBitmaps_[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0) {
+			const uint64_t firstLevelMap = firstLevel + 1 < kFirstLevelCount ? firstLevelBitmap_ & (~0ull << (firstLevel + 1)) : 0;
+			firstLevel = firstLevelMap != 0 ? uint32_t(std::countr_zero(firstLevelMap)) : kFirstLevelCount;
+			secondLevelMap = firstLevelMap != 0 ? secondLevelBitmaps_[firstLevel] : 0;
+		}
+		if (secondLevelMap != 0) {
+			return freeHeads_[firstLevel][uint32_t(std::countr_zero(secondLevelMap))];
+		}
+	}
+
+	//上の区分になければ、同じ区分の中から入るものを探す(ヒープ全体のようにちょうどの大きさを頼まれたとき)
+	Mapping(size, firstLevel, secondLevel);
+	for (uint32_t block = freeHeads_[firstLevel][secondLevel]; block != kNone; block = nodes_[block].nextFree) {
+		if (nodes_[block].size >= size) {
+			return block;
+		}
+	}
+	return kNone;
+}
+
+TlsfAllocation TlsfAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);  //2のべき乗にする
+	const uint64_t granularity = 1ull << kAlignShift;
+	alignment = (std::max)(alignment, granularity);
+	if (size == 0 || size > capacity_) {
+		return {};
+	}
+	size = AlignUp(size, granularity);
+
+	//まずはそろえるための隙間なしで探し、見つけたブロックで足りなければ隙間の分だけ大きく探し直す
+	//(GPUのヒープのようにほとんどが同じアラインメントなら、1回目で見つかる)
+	uint32_t block = FindFree(size);
+	if (block != kNone && AlignUp(nodes_[block].offset, alignment) - nodes_[block].offset + size > nodes_[block].size) {
+		block = alignment > granularity ? FindFree(size + alignment - granularity) : kNone;
+	}
+	if (block == kNone) {
+		return {};
+	}
+	RemoveFree(block);
+
+	//前にできた隙間は空きブロックとして残す(空きブロックの前後は必ず使用中なので、つなげる相手はない)
+	const uint64_t padding = AlignUp(nodes_[block].offset, alignment) - nodes_[block].offset;
+	if (padding > 0) {
+		const uint32_t front = NewBlock(nodes_[block].offset, padding);
+		nodes_[front].prevPhysical = nodes_[block].prevPhysical;
+		nodes_[front].nextPhysical = block;
+		if (nodes_[block].prevPhysical != kNone) {
+			nodes_[nodes_[block].prevPhysical].nextPhysical = front;
+		}
+		else {
+			firstPhysical_ = front;
+		}
+		nodes_[block].prevPhysical = front;
+		nodes_[block].offset += padding;
+		nodes_[block].size -= padding;
+		InsertFree(front);
+	}
+	SplitTail(block, size);
+	nodes_[block].alignment = alignment;
+	usedBytes_ += size;
+	++allocationCount_;
+	return { block, nodes_[block].offset, size };
+}
+
+void TlsfAllocator::Free(const TlsfAllocation& allocation) {
+	uint32_t block = allocation.node;
+	//二重解放や、このアロケータのものではない範囲
+	assert(block < nodes_.size() && !nodes_[block].isFree && nodes_[block].size == allocation.size);
+	usedBytes_ -= nodes_[block].size;
+	--allocationCount_;
+
+	//前後の空きブロックとつなげる
+	const uint32_t prev = nodes_[block].prevPhysical;
+	if (prev != kNone && nodes_[prev].isFree) {
+		RemoveFree(prev);
+		nodes_[prev].size += nodes_[block].size;
+		nodes_[prev].nextPhysical = nodes_[block].nextPhysical;
+		if (nodes_[block].nextPhysical != kNone) {
+			nodes_[nodes_[block].nextPhysical].prevPhysical = prev;
+		}
+		DeleteBlock(block);
+		block = prev;
+	}
+	const uint32_t next = nodes_[block].nextPhysical;
+	if (next != kNone && nodes_[next].isFree) {
+		RemoveFree(next);
+		nodes_[block].size += nodes_[next].size;
+		nodes_[block].nextPhysical = nodes_[next].nextPhysical;
+		if (nodes_[next].nextPhysical != kNone) {
+			nodes_[nodes_[next].nextPhysical].prevPhysical = block;
+		}
+		DeleteBlock(next);
+	}
+	InsertFree(block);
+}
+
+std::vector<TlsfMove> TlsfAllocator::Compact() {
+	//使用中のブロックだけをアドレス順に集めて、空きブロックはすべて捨てる
+	std::vector<uint32_t> usedBlocks;
+	usedBlocks.reserve(allocationCount_);
+	for (uint32_t block = firstPhysical_; block != kNone; block = nodes_[block].nextPhysical) {
+		if (nodes_[block].isFree) {
+			RemoveFree(block);
+			DeleteBlock(block);
+		}
+		else {
+			usedBlocks.push_back(block);
+		}
+	}
+
+	//先頭から詰め直す。前のブロックの終わりは元の位置より後ろにならないので、どれも前にしか動かない
+	std::vector<TlsfMove> moves;
+	uint32_t prev = kNone;
+	uint64_t cursor = 0;
+	auto link = [&](uint32_t block) {
+		nodes_[block].prevPhysical = prev;
+		nodes_[block].nextPhysical = kNone;
+		if (prev != kNone) {
+			nodes_[prev].nextPhysical = block;
+		}
+		else {
+			firstPhysical_ = block;
+		}
+		prev = block;
+	};
+	for (uint32_t block : usedBlocks) {
+		const uint64_t destination = AlignUp(cursor, nodes_[block].alignment);
+		if (destination > cursor) {
+			const uint32_t gap = NewBlock(cursor, destination - cursor);
+			link(gap);
+			InsertFree(gap);
+		}
+		if (destination != nodes_[block].offset) {
+			moves.push_back({ block, nodes_[block].offset, destination, nodes_[block].size });
+			nodes_[block].offset = destination;
+		}
+		link(block);
+		cursor = destination + nodes_[block].size;
+	}
+	if (cursor < capacity_) {
+		const uint32_t tail = NewBlock(cursor, capacity_ - cursor);
+		link(tail);
+		InsertFree(tail);
+	}
+	return moves;
+}
+
+TlsfStatistics TlsfAllocator::GetStatistics() const {
+	TlsfStatistics statistics{ capacity_, usedBytes_, capacity_ - usedBytes_, 0, allocationCount_, 0, 0.0f };
+	for (uint32_t block = firstPhysical_; block != kNone; block = nodes_[block].nextPhysical) {
+		if (nodes_[block].isFree) {
+			statistics.largestFreeBlock = (std::max)(statistics.largestFreeBlock, nodes_[block].size);
+			++statistics.freeBlockCount;
+		}
+	}
+	if (statistics.freeBytes > 0) {
+		statistics.fragmentation = 1.0f - float(double(statistics.largestFreeBlock) / double(statistics.freeBytes));
+	}
+	return statistics;
+}
+
+bool TlsfAllocator::Validate() const {
+	//アドレス順のリストが隙間なく全体を覆い、空きブロックが隣り合っていないこと
+	uint64_t offset = 0;
+	uint64_t usedBytes = 0;
+	uint32_t allocationCount = 0;
+	uint32_t freeCount = 0;
+	uint32_t prev = kNone;
+	for (uint32_t block = firstPhysical_; block != kNone; block = nodes_[block].nextPhysical) {
+		const Block& node = nodes_[block];
+		if (node.offset != offset || node.size == 0 || node.prevPhysical != prev) {
+			return false;
+		}
+		if (node.isFree) {
+			if (prev != kNone && nodes_[prev].isFree) {
+				return false;
+			}
+			++freeCount;
+		}
+		else {
+			if (node.offset % node.alignment != 0) {
+				return false;
+			}
+			usedBytes += node.size;
+			++allocationCount;
+		}
+		offset += node.size;
+		prev = block;
+	}
+	if (offset != capacity_ || usedBytes != usedBytes_ || allocationCount != allocationCount_) {
+		return false;
+	}
+	//空きリストに入っているブロックが、ちょうど空きブロックと同じで、区分とビットが合っていること
+	uint32_t listedCount = 0;
+	for (uint32_t firstLevel = 0; firstLevel < kFirstLevelCount; ++firstLevel) {
+		for (uint32_t secondLevel = 0; secondLevel < kSecondLevelCount; ++secondLevel) {
+			const bool hasBit = (secondLevelBitmaps_[firstLevel] >> secondLevel) & 1;
+			if (hasBit != (freeHeads_[firstLevel][secondLevel] != kNone)) {
+				return false;
+			}
+			for (uint32_t block = freeHeads_[firstLevel][secondLevel]; block != kNone; block = nodes_[block].nextFree) {
+				uint32_t blockFirstLevel, blockSecondLevel;
+				Mapping(nodes_[block].size, blockFirstLevel, blockSecondLevel);
+				if (!nodes_[block].isFree || blockFirstLevel != firstLevel || blockSecondLevel != secondLevel) {
+					return false;
+				}
+				++listedCount;
+			}
+		}
+		if (((firstLevelBitmap_ >> firstLevel) & 1) != (secondLevelBitmaps_[firstLevel] != 0)) {
+			return false;
+		}
+	}
+	return listedCount == freeCount;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// TlsfAllocatorが貸し出した範囲
+struct TlsfAllocation {
+	uint32_t node = UINT32_MAX;  //アロケータの中の管理番号。Compactしても変わらない
+	uint64_t offset = 0;
+	uint64_t size = 0;           //切り上げた後の大きさ
+};
+
+// 空き領域と断片化の様子
+struct TlsfStatistics {
+	uint64_t capacity;
+	uint64_t usedBytes;
+	uint64_t freeBytes;
+	uint64_t largestFreeBlock;
+	uint32_t allocationCount;
+	uint32_t freeBlockCount;
+	float fragmentation;  //1 - largestFreeBlock / freeBytes(0なら空きが1か所にまとまっている)
+};
+
+// Compactで動かした範囲。この順にコピーする(同じ範囲の中で重なることがあるので、memmoveと同じように扱う)
+struct TlsfMove {
+	uint32_t node;
+	uint64_t sourceOffset;
+	uint64_t destinationOffset;
+	uint64_t size;
+};
+
+/// <summary>
+/// TLSF(Two-Level Segregated Fit)で1つの範囲を切り分けるアロケータ。確保も解放もO(1)
+/// 管理情報は範囲の外に持つので、GPUのヒープのようにCPUから触れないメモリの配置にも使える
+/// 大きさは16バイト単位に切り上げる
+/// </summary>
+class TlsfAllocator {
+public:
+	explicit TlsfAllocator(uint64_t capacity);
+
+	// sizeバイトをalignment(2のべき乗)境界にそろえて切り出す。入らなければnodeがUINT32_MAXのものを返す
+	TlsfAllocation Allocate(uint64_t size, uint64_t alignment = 1);
+	// 切り出した範囲を返す。隣の空きとはすぐにつなげる
+	void Free(const TlsfAllocation& allocation);
+	// nodeの今のオフセット(Compactで変わる)
+	uint64_t GetOffset(uint32_t node) const { return nodes_[node].offset; }
+	// nodeを切り出したときに頼まれたアラインメント
+	uint64_t GetAlignment(uint32_t node) const { return nodes_[node].alignment; }
+
+	// 使っている範囲をアドレス順のままアラインメントを守って先頭に詰め、空きを末尾にまとめる(アラインメントの隙間は残る)
+	// 動かした範囲を返すので、呼び出し側が中身をコピーしてオフセットを付け替える
+	std::vector<TlsfMove> Compact();
+
+	TlsfStatistics GetStatistics() const;
+	uint64_t Capacity() const { return capacity_; }
+	uint64_t UsedBytes() const { return usedBytes_; }
+	uint32_t AllocationCount() const { return allocationCount_; }
+
+	// 管理情報が壊れていないかを調べる(テスト・デバッグ用。O(ブロック数))
+	bool Validate() const;
+
+private:
+	static constexpr uint32_t kNone = UINT32_MAX;
+	static constexpr uint32_t kAlignShift = 4;                                //最小の単位は16バイト
+	static constexpr uint32_t kSecondLevelShift = 5;                          //2段目は32分割
+	static constexpr uint32_t kSecondLevelCount = 1u << kSecondLevelShift;
+	static constexpr uint32_t kFirstLevelShift = kSecondLevelShift + kAlignShift;
+	static constexpr uint64_t kSmallBlockSize = 1ull << kFirstLevelShift;    //これより小さいブロックは1段目を0にまとめる
+	static constexpr uint32_t kFirstLevelCount = 64 - kFirstLevelShift + 1;
+
+	// 範囲の中のひとかたまり(使用中か空き)。アドレス順の双方向リストと、空きのときは大きさの区分ごとのリストにつなぐ
+	struct Block {
+		uint64_t offset;
+		uint64_t size;
+		uint64_t alignment;  //使用中のときに頼まれたアラインメント(Compactで守る)
+		uint32_t prevPhysical;
+		uint32_t nextPhysical;
+		uint32_t prevFree;
+		uint32_t nextFree;
+		bool isFree;
+	};
+
+	// 大きさから1段目と2段目の区分を求める
+	static void Mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+	uint32_t NewBlock(uint64_t offset, uint64_t size);
+	void DeleteBlock(uint32_t block);
+	void InsertFree(uint32_t block);
+	void RemoveFree(uint32_t block);
+	// blockの後ろのsizeバイトより先を切り離して、新しい空きブロックにする
+	void SplitTail(uint32_t block, uint64_t size);
+	uint32_t FindFree(uint64_t size) const;
+
+	uint64_t capacity_;
+	uint64_t usedBytes_ = 0;
+	uint32_t allocationCount_ = 0;
+	uint32_t firstPhysical_ = kNone;  //オフセット0のブロック
+	std::vector<Block> nodes_;
+	std::vector<uint32_t> unusedNodes_;  //nodes_の中の使っていない要素
+	uint64_t firstLevelBitmap_ = 0;
+	uint32_t secondLevelBitmaps_[kFirstLevelCount] = {};
+	uint32_t freeHeads_[kFirstLevelCount][kSecondLevelCount];
+};
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "UploadRingAllocator.h"
+#include <cassert>
+
+UploadRingAllocator::UploadRingAllocator(uint64_t capacity)
+	: capacity_(capacity) {
+	assert(capacity > 0);
+}
+
+uint64_t UploadRingAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);  //2のべき乗にする
+	assert(capacity_ % alignment == 0);  //回り込んでもオフセットがそろったままになるように
+	if (size == 0 || size > capacity_) {
+		return kInvalidOffset;
+	}
+	uint64_t begin = (head_ + alignment - 1) & ~(alignment - 1);
+	//末尾をまたぐなら次の周の先頭から切り出す
+	if (begin / capacity_ != (begin + size - 1) / capacity_) {
+		begin = (begin / capacity_ + 1) * capacity_;
+	}
+	//まだGPUが読んでいるかもしれない範囲に重なるなら切り出せない
+	if (begin + size - tail_ > capacity_) {
+		return kInvalidOffset;
+	}
+	head_ = begin + size;
+	return begin % capacity_;
+}
+
+void UploadRingAllocator::FinishFrame(uint64_t fenceValue) {
+	assert(frames_.empty() || frames_.back().fenceValue < fenceValue);
+	if (head_ == frameStart_) {
+		return;  //何も切り出していないフレームは記録しない
+	}
+	frames_.push_back({ fenceValue, head_ });
+	frameStart_ = head_;
+}
+
+void UploadRingAllocator::Reclaim(uint64_t completedFenceValue) {
+	while (!frames_.empty() && frames_.front().fenceValue <= completedFenceValue) {
+		tail_ = frames_.front().end;
+		frames_.pop_front();
+	}
+}
\ No newline at end of file
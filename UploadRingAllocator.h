@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// 定数バッファ(CBV)のアドレスは256バイト境界にそろえる必要がある
+constexpr uint64_t kConstantBufferAlignment = 256;
+
+/// <summary>
+/// 1つの大きなアップロードバッファを先頭から順に切り出して、使い終わった古いフレームの分から回収するリングアロケータ
+/// 切り出す場所(オフセット)を決めるだけでGPUのAPIには触らないので、フェンスの値は呼び出し側が渡す
+/// 1フレームの流れ: Reclaim(完了したフェンス値) → Allocateを何回か → FinishFrame(このフレームでSignalする値)
+/// </summary>
+class UploadRingAllocator {
+public:
+	// 切り出せなかったときにAllocateが返す値
+	static constexpr uint64_t kInvalidOffset = UINT64_MAX;
+
+	// capacityはバッファの大きさ(バイト)。使うアラインメントの倍数にする
+	explicit UploadRingAllocator(uint64_t capacity);
+
+	// sizeバイトをalignment(2のべき乗)境界にそろえて切り出し、バッファの先頭からのオフセットを返す
+	// 空きが足りないときはkInvalidOffsetを返す。バッファの末尾をまたぐときは先頭に戻り、末尾の余りは捨てる
+	uint64_t Allocate(uint64_t size, uint64_t alignment = kConstantBufferAlignment);
+
+	// 前回のFinishFrameから後に切り出した分を、GPUがfenceValueまで進んだら回収するものとして記録する
+	// fenceValueは呼ぶたびに大きくする
+	void FinishFrame(uint64_t fenceValue);
+
+	// フェンス値がcompletedFenceValue以下のフレームの分を回収する
+	void Reclaim(uint64_t completedFenceValue);
+
+	uint64_t Capacity() const { return capacity_; }
+	// まだ回収されていないバイト数(末尾で捨てた余りとアラインメントの隙間を含む)
+	uint64_t UsedBytes() const { return head_ - tail_; }
+	// FinishFrameを待っている分も含めて、回収を待っているフレーム数
+	size_t FramesInFlight() const { return frames_.size() + (head_ != frameStart_ ? 1 : 0); }
+
+private:
+	// 1フレームで切り出した範囲の終わりと、それを回収してよくなるフェンス値
+	struct FrameRecord {
+		uint64_t fenceValue;
+		uint64_t end;
+	};
+
+	uint64_t capacity_;
+	//位置は回り込ませずに増やし続け、capacity_で割った余りをオフセットにする
+	uint64_t head_ = 0;        //次に切り出す位置
+	uint64_t tail_ = 0;        //まだ回収されていない一番古い位置
+	uint64_t frameStart_ = 0;  //今のフレームで最初に切り出した位置
+	std::deque<FrameRecord> frames_;
+};
\ No newline at end of file
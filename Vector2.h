@@ -1,6 +1,9 @@
 #pragma once
-struct Vector2
-{
-    float x;
-    float y;
-};
\ No newline at end of file
+
+/// <summary>
+/// 2次元ベクトル
+/// </summary>
+struct Vector2 final {
+	float x;
+	float y;
+};
@@ -1,7 +1,10 @@
 #pragma once
-struct Vector3
-{
-    float x;
-    float y;
-    float z;
+
+/// <summary>
+/// 3次元ベクトル
+/// </summary>
+struct Vector3 final {
+	float x;
+	float y;
+	float z;
 };
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
-struct Vector4
-{
-    float x;
-    float y;
-    float z;
-    float w;
+
+/// <summary>
+/// 4次元ベクトル
+/// </summary>
+struct Vector4 final {
+	float x;
+	float y;
+	float z;
+	float w;
 };
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#pragma region half
+uint16_t FloatToHalf(float value) {
+	const uint32_t bits = std::bit_cast<uint32_t>(value);
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+	const uint32_t absolute = bits & 0x7FFFFFFFu;
+
+	//無限大とNaN(NaNは仮数部の上位ビットを残して、無限大にならないようにする)
+	if (absolute >= 0x7F800000u) {
+		return sign | 0x7C00u | (absolute > 0x7F800000u ? 0x0200u | ((absolute >> 13) & 0x03FFu) : 0u);
+	}
+	//halfの最大値(65504)を丸めで超えるものは無限大
+	if (absolute >= 0x477FF000u) {
+		return sign | 0x7C00u;
+	}
+	//halfの正規化数
+	if (absolute >= 0x38800000u) {
+		const uint32_t rounded = absolute + 0x0FFFu + ((absolute >> 13) & 1u);
+		return sign | static_cast<uint16_t>((rounded - 0x38000000u) >> 13);
+	}
+	//halfの非正規化数(2^-24未満の半分より小さいものは0)
+	if (absolute < 0x33000000u) {
+		return sign;
+	}
+	const uint32_t exponent = absolute >> 23;
+	const uint32_t mantissa = (absolute & 0x007FFFFFu) | 0x00800000u;
+	const uint32_t shift = 126u - exponent;  //14~24
+	const uint32_t halfMantissa = mantissa >> shift;
+	const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+	const uint32_t halfway = 1u << (shift - 1u);
+	const uint32_t roundUp = (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) ? 1u : 0u;
+	return sign | static_cast<uint16_t>(halfMantissa + roundUp);
+}
+
+float HalfToFloat(uint16_t value) {
+	const uint32_t sign = uint32_t(value & 0x8000u) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1Fu;
+	const uint32_t mantissa = value & 0x03FFu;
+	if (exponent == 0x1Fu) {
+		return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+	}
+	if (exponent == 0) {
+		//非正規化数は仮数×2^-24
+		const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+		return sign ? -magnitude : magnitude;
+	}
+	return std::bit_cast<float>(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+#pragma endregion
+
+
+#pragma region 八面体エンコード
+namespace {
+
+float SignNotZero(float value) {
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+int16_t ToSnorm16(float value) {
+	return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+float FromSnorm16(int16_t value) {
+	return (std::max)(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+}
+
+void EncodeOctahedralNormal(const Vector3& normal, int16_t encoded[2]) {
+	//|x|+|y|+|z|=1の八面体に射影し、下半分(z<0)は外側の三角形に折り返す
+	const float lengthL1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (lengthL1 == 0.0f) {
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+	float x = normal.x / lengthL1;
+	float y = normal.y / lengthL1;
+	if (normal.z < 0.0f) {
+		const float foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+		const float foldedY = (1.0f - std::abs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+	encoded[0] = ToSnorm16(x);
+	encoded[1] = ToSnorm16(y);
+}
+
+Vector3 DecodeOctahedralNormal(const int16_t encoded[2]) {
+	Vector3 normal = { FromSnorm16(encoded[0]), FromSnorm16(encoded[1]), 0.0f };
+	normal.z = 1.0f - std::abs(normal.x) - std::abs(normal.y);
+	const float t = (std::max)(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -t : t;
+	normal.y += normal.y >= 0.0f ? -t : t;
+	const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	return { normal.x / length, normal.y / length, normal.z / length };
+}
+#pragma endregion
+
+
+#pragma region 頂点
+PackedVertexData PackVertex(const VertexData& vertex) {
+	PackedVertexData packed = {};
+	packed.position = { vertex.position.x, vertex.position.y, vertex.position.z };
+	EncodeOctahedralNormal(vertex.normal, packed.normal);
+	packed.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+	packed.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+	return packed;
+}
+
+VertexData UnpackVertex(const PackedVertexData& packed) {
+	VertexData vertex = {};
+	vertex.position = { packed.position.x, packed.position.y, packed.position.z, 1.0f };
+	vertex.texcoord = { HalfToFloat(packed.texcoord[0]), HalfToFloat(packed.texcoord[1]) };
+	vertex.normal = DecodeOctahedralNormal(packed.normal);
+	return vertex;
+}
+
+std::vector<PackedVertexData> PackVertices(std::span<const VertexData> vertices) {
+	std::vector<PackedVertexData> packed(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		packed[i] = PackVertex(vertices[i]);
+	}
+	return packed;
+}
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+#include "GraphicsData.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// floatとhalf(IEEE754の16bit浮動小数点数)の変換。最近接偶数丸め、非正規化数・無限大・NaNにも対応
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+// 単位ベクトルを八面体エンコードして、2つの16bit SNORMにする。HLSL側のデコードはObject3dPacked.VS.hlsl
+void EncodeOctahedralNormal(const Vector3& normal, int16_t encoded[2]);
+Vector3 DecodeOctahedralNormal(const int16_t encoded[2]);
+
+PackedVertexData PackVertex(const VertexData& vertex);
+VertexData UnpackVertex(const PackedVertexData& packed);
+std::vector<PackedVertexData> PackVertices(std::span<const VertexData> vertices);
\ No newline at end of file
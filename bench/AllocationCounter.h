@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// グローバルなoperator new/deleteを置き換えて、全スレッドのメモリ確保の回数を数える
+// 置き換えはプログラムに1つだけなので、1つの実行ファイルでは1つの.cppからだけインクルードする
+// 引数の違うnew(配列・nothrow)とdeleteは、標準の実装がここで置き換えたものを呼ぶ
+
+inline std::atomic<uint64_t>& AllocationCountStorage() {
+	static std::atomic<uint64_t> count = 0;
+	return count;
+}
+
+// 今までのoperator newの呼び出し回数(BenchmarkObjLoadのAllocationCounterに渡せる)
+inline uint64_t GetAllocationCount() {
+	return AllocationCountStorage().load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+	AllocationCountStorage().fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size ? size : 1)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	AllocationCountStorage().fetch_add(1, std::memory_order_relaxed);
+	const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+	void* pointer = _aligned_malloc(size ? size : 1, align);
+#else
+	//aligned_allocは大きさがアラインメントの倍数でないといけない
+	void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+	if (pointer) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+#ifdef _WIN32
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(pointer, alignment);
+}
\ No newline at end of file
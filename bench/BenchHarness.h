@@ -0,0 +1,193 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ベンチマーク用の小さな計測ハーネス(ヘッダーオンリー)
+// 各ベンチマークは「batchSize個を1回処理する関数」を渡す。最低計測時間を超えるまで繰り返し、
+// それを何回か測って一番速かった回から1要素あたりの時間(ns/op)と1秒あたりの処理数(ops/s)を求める
+// 結果は表にして標準出力に出し、--json <path>が指定されていればJSONでも書き出す
+//
+// コマンドライン引数
+//   --json <path>    結果をJSONで書き出す
+//   --min-time <ms>  1回の計測の最低時間(既定は100ms)
+//   --repeat <n>     計測の回数(既定は5回。一番速かった回を使う)
+//   --quick          動作確認用に最低計測時間を1ms、計測を1回にする(ctestから呼ぶ)
+
+struct BenchSettings {
+	double minMilliseconds = 100.0;
+	uint32_t repeatCount = 5;
+	std::string jsonPath;
+	bool quick = false;
+};
+
+struct BenchResult {
+	std::string name;
+	std::string variant;     //同じベンチマークの実装の違い(sse/scalar・precise/fastなど)
+	uint64_t batchSize = 0;  //1回の呼び出しで処理する要素数
+	uint64_t iterations = 0; //一番速かった回での呼び出し回数
+	double nsPerOp = 0.0;
+	double opsPerSecond = 0.0;
+	double bytesPerOp = 0.0; //0でなければMB/sも出す
+	double megabytesPerSecond = 0.0;
+};
+
+// 結果をコンパイラの最適化で消されないようにする
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+	(void)sink;
+#endif
+}
+
+inline BenchSettings ParseBenchArguments(int argc, char** argv) {
+	BenchSettings settings;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			settings.jsonPath = argv[++i];
+		} else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+			settings.minMilliseconds = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			settings.repeatCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		} else if (std::strcmp(argv[i], "--quick") == 0) {
+			settings.quick = true;
+			settings.minMilliseconds = 1.0;
+			settings.repeatCount = 1;
+		}
+	}
+	return settings;
+}
+
+// 「512K」「64M」「2G」(1024倍ずつ)か数字だけのバイト数を読む。読めなければ0
+inline uint64_t ParseByteSize(const std::string& text) {
+	char* end = nullptr;
+	const double value = std::strtod(text.c_str(), &end);
+	if (end == text.c_str() || value <= 0.0) {
+		return 0;
+	}
+	double scale = 1.0;
+	switch (*end) {
+	case 'K': case 'k': scale = 1024.0; break;
+	case 'M': case 'm': scale = 1024.0 * 1024.0; break;
+	case 'G': case 'g': scale = 1024.0 * 1024.0 * 1024.0; break;
+	case '\0': break;
+	default: return 0;
+	}
+	return static_cast<uint64_t>(value * scale);
+}
+
+// 「1M,64M,2G」のようにカンマで区切ったバイト数を読む。読めないものは飛ばす
+inline std::vector<uint64_t> ParseByteSizeList(const std::string& text) {
+	std::vector<uint64_t> sizes;
+	size_t start = 0;
+	while (start <= text.size()) {
+		const size_t comma = (std::min)(text.find(',', start), text.size());
+		if (const uint64_t size = ParseByteSize(text.substr(start, comma - start))) {
+			sizes.push_back(size);
+		}
+		start = comma + 1;
+	}
+	return sizes;
+}
+
+// body()を1回呼ぶとbatchSize個を処理するものとして計測する
+template<typename Body>
+inline BenchResult RunBenchmark(const BenchSettings& settings, const std::string& name, const std::string& variant, uint64_t batchSize, Body&& body) {
+	using Clock = std::chrono::steady_clock;
+	// 1回だけ呼んでキャッシュを温め、最低計測時間に届く呼び出し回数を見積もる
+	Clock::time_point warmStart = Clock::now();
+	body();
+	double warmNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - warmStart).count());
+	uint64_t iterations = static_cast<uint64_t>(settings.minMilliseconds * 1.0e6 / std::max(warmNs, 1.0)) + 1;
+
+	double bestNs = 0.0;
+	for (uint32_t repeat = 0; repeat < settings.repeatCount; repeat++) {
+		Clock::time_point start = Clock::now();
+		for (uint64_t i = 0; i < iterations; i++) {
+			body();
+		}
+		double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+		if (repeat == 0 || ns < bestNs) {
+			bestNs = ns;
+		}
+	}
+
+	BenchResult result;
+	result.name = name;
+	result.variant = variant;
+	result.batchSize = batchSize;
+	result.iterations = iterations;
+	result.nsPerOp = bestNs / static_cast<double>(iterations * batchSize);
+	result.opsPerSecond = result.nsPerOp > 0.0 ? 1.0e9 / result.nsPerOp : 0.0;
+	return result;
+}
+
+// 1要素あたりのバイト数を設定してMB/sを求める(ファイル読み込みなどで使う)
+inline BenchResult& SetBytesPerOp(BenchResult& result, double bytesPerOp) {
+	result.bytesPerOp = bytesPerOp;
+	result.megabytesPerSecond = result.nsPerOp > 0.0 ? bytesPerOp / result.nsPerOp * 1.0e9 / (1024.0 * 1024.0) : 0.0;
+	return result;
+}
+
+inline void PrintBenchResult(const BenchResult& result) {
+	std::printf("%-36s %-10s batch=%-8llu %12.3f ns/op %14.0f ops/s", result.name.c_str(), result.variant.c_str(),
+		static_cast<unsigned long long>(result.batchSize), result.nsPerOp, result.opsPerSecond);
+	if (result.bytesPerOp > 0.0) {
+		std::printf(" %10.1f MB/s", result.megabytesPerSecond);
+	}
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+// 結果をJSONで書き出す。名前にはASCIIの英数字と記号しか使わない前提でエスケープは「"」と「\」だけ行う
+inline bool WriteBenchJson(const std::string& path, const std::string& suite, const std::vector<BenchResult>& results) {
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+	auto escape = [](const std::string& text) {
+		std::string escaped;
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+			}
+			escaped += c;
+		}
+		return escaped;
+	};
+	std::fprintf(file, "{\n  \"suite\": \"%s\",\n  \"results\": [\n", escape(suite).c_str());
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& result = results[i];
+		std::fprintf(file, "    {\"name\": \"%s\", \"variant\": \"%s\", \"batch\": %llu, \"iterations\": %llu, \"ns_per_op\": %.4f, \"ops_per_s\": %.1f",
+			escape(result.name).c_str(), escape(result.variant).c_str(), static_cast<unsigned long long>(result.batchSize),
+			static_cast<unsigned long long>(result.iterations), result.nsPerOp, result.opsPerSecond);
+		if (result.bytesPerOp > 0.0) {
+			std::fprintf(file, ", \"mb_per_s\": %.2f", result.megabytesPerSecond);
+		}
+		std::fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n}\n");
+	std::fclose(file);
+	return true;
+}
+
+// 結果をまとめて表示・保存する。JSONの書き出しに失敗したら1を返す(mainの戻り値にする)
+inline int FinishBenchmarks(const BenchSettings& settings, const std::string& suite, const std::vector<BenchResult>& results) {
+	if (!settings.jsonPath.empty()) {
+		if (!WriteBenchJson(settings.jsonPath, suite, results)) {
+			std::fprintf(stderr, "failed to write %s\n", settings.jsonPath.c_str());
+			return 1;
+		}
+		std::printf("wrote %s\n", settings.jsonPath.c_str());
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include "GraphicsData.h"
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// 比較用に残している、ObjLoader.cppに置き換える前のobj読み込み(getlineとistringstreamで1行ずつ読む)
+// 戻り値の形を今のModelDataに合わせた以外は元のまま。頂点はまとめずに三角形ごとに3つ並べ、インデックスは作らない
+// ベンチマーク以外では使わない
+
+inline MaterialData LegacyLoadMaterialTemplateFile(const std::string& directorypath, const std::string& filename) {
+
+	MaterialData materialData;//構築するMaterialData
+	std::string line;//ファイルから読んだ1行を格納するもの
+	std::ifstream file(directorypath + "/" + filename);//ファイルを開く
+	assert(file.is_open());//とりあえず開けなっかたら止める
+	while (std::getline(file, line)) {
+		std::string identifile;
+		std::stringstream s(line);
+		s >> identifile;
+
+		//identifierの応じた処理
+		if (identifile == "map_Kd") {
+
+			std::string textureFilename;
+			s >> textureFilename;
+			//連結してファイルパスにする
+			materialData.textureFilePath = directorypath + "/" + textureFilename;
+		}
+	}
+	return materialData;
+}
+
+
+inline ModelData LegacyLoadObjFile(const std::string& directoryPath, const std::string& filename) {
+	ModelData modelData;            //構築するModekData
+	std::vector<Vector4>positions;  //位置
+	std::vector<Vector3>normals;    //法線
+	std::vector<Vector2>texcoords;  //テクスチャ座標
+	std::string line;               //ファイルから読んだ1行を格納するもの
+
+	std::ifstream file(directoryPath + "/" + filename);  //fileを開く
+	assert(file.is_open());                               //開けなかったら止める
+
+	while (std::getline(file, line)) {
+		std::string identifier;
+		std::istringstream s(line);
+		s >> identifier;  //先頭の識別子を読む
+
+		if (identifier == "v") {
+			Vector4 position;
+			s >> position.x >> position.y >> position.z;
+			position.w = 1.0f;
+			position.x *= -1;
+			positions.push_back(position);
+		}
+		else if (identifier == "vt") {
+			Vector2 texcoord;
+			s >> texcoord.x >> texcoord.y;
+			texcoord.y = 1 - texcoord.y;
+			texcoords.push_back(texcoord);
+		}
+		else if (identifier == "vn") {
+			Vector3 normal;
+			s >> normal.x >> normal.y >> normal.z;
+			normal.x *= -1;
+			normals.push_back(normal);
+		}
+		else if (identifier == "f") {
+			VertexData triangle[3];
+			//面は三角形限定。その他は未対応
+			for (int32_t faceVertex = 0; faceVertex < 3; ++faceVertex) {
+				std::string vertexDefinition;
+				s >> vertexDefinition;
+				//頂点の要素へのIndexは「位置・UV・法線」で格納されているので、分解してIndexを取得する
+				std::istringstream v(vertexDefinition);
+				uint32_t elementIndices[3];
+				for (int32_t element = 0; element < 3; ++element) {
+					std::string index;
+					std::getline(v, index, '/');//区切りでインデックスを読んでいく
+					elementIndices[element] = std::stoi(index);
+				}
+				//要素へのIndexから、実際の要素の値を取得して、頂点を構築する
+				Vector4 position = positions[elementIndices[0] - 1];
+				Vector2 texcoord = texcoords[elementIndices[1] - 1];
+				Vector3 normal = normals[elementIndices[2] - 1];
+				// VertexData vertex = { position, texcoord, normal };
+				// modelData.vertices.push_back(vertex);
+				triangle[faceVertex] = { position, texcoord, normal };
+			}
+			//頂点を逆順で登録刷ることで、周り順を逆にする
+			modelData.vertices.push_back(triangle[2]);
+			modelData.vertices.push_back(triangle[1]);
+			modelData.vertices.push_back(triangle[0]);
+		}
+		else if (identifier == "mtllib") {
+			//materialTemlateLibraryファイルの名前を取得する
+			std::string materialFilename;
+			s >> materialFilename;
+			//基本的にobjファイルと同一階層にmtlは存在させるので、ディレクトリ名とファイル名を渡す
+			modelData.materials.push_back(LegacyLoadMaterialTemplateFile(directoryPath, materialFilename));
+		}
+	}
+	return modelData;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "BenchHarness.h"
+#include "DescriptorAllocator.h"
+#include "GpuHeapAllocator.h"
+#include "TlsfAllocator.h"
+#include "UploadRingAllocator.h"
+#include <random>
+
+// 4つのアロケータの確保・解放の速さを測る。確保と解放の1組を1要素として数える
+// 1回の呼び出しでbatchSize個を確保し、解放は偶数番目・奇数番目の順にして空きの結合を通す
+
+namespace {
+
+const uint64_t kBatchSizes[] = { 1024, 16384 };
+
+}
+
+int main(int argc, char** argv) {
+	BenchSettings settings = ParseBenchArguments(argc, argv);
+	std::vector<BenchResult> results;
+	auto run = [&](const std::string& name, const std::string& variant, uint64_t batchSize, auto&& body) {
+		results.push_back(RunBenchmark(settings, name, variant, batchSize, body));
+		PrintBenchResult(results.back());
+	};
+
+	for (uint64_t batchSize : kBatchSizes) {
+		std::mt19937 random(1);
+		std::vector<uint64_t> smallSizes(batchSize);
+		std::vector<uint64_t> largeSizes(batchSize);
+		std::vector<uint32_t> groups(batchSize);
+		for (size_t i = 0; i < batchSize; i++) {
+			smallSizes[i] = 16 + random() % 4096;
+			largeSizes[i] = 65536ull * (1 + random() % 64);
+			groups[i] = random() % 3;
+		}
+
+		//範囲が足りなくならない大きさにして、確保と解放そのものの時間だけを測る
+		TlsfAllocator tlsf(1ull << 40);
+		std::vector<TlsfAllocation> allocations(batchSize);
+		auto tlsfBody = [&](const std::vector<uint64_t>& sizes, uint64_t alignment) {
+			return [&, alignment] {
+				for (size_t i = 0; i < batchSize; i++) {
+					allocations[i] = tlsf.Allocate(sizes[i], alignment);
+				}
+				for (size_t i = 0; i < batchSize; i += 2) {
+					tlsf.Free(allocations[i]);
+				}
+				for (size_t i = 1; i < batchSize; i += 2) {
+					tlsf.Free(allocations[i]);
+				}
+				DoNotOptimize(allocations.data());
+			};
+		};
+		run("TlsfAllocator(16B-4KB)", "align16", batchSize, tlsfBody(smallSizes, 16));
+		run("TlsfAllocator(64KB-4MB)", "align64K", batchSize, tlsfBody(largeSizes, 65536));
+
+		GpuHeapAllocator heap(256ull << 20);
+		std::vector<GpuHeapAllocation> heapAllocations(batchSize);
+		run("GpuHeapAllocator(64KB-4MB)", "3groups", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				heapAllocations[i] = heap.Allocate(groups[i], largeSizes[i], 65536);
+			}
+			for (size_t i = 0; i < batchSize; i += 2) {
+				heap.Free(heapAllocations[i]);
+			}
+			for (size_t i = 1; i < batchSize; i += 2) {
+				heap.Free(heapAllocations[i]);
+			}
+			DoNotOptimize(heapAllocations.data());
+		});
+
+		//1フレーム分(batchSize個の定数バッファ)を切り出して、すぐに回収する
+		UploadRingAllocator ring(batchSize * kConstantBufferAlignment * 2);
+		uint64_t fenceValue = 0;
+		std::vector<uint64_t> offsets(batchSize);
+		run("UploadRingAllocator(112B)", "frame", batchSize, [&] {
+			ring.Reclaim(fenceValue);
+			for (size_t i = 0; i < batchSize; i++) {
+				offsets[i] = ring.Allocate(sizeof(float) * 28);
+			}
+			ring.FinishFrame(++fenceValue);
+			DoNotOptimize(offsets.data());
+		});
+
+		DescriptorAllocator descriptors(uint32_t(batchSize), 1024);
+		std::vector<DescriptorHandle> handles(batchSize);
+		run("DescriptorAllocator(persistent)", "frame", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				handles[i] = descriptors.AllocatePersistent();
+			}
+			for (const DescriptorHandle& handle : handles) {
+				descriptors.FreePersistent(handle);
+			}
+			descriptors.FinishFrame(++fenceValue);
+			descriptors.Reclaim(fenceValue);
+			DoNotOptimize(handles.data());
+		});
+	}
+
+	return FinishBenchmarks(settings, "allocator", results);
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "BenchHarness.h"
+#include "MyMath.h"
+#include <random>
+
+// MyMath.hの主要な関数をまとめて計測する
+// 同じソースをMYMATH_NO_SIMDあり(math_bench_scalar)となし(math_bench)でビルドし、SSE版とスカラー版を比べる
+
+namespace {
+
+#ifdef MYMATH_USE_SSE
+const char* kVariant = "sse";
+#else
+const char* kVariant = "scalar";
+#endif
+
+// 1フレームで扱うオブジェクト数を想定した大きさ(L1に収まる・L2に収まる・L2からあふれる)
+const uint64_t kBatchSizes[] = { 64, 1024, 16384 };
+
+struct MathInputs {
+	std::vector<Vector3> scales;
+	std::vector<Vector3> rotates;
+	std::vector<Vector3> translates;
+	std::vector<Vector3> points;
+	std::vector<Matrix4x4> matrices;
+	std::vector<Matrix4x4> rigidMatrices; //拡大縮小なし
+	std::vector<Quaternion> quaternions;  //rotatesと同じ回転
+};
+
+MathInputs MakeInputs(size_t count) {
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<float> scaleDist(0.5f, 2.0f);
+	std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> positionDist(-100.0f, 100.0f);
+	MathInputs inputs;
+	for (size_t i = 0; i < count; i++) {
+		inputs.scales.push_back({ scaleDist(random), scaleDist(random), scaleDist(random) });
+		inputs.rotates.push_back({ angleDist(random), angleDist(random), angleDist(random) });
+		inputs.translates.push_back({ positionDist(random), positionDist(random), positionDist(random) });
+		inputs.points.push_back({ positionDist(random), positionDist(random), positionDist(random) });
+		inputs.matrices.push_back(MakeAffineMatrix(inputs.scales.back(), inputs.rotates.back(), inputs.translates.back()));
+		inputs.quaternions.push_back(MakeRotateQuaternion(inputs.rotates.back()));
+		inputs.rigidMatrices.push_back(MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, inputs.rotates.back(), inputs.translates.back()));
+	}
+	return inputs;
+}
+
+}
+
+int main(int argc, char** argv) {
+	BenchSettings settings = ParseBenchArguments(argc, argv);
+	std::vector<BenchResult> results;
+	auto run = [&](const std::string& name, uint64_t batchSize, auto&& body) {
+		results.push_back(RunBenchmark(settings, name, kVariant, batchSize, body));
+		PrintBenchResult(results.back());
+	};
+
+	for (uint64_t batchSize : kBatchSizes) {
+		MathInputs inputs = MakeInputs(batchSize);
+		std::vector<Matrix4x4> matrixResults(batchSize);
+		std::vector<Vector3> vectorResults(batchSize);
+		std::vector<float> floatResults(batchSize);
+		const Matrix4x4 viewProjection = Multiply(
+			MakeLookAtMatrix({ 0.0f, 5.0f, -20.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }),
+			MakePerspectiveFovMatrix(0.45f, 16.0f / 9.0f, 0.1f, 1000.0f));
+
+		run("Multiply(Matrix4x4)", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = Multiply(inputs.matrices[i], viewProjection);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("Inverse(Matrix4x4)", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = Inverse(inputs.matrices[i]);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("InverseAffine", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = InverseAffine(inputs.matrices[i]);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("InverseRigid", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = InverseRigid(inputs.rigidMatrices[i]);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("MakeAffineMatrix", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = MakeAffineMatrix(inputs.scales[i], inputs.rotates[i], inputs.translates[i]);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("MakeAffineMatrixQuaternion", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = MakeAffineMatrixQuaternion(inputs.scales[i], inputs.quaternions[i], inputs.translates[i]);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("MakeRotateMatrix(Vector3)", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrixResults[i] = MakeRotateMatrix(inputs.rotates[i]);
+			}
+			DoNotOptimize(matrixResults.data());
+		});
+		run("Transform(Vector3,Matrix4x4)", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				vectorResults[i] = Transform(inputs.points[i], viewProjection);
+			}
+			DoNotOptimize(vectorResults.data());
+		});
+		run("Cross", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				vectorResults[i] = Cross(inputs.points[i], inputs.translates[i]);
+			}
+			DoNotOptimize(vectorResults.data());
+		});
+		run("Dot", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				floatResults[i] = Dot(inputs.points[i], inputs.translates[i]);
+			}
+			DoNotOptimize(floatResults.data());
+		});
+	}
+
+	return FinishBenchmarks(settings, std::string("math_") + kVariant, results);
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "BenchHarness.h"
+#include "LodSelection.h"
+#include "MeshletBuilder.h"
+#include "MyMath.h"
+#include "ProceduralMesh.h"
+#include <cstdio>
+
+// BuildMeshletsでメッシュレットを作る時間と、CullMeshletsの時間・残る三角形の割合をカメラの距離を変えて測る
+// 作る時間は三角形1つ、カリングはメッシュレット1つを1要素として数える
+// カメラは形の中心を向き、画面は1280x720・縦の画角0.45(ゲームと同じ)
+
+namespace {
+
+const float kDistances[] = { 2.0f, 4.0f, 8.0f, 16.0f, 32.0f, 64.0f };
+const float kQuickDistances[] = { 4.0f, 32.0f };
+
+struct ShapeEntry {
+	PrimitiveDesc desc;
+	const char* name;
+};
+
+}
+
+int main(int argc, char** argv) {
+	BenchSettings settings = ParseBenchArguments(argc, argv);
+	std::vector<BenchResult> results;
+
+	PrimitiveDesc sphere;
+	sphere.segments = settings.quick ? 64 : 512;
+	sphere.rings = sphere.segments / 2;
+	PrimitiveDesc torus;
+	torus.shape = PrimitiveShape::Torus;
+	torus.segments = settings.quick ? 64 : 512;
+	torus.rings = torus.segments / 4;
+	const ShapeEntry shapes[] = { { sphere, "UvSphere" }, { torus, "Torus" } };
+	std::span<const float> distances = settings.quick ? std::span<const float>(kQuickDistances) : std::span<const float>(kDistances);
+
+	for (const ShapeEntry& entry : shapes) {
+		ModelData model;
+		model.vertices.resize(GetPrimitiveVertexCount(entry.desc));
+		model.indices.resize(GetPrimitiveIndexCount(entry.desc));
+		GeneratePrimitive(entry.desc, model.vertices, model.indices);
+		model.submeshes = { { 0, static_cast<uint32_t>(model.indices.size()), 0 } };
+		const std::vector<uint32_t> sourceIndices = model.indices;
+		const uint64_t triangleCount = model.indices.size() / 3;
+		const std::string shapeName = std::string(entry.name) + "," + std::to_string(entry.desc.segments);
+
+		//毎回元の並びに戻してから作る(戻すコピーの時間も入る)
+		std::vector<Meshlet> meshlets;
+		results.push_back(RunBenchmark(settings, "BuildMeshlets(" + shapeName + ")", "triangle", triangleCount, [&] {
+			model.indices = sourceIndices;
+			meshlets = BuildMeshlets(model, model.submeshes);
+			DoNotOptimize(meshlets.data());
+		}));
+		PrintBenchResult(results.back());
+		std::printf("  %llu triangles -> %zu meshlets\n", static_cast<unsigned long long>(triangleCount), meshlets.size());
+
+		const float fovY = 0.45f;
+		const Matrix4x4 projection = MakePerspectiveFovMatrix(fovY, 1280.0f / 720.0f, 0.1f, 100.0f);
+		MeshletCullingView view = {};
+		view.world = MakeIdentity4x4();
+		view.pixelScale = ComputeLodPixelScale(1.0f, fovY, 720.0f);
+		std::vector<SubMesh> drawList;
+		MeshletCullingStatistics statistics = {};
+		for (float distance : distances) {
+			//真横から少し上にずらして、極の周りのメッシュレットも見えるようにする
+			view.cameraPosition = { 0.0f, distance * 0.3f, -distance };
+			view.viewProjection = Multiply(MakeLookAtMatrix(view.cameraPosition, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }), projection);
+			char name[96];
+			std::snprintf(name, sizeof(name), "CullMeshlets(%s,d=%g)", shapeName.c_str(), distance);
+			results.push_back(RunBenchmark(settings, name, "meshlet", meshlets.size(), [&] {
+				CullMeshlets(meshlets, view, drawList, &statistics);
+				DoNotOptimize(drawList.data());
+			}));
+			PrintBenchResult(results.back());
+			std::printf("  visible %llu / %llu triangles (%.1f%%), culled frustum %u backface %u small %u, %zu draws\n",
+				static_cast<unsigned long long>(statistics.visibleTriangleCount), static_cast<unsigned long long>(statistics.triangleCount),
+				100.0 * static_cast<double>(statistics.visibleTriangleCount) / static_cast<double>(statistics.triangleCount),
+				statistics.frustumCulled, statistics.backfaceCulled, statistics.smallCulled, drawList.size());
+		}
+	}
+
+	return FinishBenchmarks(settings, "meshlet", results);
+}
\ No newline at end of file
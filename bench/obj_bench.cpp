@@ -0,0 +1,107 @@
+#include "AllocationCounter.h"
+#include "BenchHarness.h"
+#include "LegacyObjLoader.h"
+#include "ObjBenchmark.h"
+#include "ObjLoader.h"
+#include "Parallel.h"
+#include <filesystem>
+
+// objの読み込みの速さ(MB/s)を、合成objファイルで測る
+// 1ファイルの読み込みを1要素として数え、ファイルサイズからMB/sを出す
+// LoadObjFileはスレッド数を変えて測る。ハードウェアスレッド数はJSONのsuite名に入れる
+// 各実装について1回だけ読み直し、読んでいる間の物理メモリ使用量の最大値とメモリ確保の回数も出す
+//   --dir <path>     合成objを置くディレクトリ(既定は一時ディレクトリ。同じ設定のファイルがあれば作り直さない)
+//   --sizes <list>   測るファイルの大きさ(既定は4M,32M。--quickでは1M)。「1M,256M,2G」のように書く
+
+namespace {
+
+const uint64_t kFileSizes[] = { 4ull << 20, 32ull << 20 };
+const uint64_t kQuickFileSizes[] = { 1ull << 20 };
+const uint32_t kThreadCounts[] = { 1, 2, 4, 8 };
+// 古い実装(istringstream)は20MB/s程度なので、これより大きいファイルでは測らない
+constexpr uint64_t kMaxLegacyBytes = 256ull << 20;
+
+std::string FormatSize(uint64_t bytes) {
+	if (bytes % (1ull << 30) == 0) {
+		return std::to_string(bytes >> 30) + "GB";
+	}
+	if (bytes % (1ull << 20) == 0) {
+		return std::to_string(bytes >> 20) + "MB";
+	}
+	return std::to_string(bytes >> 10) + "KB";
+}
+
+// bodyを1回呼んで、その間の物理メモリ使用量の最大値とメモリ確保の回数を出す
+template<typename Body>
+void PrintMemoryUsage(Body&& body) {
+	const bool reset = ResetPeakResidentBytes();
+	const uint64_t baseBytes = GetCurrentResidentBytes();
+	const uint64_t allocationsBefore = GetAllocationCount();
+	body();
+	const uint64_t allocations = GetAllocationCount() - allocationsBefore;
+	std::printf("  peakRSS %.1f MB (base %.1f MB%s), %llu allocations\n", GetPeakResidentBytes() / (1024.0 * 1024.0),
+		baseBytes / (1024.0 * 1024.0), reset ? "" : ", process", static_cast<unsigned long long>(allocations));
+}
+
+}
+
+int main(int argc, char** argv) {
+	BenchSettings settings = ParseBenchArguments(argc, argv);
+	std::string directoryPath = (std::filesystem::temp_directory_path() / "cg3_obj_bench").string();
+	std::vector<uint64_t> sizes;
+	if (settings.quick) {
+		sizes.assign(std::begin(kQuickFileSizes), std::end(kQuickFileSizes));
+	}
+	else {
+		sizes.assign(std::begin(kFileSizes), std::end(kFileSizes));
+	}
+	for (int i = 1; i + 1 < argc; i++) {
+		if (std::string(argv[i]) == "--dir") {
+			directoryPath = argv[i + 1];
+		}
+		else if (std::string(argv[i]) == "--sizes") {
+			sizes = ParseByteSizeList(argv[i + 1]);
+		}
+	}
+	std::filesystem::create_directories(directoryPath);
+
+	std::vector<BenchResult> results;
+	auto run = [&](const std::string& name, const std::string& variant, uint64_t fileBytes, auto&& body) {
+		results.push_back(RunBenchmark(settings, name, variant, 1, body));
+		PrintBenchResult(SetBytesPerOp(results.back(), static_cast<double>(fileBytes)));
+		PrintMemoryUsage(body);
+	};
+
+	//ピークのメモリ使用量を戻せない環境もあるので、小さいものから測る
+	std::sort(sizes.begin(), sizes.end());
+	for (uint64_t size : sizes) {
+		SyntheticObjSettings objSettings;
+		objSettings.targetBytes = size;
+		std::string filename;
+		if (!PrepareSyntheticObj(directoryPath, objSettings, filename)) {
+			std::fprintf(stderr, "failed to write %s/%s\n", directoryPath.c_str(), filename.c_str());
+			return 1;
+		}
+		const uint64_t fileBytes = std::filesystem::file_size(directoryPath + "/" + filename);
+		const std::string name = "LoadObj(" + FormatSize(size) + ")";
+
+		if (size <= kMaxLegacyBytes) {
+			run(name, "legacy", fileBytes, [&] {
+				ModelData model = LegacyLoadObjFile(directoryPath, filename);
+				DoNotOptimize(model.vertices.data());
+			});
+		}
+		//スレッド数による伸び。1区間は256KB以上なので、小さいファイルではスレッド数を増やしても区間は増えない
+		for (uint32_t threadCount : kThreadCounts) {
+			if (threadCount > 1 && settings.quick) {
+				break;
+			}
+			run(name, "threads=" + std::to_string(threadCount), fileBytes, [&] {
+				ModelData model = LoadObjFile(directoryPath, filename, threadCount);
+				DoNotOptimize(model.indices.data());
+			});
+		}
+	}
+
+	return FinishBenchmarks(settings, "obj_load_hw" + std::to_string(GetHardwareThreadCount()), results);
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "BenchHarness.h"
+#include "Parallel.h"
+#include "ProceduralMesh.h"
+#include <cstdio>
+
+// GeneratePrimitive(スレッドプールで段の帯ごとに並列に書く)で形を1つ作る時間を、分割数を変えて測る
+// 1回の生成を1要素として数え、書き出す頂点・インデックスのバイト数からMB/sを出す
+// ハードウェアスレッド数はJSONのsuite名に入れる
+
+namespace {
+
+// 分割数(segments)。緯度・高さ・管の周の分割数(rings)はその半分にする
+const uint32_t kSubdivisions[] = { 16, 64, 256, 1024, 4096 };
+const uint32_t kQuickSubdivisions[] = { 16, 64 };
+
+// 頂点・インデックスバッファの合計がこれを超える組み合わせは測らない(立方体・正二十面体の4096など)
+constexpr uint64_t kMaxBufferBytes = 1ull << 30;
+
+struct ShapeEntry {
+	PrimitiveShape shape;
+	const char* name;
+};
+
+const ShapeEntry kShapes[] = {
+	{ PrimitiveShape::UvSphere, "UvSphere" },
+	{ PrimitiveShape::Icosphere, "Icosphere" },
+	{ PrimitiveShape::Cube, "Cube" },
+	{ PrimitiveShape::Cylinder, "Cylinder" },
+	{ PrimitiveShape::Torus, "Torus" },
+	{ PrimitiveShape::Plane, "Plane" },
+};
+
+}
+
+int main(int argc, char** argv) {
+	BenchSettings settings = ParseBenchArguments(argc, argv);
+	std::vector<BenchResult> results;
+
+	std::span<const uint32_t> subdivisions = settings.quick ? std::span<const uint32_t>(kQuickSubdivisions) : std::span<const uint32_t>(kSubdivisions);
+	for (const ShapeEntry& entry : kShapes) {
+		for (uint32_t subdivision : subdivisions) {
+			PrimitiveDesc desc;
+			desc.shape = entry.shape;
+			desc.segments = subdivision;
+			desc.rings = subdivision / 2;
+			const std::string name = std::string("GeneratePrimitive(") + entry.name + "," + std::to_string(subdivision) + ")";
+			const uint64_t vertexCount = GetPrimitiveVertexCount(desc);
+			const uint64_t indexCount = GetPrimitiveIndexCount(desc);
+			const uint64_t bufferBytes = vertexCount * sizeof(VertexData) + indexCount * sizeof(uint32_t);
+			if (bufferBytes > kMaxBufferBytes) {
+				std::printf("%-36s skipped (%llu MB)\n", name.c_str(), static_cast<unsigned long long>(bufferBytes >> 20));
+				continue;
+			}
+
+			std::vector<VertexData> vertices(vertexCount);
+			std::vector<uint32_t> indices(indexCount);
+			results.push_back(RunBenchmark(settings, name, "pool", 1, [&] {
+				GeneratePrimitive(desc, vertices, indices);
+				DoNotOptimize(vertices.data());
+				DoNotOptimize(indices.data());
+			}));
+			PrintBenchResult(SetBytesPerOp(results.back(), static_cast<double>(bufferBytes)));
+		}
+	}
+
+	return FinishBenchmarks(settings, "primitive_hw" + std::to_string(GetHardwareThreadCount()), results);
+}
\ No newline at end of file
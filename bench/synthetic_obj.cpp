@@ -0,0 +1,85 @@
+#include "AllocationCounter.h"
+#include "BenchHarness.h"
+#include "ObjBenchmark.h"
+#include <chrono>
+#include <filesystem>
+
+// 合成objを作ってLoadObjFileで読み、大きさごとに速さ・物理メモリ使用量の最大値・メモリ確保の回数を出す
+// ゲームの外で動かすので、計測にゲームのテクスチャやヒープのメモリは混ざらない
+//   --sizes <list>          ファイルの大きさ(既定は1M,16M,64M。--quickでは256K)。「1M,256M,2G」のように書く
+//   --seed <n>              乱数の種(既定1)
+//   --shared-ratio <0~1>    頂点を共有するパッチの割合(既定0.75)
+//   --materials <n>         マテリアルの数。0ならmtlを書かない(既定4)
+//   --material-run <n>      usemtlを切り替える間隔(面の数。既定512)
+//   --group-faces <n>       o・gを書く間隔(面の数)。0なら書かない(既定4096)
+//   --comment-ratio <0~1>   コメント行を入れる割合(既定0.02)
+//   --dir <path>            書き出すディレクトリ(既定は一時ディレクトリ。同じ設定のファイルがあれば作り直さない)
+//   --threads <n>           LoadObjFileのスレッド数(既定0 = ハードウェアスレッド数)
+//   --iterations <n>        読む回数。一番速かった回を出す(既定3。--quickでは1)
+//   --generate-only         作るだけで読まない
+
+int main(int argc, char** argv) {
+	const BenchSettings benchSettings = ParseBenchArguments(argc, argv);
+	SyntheticObjSettings settings;
+	std::vector<uint64_t> sizes = benchSettings.quick ? std::vector<uint64_t>{ 256ull << 10 } : std::vector<uint64_t>{ 1ull << 20, 16ull << 20, 64ull << 20 };
+	std::string directoryPath = (std::filesystem::temp_directory_path() / "cg3_synthetic_obj").string();
+	uint32_t threadCount = 0;
+	uint32_t iterations = benchSettings.quick ? 1 : 3;
+	bool generateOnly = false;
+	for (int i = 1; i < argc; i++) {
+		const std::string option = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : "";
+		if (option == "--generate-only") {
+			generateOnly = true;
+			continue;
+		}
+		if (option == "--sizes") {
+			sizes = ParseByteSizeList(value);
+		} else if (option == "--seed") {
+			settings.seed = std::strtoull(value, nullptr, 10);
+		} else if (option == "--shared-ratio") {
+			settings.sharedVertexRatio = static_cast<float>(std::atof(value));
+		} else if (option == "--materials") {
+			settings.materialCount = static_cast<uint32_t>(std::atoi(value));
+		} else if (option == "--material-run") {
+			settings.facesPerMaterialRun = static_cast<uint32_t>(std::atoi(value));
+		} else if (option == "--group-faces") {
+			settings.facesPerGroup = static_cast<uint32_t>(std::atoi(value));
+		} else if (option == "--comment-ratio") {
+			settings.commentRatio = static_cast<float>(std::atof(value));
+		} else if (option == "--dir") {
+			directoryPath = value;
+		} else if (option == "--threads") {
+			threadCount = static_cast<uint32_t>(std::atoi(value));
+		} else if (option == "--iterations") {
+			iterations = static_cast<uint32_t>(std::max(1, std::atoi(value)));
+		} else {
+			continue;
+		}
+		i++;
+	}
+	if (sizes.empty()) {
+		std::fprintf(stderr, "no valid --sizes\n");
+		return 1;
+	}
+
+	//ピークのメモリ使用量を戻せない環境もあるので、小さいものから測る
+	std::sort(sizes.begin(), sizes.end());
+	for (uint64_t size : sizes) {
+		SyntheticObjSettings sizeSettings = settings;
+		sizeSettings.targetBytes = size;
+		const auto start = std::chrono::steady_clock::now();
+		std::string filename;
+		if (!PrepareSyntheticObj(directoryPath, sizeSettings, filename)) {
+			std::fprintf(stderr, "failed to write %s/%s\n", directoryPath.c_str(), filename.c_str());
+			return 1;
+		}
+		const double prepareMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%s/%s: prepared in %.1fms\n", directoryPath.c_str(), filename.c_str(), prepareMilliseconds);
+		if (!generateOnly) {
+			std::printf("%s", FormatObjLoadBenchmark(filename, BenchmarkObjLoad(directoryPath, filename, iterations, threadCount, GetAllocationCount)).c_str());
+		}
+		std::fflush(stdout);
+	}
+	return 0;
+}
\ No newline at end of file
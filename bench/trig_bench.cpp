@@ -0,0 +1,86 @@
+#include "BenchHarness.h"
+#include "MyMath.h"
+#include "ProceduralMesh.h"
+#include <random>
+
+// 標準ライブラリのsin/cos(trig_bench)と多項式近似(trig_bench_fast, MYMATH_FAST_TRIG)を比べる
+// sin/cosそのものに加えて、それを使う回転行列の作成と球の生成の速さも測る
+
+namespace {
+
+#ifdef MYMATH_FAST_TRIG
+const char* kVariant = "fast";
+#else
+const char* kVariant = "precise";
+#endif
+
+const uint64_t kBatchSizes[] = { 64, 1024, 16384 };
+
+// 球の分割数(経度, 緯度)。画面上の大きさで選ばれるLODの範囲
+const uint32_t kSphereSegments[][2] = { { 16, 8 }, { 64, 32 }, { 256, 128 } };
+
+}
+
+int main(int argc, char** argv) {
+	BenchSettings settings = ParseBenchArguments(argc, argv);
+	std::vector<BenchResult> results;
+	auto run = [&](const std::string& name, uint64_t batchSize, auto&& body) {
+		results.push_back(RunBenchmark(settings, name, kVariant, batchSize, body));
+		PrintBenchResult(results.back());
+	};
+
+	for (uint64_t batchSize : kBatchSizes) {
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> angleDist(-6.2831853f, 6.2831853f);
+		std::vector<float> angles(batchSize);
+		std::vector<Vector3> rotates(batchSize);
+		for (size_t i = 0; i < batchSize; i++) {
+			angles[i] = angleDist(random);
+			rotates[i] = { angleDist(random), angleDist(random), angleDist(random) };
+		}
+		std::vector<float> sinValues(batchSize);
+		std::vector<float> cosValues(batchSize);
+		std::vector<Matrix4x4> matrices(batchSize);
+		std::vector<Quaternion> quaternions(batchSize);
+
+		run("SinCos(float)", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				SinCos(angles[i], sinValues[i], cosValues[i]);
+			}
+			DoNotOptimize(sinValues.data());
+			DoNotOptimize(cosValues.data());
+		});
+		run("SinCos(span)", batchSize, [&] {
+			SinCos(angles, sinValues, cosValues);
+			DoNotOptimize(sinValues.data());
+			DoNotOptimize(cosValues.data());
+		});
+		run("MakeRotateMatrix(Vector3)", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				matrices[i] = MakeRotateMatrix(rotates[i]);
+			}
+			DoNotOptimize(matrices.data());
+		});
+		run("MakeRotateQuaternion", batchSize, [&] {
+			for (size_t i = 0; i < batchSize; i++) {
+				quaternions[i] = MakeRotateQuaternion(rotates[i]);
+			}
+			DoNotOptimize(quaternions.data());
+		});
+	}
+
+	// 球の生成は1頂点を1要素として数える
+	for (const auto& segments : kSphereSegments) {
+		uint32_t vertexCount = GetUvSphereVertexCount(segments[0], segments[1]);
+		std::vector<VertexData> vertices(vertexCount);
+		std::vector<uint32_t> indices(GetUvSphereIndexCount(segments[0], segments[1]));
+		std::string name = "GenerateUvSphere(" + std::to_string(segments[0]) + "x" + std::to_string(segments[1]) + ")";
+		run(name, vertexCount, [&] {
+			GenerateUvSphere(segments[0], segments[1], 1.0f, vertices, indices);
+			DoNotOptimize(vertices.data());
+			DoNotOptimize(indices.data());
+		});
+	}
+
+	return FinishBenchmarks(settings, std::string("trig_") + kVariant, results);
+}
\ No newline at end of file
@@ -12,6 +12,17 @@
 #include "Vector3.h"
 #include "Vector4.h"
 #include "MyMath.h"
+#include "GraphicsData.h"
+#include "MeshCache.h"
+#include "ObjLoader.h"
+#include "VertexPacking.h"
+#include "LodSelection.h"
+#include "MeshletBuilder.h"
+#include "AsyncModelLoader.h"
+#include "ProceduralMesh.h"
+#include "UploadRingAllocator.h"
+#include "DescriptorAllocator.h"
+#include "GpuHeapAllocator.h"
 #include "Matrix4x4.h"
 #include<vector>
 #include <numbers>
@@ -33,11 +44,124 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 #pragma comment(lib,"dxcompiler.lib")
 
 
-#pragma region Resource作成の関数化(CreateBufferResource)
-Microsoft::WRL::ComPtr<ID3D12Resource> CreateBufferResource(Microsoft::WRL::ComPtr<ID3D12Device> device, size_t sizeInBytes) {
-	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
-	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+#pragma region 配置リソース用のヒープ
+// 配置リソースを置くヒープのグループ。リソースヒープTier1では、バッファ・テクスチャ・RT/DSテクスチャを別々のヒープに置く
+// アラインメントはどれも64KB(MSAAのテクスチャは使わない)
+enum PlacedHeapGroup : uint32_t {
+	kPlacedHeapUploadBuffer,  //UPLOADヒープのバッファ
+	kPlacedHeapTexture,       //DEFAULTヒープの、RT/DSではないテクスチャ
+	kPlacedHeapDepthStencil,  //DEFAULTヒープの、RT/DSテクスチャ
+	kPlacedHeapGroupCount,
+};
+
+// 1つのヒープの大きさ。これより大きいResourceは、ちょうどの大きさの専用のヒープに置く
+constexpr uint64_t kPlacedHeapBlockSize = 64ull * 1024 * 1024;
+
+// 配置リソースの場所を決めるアロケータと、そのブロックごとのヒープ
+struct PlacedResourceHeaps {
+	GpuHeapAllocator allocator{ kPlacedHeapBlockSize };
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> heaps[kPlacedHeapGroupCount];
+	std::vector<GpuHeapAllocation> releasedAllocations;  //Resourceが破棄されたもの。GPUが使い終わってから返す
+};
+
+// PlacedAllocationOwnerをResourceにくっつけるときのGUID
+constexpr GUID kPlacedAllocationOwnerGuid = { 0x6fc78115, 0xe290, 0x4217, { 0x87, 0xf4, 0x61, 0x07, 0xfe, 0x59, 0x55, 0x20 } };
+
+/// <summary>
+/// 配置リソースにプライベートデータとしてくっつけておくオブジェクト
+/// Resourceが破棄されるとこれも破棄されるので、そのときに使っていた範囲をreleasedAllocationsに入れる
+/// </summary>
+class PlacedAllocationOwner : public IUnknown {
+public:
+	PlacedAllocationOwner(PlacedResourceHeaps& heaps, const GpuHeapAllocation& allocation)
+		: heaps_(heaps), allocation_(allocation) {}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+		if (riid == __uuidof(IUnknown)) {
+			*object = static_cast<IUnknown*>(this);
+			AddRef();
+			return S_OK;
+		}
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++referenceCount_; }
+	ULONG STDMETHODCALLTYPE Release() override {
+		const ULONG count = --referenceCount_;
+		if (count == 0) {
+			heaps_.releasedAllocations.push_back(allocation_);
+			delete this;
+		}
+		return count;
+	}
+
+private:
+	PlacedResourceHeaps& heaps_;
+	GpuHeapAllocation allocation_;
+	ULONG referenceCount_ = 1;
+};
+
+// descのResourceを、groupのヒープの中に配置して作る
+Microsoft::WRL::ComPtr<ID3D12Resource> CreatePlacedResource(Microsoft::WRL::ComPtr<ID3D12Device> device, PlacedResourceHeaps& heaps, PlacedHeapGroup group,
+	const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue) {
+	//必要な大きさとアラインメントはデバイスに聞く
+	const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = device->GetResourceAllocationInfo(0, 1, &desc);
+	assert(allocationInfo.Alignment <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	const GpuHeapAllocation allocation = heaps.allocator.Allocate(group, allocationInfo.SizeInBytes, allocationInfo.Alignment);
+
+	//新しいブロックならヒープを作る
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>>& groupHeaps = heaps.heaps[group];
+	if (groupHeaps.size() <= allocation.block) {
+		groupHeaps.resize(allocation.block + 1);
+	}
+	if (!groupHeaps[allocation.block]) {
+		D3D12_HEAP_DESC heapDesc{};
+		heapDesc.SizeInBytes = heaps.allocator.BlockSize(group, allocation.block);
+		heapDesc.Properties.Type = group == kPlacedHeapUploadBuffer ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT;
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = group == kPlacedHeapUploadBuffer ? D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+			: group == kPlacedHeapTexture ? D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES : D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+		HRESULT hr = device->CreateHeap(&heapDesc, IID_PPV_ARGS(&groupHeaps[allocation.block]));
+		assert(SUCCEEDED(hr));
+	}
 
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
+	HRESULT hr = device->CreatePlacedResource(
+		groupHeaps[allocation.block].Get(),
+		allocation.allocation.offset,
+		&desc,
+		initialState,
+		clearValue,
+		IID_PPV_ARGS(&resource));
+	assert(SUCCEEDED(hr));
+
+	//Resourceが破棄されたら範囲を返せるように、くっつけておく。参照はResourceが持つものだけにする
+	PlacedAllocationOwner* owner = new PlacedAllocationOwner(heaps, allocation);
+	resource->SetPrivateDataInterface(kPlacedAllocationOwnerGuid, owner);
+	owner->Release();
+	return resource;
+}
+
+// 破棄されたResourceの範囲を返し、空になったヒープを破棄する。GPUがそのResourceを使い終わってから呼ぶ
+void ReleasePlacedAllocations(PlacedResourceHeaps& heaps) {
+	for (const GpuHeapAllocation& allocation : heaps.releasedAllocations) {
+		heaps.allocator.Free(allocation);
+	}
+	heaps.releasedAllocations.clear();
+	std::vector<uint32_t> releasedBlocks;
+	for (uint32_t group = 0; group < kPlacedHeapGroupCount; ++group) {
+		releasedBlocks.clear();
+		heaps.allocator.ReleaseEmptyBlocks(group, releasedBlocks);
+		for (uint32_t block : releasedBlocks) {
+			heaps.heaps[group][block].Reset();
+		}
+	}
+}
+#pragma endregion
+
+
+#pragma region Resource作成の関数化(CreateBufferResource)
+Microsoft::WRL::ComPtr<ID3D12Resource> CreateBufferResource(Microsoft::WRL::ComPtr<ID3D12Device> device, PlacedResourceHeaps& heaps, size_t sizeInBytes) {
 	D3D12_RESOURCE_DESC vertexResourceDesc{};
 
 	vertexResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -50,20 +174,29 @@ Microsoft::WRL::ComPtr<ID3D12Resource> CreateBufferResource(Microsoft::WRL::ComP
 
 	vertexResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource = nullptr;
-	HRESULT hr = device->CreateCommittedResource(
-		&uploadHeapProperties,
-		D3D12_HEAP_FLAG_NONE,
-		&vertexResourceDesc,
+	//UPLOADヒープに置く
+	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource = CreatePlacedResource(
+		device, heaps, kPlacedHeapUploadBuffer,
+		vertexResourceDesc,
 		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&vertexResource));
-	assert(SUCCEEDED(hr));
+		nullptr);
 
 	return vertexResource;
 }
 #pragma endregion
 
+#pragma region 毎フレームの定数をアップロードリングに書く
+// dataをリングから切り出した場所に書き込んで、そのGPUアドレスを返す。CBVに使えるように256バイト境界にそろえる
+template<typename T>
+D3D12_GPU_VIRTUAL_ADDRESS PushUploadRing(UploadRingAllocator& allocator, ID3D12Resource* resource, uint8_t* mappedData, const T& data) {
+	const uint64_t offset = allocator.Allocate(sizeof(T));
+	//1フレームで書く量がリングに入りきらない
+	assert(offset != UploadRingAllocator::kInvalidOffset);
+	std::memcpy(mappedData + offset, &data, sizeof(T));
+	return resource->GetGPUVirtualAddress() + offset;
+}
+#pragma endregion
+
 #pragma region ウィンドウプロシージャ
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 	if (ImGui_ImplWin32_WndProcHandler(hwnd, msg, wparam, lparam)) {
@@ -218,7 +351,7 @@ DirectX::ScratchImage LoadTexture(const std::string& filePath) {
 
 #pragma region CreateTextureResource
 Microsoft::WRL::ComPtr<ID3D12Resource>
-CreateTextureResource(Microsoft::WRL::ComPtr<ID3D12Device> device, const DirectX::TexMetadata& metadata) {
+CreateTextureResource(Microsoft::WRL::ComPtr<ID3D12Device> device, PlacedResourceHeaps& heaps, const DirectX::TexMetadata& metadata) {
 
 	// metadataを基にResourceの設定
 	D3D12_RESOURCE_DESC resouceDesc{ };
@@ -230,22 +363,12 @@ CreateTextureResource(Microsoft::WRL::ComPtr<ID3D12Device> device, const DirectX
 	resouceDesc.SampleDesc.Count = 1;                                     // サンプリクト。１固定。
 	resouceDesc.Dimension = D3D12_RESOURCE_DIMENSION(metadata.dimension); // Textureの次元数。普段使っているのは２次元
 
-	// 利用するHeapの設定。非常に特殊な運用。
-	D3D12_HEAP_PROPERTIES heapProperties{};
-	heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;                        // 細かい設定を行う
-	//heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_BACK; // writeBackポリシーでCPUアクセス可能
-	//heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;          // プロセッサの近くに配置
-
-	// Resouceの作成
-	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
-	HRESULT hr = device->CreateCommittedResource(
-		&heapProperties,                   // Heapの設定
-		D3D12_HEAP_FLAG_NONE,              // Heapの特殊設定。特になし
-		&resouceDesc,                      // Resourceの設定
+	// Resouceの作成。DEFAULTヒープのテクスチャ用のヒープに置く
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = CreatePlacedResource(
+		device, heaps, kPlacedHeapTexture, // 置くヒープ
+		resouceDesc,                       // Resourceの設定
 		D3D12_RESOURCE_STATE_COPY_DEST,    // 初回のResourceState, Textureは基本読むだけ
-		nullptr,                           // Clear最適値。使わないのでnullptr
-		IID_PPV_ARGS(&resource));          // 作成するResourceポインタへのポインタ
-	assert(SUCCEEDED(hr));
+		nullptr);                          // Clear最適値。使わないのでnullptr
 	return resource;
 }
 #pragma endregion
@@ -253,13 +376,13 @@ CreateTextureResource(Microsoft::WRL::ComPtr<ID3D12Device> device, const DirectX
 #pragma region UploadTextureData関数
 [[nodiscard]]
 Microsoft::WRL::ComPtr<ID3D12Resource> UploadTextureData(Microsoft::WRL::ComPtr<ID3D12Resource>texture, const DirectX::ScratchImage& mipImages, Microsoft::WRL::ComPtr<ID3D12Device> device,
-	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList)
+	PlacedResourceHeaps& heaps, Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList)
 {
 	std::vector<D3D12_SUBRESOURCE_DATA> subresouces;
 	DirectX::PrepareUpload(device.Get(), mipImages.GetImages(), mipImages.GetImageCount(), mipImages.GetMetadata(), subresouces);
 	uint64_t intermediateSize = GetRequiredIntermediateSize(texture.Get(), 0, UINT(subresouces.size()));
 
-	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource = CreateBufferResource(device, intermediateSize);
+	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource = CreateBufferResource(device, heaps, intermediateSize);
 	UpdateSubresources(commandList.Get(), texture.Get(), intermediateResource.Get(), 0, 0, UINT(subresouces.size()), subresouces.data());
 
 	D3D12_RESOURCE_BARRIER barrier{};
@@ -275,7 +398,7 @@ Microsoft::WRL::ComPtr<ID3D12Resource> UploadTextureData(Microsoft::WRL::ComPtr<
 #pragma endregion  
 
 #pragma region DepthStencilTexture関数
-Microsoft::WRL::ComPtr<ID3D12Resource> CreateDepthStencilTexturResource(Microsoft::WRL::ComPtr<ID3D12Device> device, int32_t width, int32_t height) {
+Microsoft::WRL::ComPtr<ID3D12Resource> CreateDepthStencilTexturResource(Microsoft::WRL::ComPtr<ID3D12Device> device, PlacedResourceHeaps& heaps, int32_t width, int32_t height) {
 	D3D12_RESOURCE_DESC resourceDesc{};
 	resourceDesc.Width = width;//Textureの幅
 	resourceDesc.Height = height;//Textureの高さ
@@ -286,129 +409,21 @@ Microsoft::WRL::ComPtr<ID3D12Resource> CreateDepthStencilTexturResource(Microsof
 	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;//2次元
 	resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;//DepthSrencilとして使う通知
 
-	//利用するhepの設定
-	D3D12_HEAP_PROPERTIES heapProperties{  };
-	heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;//VRAM上に作る
 	//深度値のクリア設定
 	D3D12_CLEAR_VALUE depthClerValue{};
 	depthClerValue.DepthStencil.Depth = 1.0f;//最大値
 	depthClerValue.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;//フォーアット。Resource合わせる
-	//Resourceの生成
-	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
-	HRESULT hr = device->CreateCommittedResource(
-		&heapProperties,//Heapの設定
-		D3D12_HEAP_FLAG_NONE,//Heapの特殊設定。特になし
-		&resourceDesc,//Resourceの設定
+	//Resourceの生成。VRAM上の、RT/DSテクスチャ用のヒープに置く
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = CreatePlacedResource(
+		device, heaps, kPlacedHeapDepthStencil,//置くヒープ
+		resourceDesc,//Resourceの設定
 		D3D12_RESOURCE_STATE_DEPTH_WRITE,//深度値を書き込む状態のしておく
-		&depthClerValue,//Clear最適値
-		IID_PPV_ARGS(&resource));//作成するResourceポインタへのポインタ
-	assert(SUCCEEDED(hr));
+		&depthClerValue);//Clear最適値
 	return resource;
 }
 #pragma endregion 
 
 
-#pragma region MaterialData
-MaterialData LoadMaterialTemplateFile(const std::string& directorypath, const std::string& filename) {
-
-	MaterialData materialData;//構築するMaterialData
-	std::string line;//ファイルから読んだ1行を格納するもの
-	std::ifstream file(directorypath + "/" + filename);//ファイルを開く
-	assert(file.is_open());//とりあえず開けなっかたら止める
-	while (std::getline(file, line)) {
-		std::string identifile;
-		std::stringstream s(line);
-		s >> identifile;
-
-		//identifierの応じた処理
-		if (identifile == "map_Kd") {
-
-			std::string textureFilename;
-			s >> textureFilename;
-			//連結してファイルパスにする
-			materialData.textureFilePath = directorypath + "/" + textureFilename;
-		}
-	}
-	return materialData;
-}
-#pragma endregion
-
-
-#pragma region LoadObjeFil関数
-ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename) {
-	ModelData modelData;            //構築するModekData
-	std::vector<Vector4>positions;  //位置
-	std::vector<Vector3>normals;    //法線
-	std::vector<Vector2>texcoords;  //テクスチャ座標
-	std::string line;               //ファイルから読んだ1行を格納するもの
-
-	std::ifstream file(directoryPath + "/" + filename);  //fileを開く
-	assert(file.is_open());                               //開けなかったら止める
-
-	while (std::getline(file, line)) {
-		std::string identifier;
-		std::istringstream s(line);
-		s >> identifier;  //先頭の識別子を読む
-
-		if (identifier == "v") {
-			Vector4 position;
-			s >> position.x >> position.y >> position.z;
-			position.w = 1.0f;
-			position.x *= -1;
-			positions.push_back(position);
-		}
-		else if (identifier == "vt") {
-			Vector2 texcoord;
-			s >> texcoord.x >> texcoord.y;
-			texcoord.y = 1 - texcoord.y;
-			texcoords.push_back(texcoord);
-		}
-		else if (identifier == "vn") {
-			Vector3 normal;
-			s >> normal.x >> normal.y >> normal.z;
-			normal.x *= -1;
-			normals.push_back(normal);
-		}
-		else if (identifier == "f") {
-			VertexData triangle[3];
-			//面は三角形限定。その他は未対応
-			for (int32_t faceVertex = 0; faceVertex < 3; ++faceVertex) {
-				std::string vertexDefinition;
-				s >> vertexDefinition;
-				//頂点の要素へのIndexは「位置・UV・法線」で格納されているので、分解してIndexを取得する
-				std::istringstream v(vertexDefinition);
-				uint32_t elementIndices[3];
-				for (int32_t element = 0; element < 3; ++element) {
-					std::string index;
-					std::getline(v, index, '/');//区切りでインデックスを読んでいく
-					elementIndices[element] = std::stoi(index);
-				}
-				//要素へのIndexから、実際の要素の値を取得して、頂点を構築する
-				Vector4 position = positions[elementIndices[0] - 1];
-				Vector2 texcoord = texcoords[elementIndices[1] - 1];
-				Vector3 normal = normals[elementIndices[2] - 1];
-				// VertexData vertex = { position, texcoord, normal };
-				// modelData.vertices.push_back(vertex);
-				triangle[faceVertex] = { position, texcoord, normal };
-			}
-			//頂点を逆順で登録刷ることで、周り順を逆にする
-			modelData.vertices.push_back(triangle[2]);
-			modelData.vertices.push_back(triangle[1]);
-			modelData.vertices.push_back(triangle[0]);
-		}
-		else if (identifier == "mtllib") {
-			//materialTemlateLibraryファイルの名前を取得する
-			std::string materialFilename;
-			s >> materialFilename;
-			//基本的にobjファイルと同一階層にmtlは存在させるので、ディレクトリ名とファイル名を渡す
-			modelData.material = LoadMaterialTemplateFile(directoryPath, materialFilename);
-		}
-	}
-	return modelData;
-}
-#pragma endregion 
-
-
 struct D3DResourceLeakChecker {
 	~D3DResourceLeakChecker() {
 
@@ -453,6 +468,13 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 	CoInitializeEx(0, COINIT_MULTITHREADED);
 
+#pragma region Modelの非同期読み込みを始める
+	//objの読み込み(初回はキャッシュの作成も)は時間がかかるので、ウィンドウやデバイスを作っている間から別スレッドで進めておく
+	//読み終わったらメインループで受け取ってResourceを作る。それまでModelは描かない
+	AsyncModelLoader modelLoader;
+	ModelLoadHandle modelLoadHandle = modelLoader.Load("resources", "axis.obj");
+#pragma endregion
+
 #pragma region ウィンドウクラスの登録
 	WNDCLASS wc{};
 
@@ -547,6 +569,12 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	Log("Complete create D3D12Device!!!\n");
 #pragma endregion
 
+#pragma region 配置リソース用のヒープの準備
+	//バッファとテクスチャは大きなヒープの中に配置して作る。どこに置くかはplacedHeaps.allocatorで決める
+	//ここで作るResourceより先に破棄されないように、Resourceより前に置く
+	PlacedResourceHeaps placedHeaps;
+#pragma endregion
+
 #ifdef _DEBUG
 
 #pragma region エラー・警告時に停止
@@ -621,8 +649,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// ディスクリプタヒープの生成
 	// RTV用のヒープでディスクリプタの数は2。RTVはShader内で読むものではないので、ShaderVisibleはfalse
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> rtvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 2, false);
-	// SRV用のヒープでディスクリプタの数は128。SRVはShader内で読むものなので、ShaderVisibleはtrue
-	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> srvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 128, true);
+	// SRV用のヒープは常駐用4096個とフレームごとの一時用1024個。どこを使うかはsrvAllocatorで決める
+	// SRVはShader内で読むものなので、ShaderVisibleはtrue
+	DescriptorAllocator srvAllocator(4096, 1024);
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> srvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srvAllocator.Capacity(), true);
 	// DVS用のヒープでディスクリプタの数は1。DSVはShader内で触るものではないので、ShaderVisibleはfalse
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> dsvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 1, false);
 
@@ -768,6 +798,27 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
 	inputLayoutDesc.pInputElementDescs = inputElementDescs;
 	inputLayoutDesc.NumElements = _countof(inputElementDescs);
+
+	//Model用のInputLayout(PackedVertexData)。法線とUVはGPUがfloatに戻して渡してくれる
+	D3D12_INPUT_ELEMENT_DESC inputElementDescsPacked[3] = {};
+	inputElementDescsPacked[0].SemanticName = "POSITION";
+	inputElementDescsPacked[0].SemanticIndex = 0;
+	inputElementDescsPacked[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	inputElementDescsPacked[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+
+	inputElementDescsPacked[1].SemanticName = "NORMAL";
+	inputElementDescsPacked[1].SemanticIndex = 0;
+	inputElementDescsPacked[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	inputElementDescsPacked[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+
+	inputElementDescsPacked[2].SemanticName = "TEXCOORD";
+	inputElementDescsPacked[2].SemanticIndex = 0;
+	inputElementDescsPacked[2].Format = DXGI_FORMAT_R16G16_FLOAT;
+	inputElementDescsPacked[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+
+	D3D12_INPUT_LAYOUT_DESC inputLayoutDescPacked{};
+	inputLayoutDescPacked.pInputElementDescs = inputElementDescsPacked;
+	inputLayoutDescPacked.NumElements = _countof(inputElementDescsPacked);
 #pragma endregion
 
 #pragma region BlendStateの設定
@@ -792,6 +843,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	IDxcBlob* pixelShaderBlob = CompileShader(L"Object3d.PS.hlsl",
 		L"ps_6_0", dxcUtils, dxcCompiler, includeHandler);
 	assert(pixelShaderBlob != nullptr);
+
+	IDxcBlob* vertexShaderBlobPacked = CompileShader(L"Object3dPacked.VS.hlsl",
+		L"vs_6_0", dxcUtils, dxcCompiler, includeHandler);
+	assert(vertexShaderBlobPacked != nullptr);
 #pragma endregion
 
 #pragma region DepthStencilState
@@ -831,23 +886,37 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc,
 		IID_PPV_ARGS(&graphicsPipelineState));
 	assert(SUCCEEDED(hr));
+
+	// Model用。InputLayoutとVSだけ差し替える
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDescPacked = graphicsPipelineStateDesc;
+	graphicsPipelineStateDescPacked.InputLayout = inputLayoutDescPacked;
+	graphicsPipelineStateDescPacked.VS = { vertexShaderBlobPacked->GetBufferPointer(),
+	vertexShaderBlobPacked->GetBufferSize() };
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> graphicsPipelineStatePacked = nullptr;
+	hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDescPacked,
+		IID_PPV_ARGS(&graphicsPipelineStatePacked));
+	assert(SUCCEEDED(hr));
 #pragma endregion
 
 
 #pragma region Resource
 	const uint32_t kSubdivision = 512;
-	ModelData modelData = LoadObjFile("resources", "axis.obj");
 
 #pragma region VertexResourceを生成
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource = CreateBufferResource(device, sizeof(VertexData) * kSubdivision * kSubdivision * 6);
+	//球は格子点ごとに頂点を共有して、インデックスで描く
+	//分割数を半分ずつにした段(512~16)を1つのバッファに並べておき、画面上の大きさで選んで描く
+	const float w = 2.0f;
+	const std::vector<PrimitiveLodLevel> sphereLods = MakePrimitiveLodLevels({ PrimitiveShape::UvSphere, kSubdivision, kSubdivision, 0.0f, w }, 6);
+	const uint32_t sphereVertexCount = sphereLods.back().vertexStart + sphereLods.back().vertexCount;
+	const uint32_t sphereIndexCount = sphereLods.back().indexStart + sphereLods.back().indexCount;
+	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource = CreateBufferResource(device, placedHeaps, sizeof(VertexData) * sphereVertexCount);
+	Microsoft::WRL::ComPtr<ID3D12Resource> indexResource = CreateBufferResource(device, placedHeaps, sizeof(uint32_t) * sphereIndexCount);
 #pragma region DepthStencilTextureを作成
-	Microsoft::WRL::ComPtr<ID3D12Resource> depthStenciResource = CreateDepthStencilTexturResource(device, kClientWidth, kClientHeight);
+	Microsoft::WRL::ComPtr<ID3D12Resource> depthStenciResource = CreateDepthStencilTexturResource(device, placedHeaps, kClientWidth, kClientHeight);
 #pragma region VertexBufferResourceを生成
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResourceSprite = CreateBufferResource(device, sizeof(VertexData) * 4);
+	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResourceSprite = CreateBufferResource(device, placedHeaps, sizeof(VertexData) * 4);
 #pragma region IndexResourceを生成
-	Microsoft::WRL::ComPtr<ID3D12Resource> indexResourceSprite = CreateBufferResource(device, sizeof(uint32_t) * 6);
-#pragma region ModelResourceを生成
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResourceModel = CreateBufferResource(device, sizeof(VertexData) * modelData.vertices.size());
+	Microsoft::WRL::ComPtr<ID3D12Resource> indexResourceSprite = CreateBufferResource(device, placedHeaps, sizeof(uint32_t) * 6);
 #pragma endregion
 
 
@@ -860,106 +929,26 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 #pragma endregion
 
 
-#pragma region vetexResourceModel頂点バッファーを作成する
-	D3D12_VERTEX_BUFFER_VIEW VertexBufferViewModel{};
-	VertexBufferViewModel.BufferLocation = vertexResourceModel->GetGPUVirtualAddress();
-	VertexBufferViewModel.SizeInBytes = UINT(sizeof(VertexData) * modelData.vertices.size());
-	VertexBufferViewModel.StrideInBytes = sizeof(VertexData);
-	VertexData* vertexDataModel = nullptr;
-	vertexResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&vertexDataModel));
-	std::memcpy(vertexDataModel, modelData.vertices.data(), sizeof(VertexData) * modelData.vertices.size());
-
-
 #pragma region vertexResource頂点バッファーを作成
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferView{ };
 	vertexBufferView.BufferLocation = vertexResource->GetGPUVirtualAddress();
-	vertexBufferView.SizeInBytes = sizeof(VertexData) * kSubdivision * kSubdivision * 6;
+	vertexBufferView.SizeInBytes = sizeof(VertexData) * sphereVertexCount;
 	vertexBufferView.StrideInBytes = sizeof(VertexData);
 	VertexData* vertexData = nullptr;
 	vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
-	std::memcpy(vertexData, modelData.vertices.data(), sizeof(VertexData) * modelData.vertices.size());
+
+	D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+	indexBufferView.BufferLocation = indexResource->GetGPUVirtualAddress();
+	indexBufferView.SizeInBytes = sizeof(uint32_t) * sphereIndexCount;
+	indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+	uint32_t* indexData = nullptr;
+	indexResource->Map(0, nullptr, reinterpret_cast<void**>(&indexData));
 #pragma endregion
 
 
 #pragma region 基準点
-	//経度分割1つ分の経度φd
-	const float kLonEvery = 2 * std::numbers::pi_v<float> / (float)kSubdivision;
-	//緯度分割１つ分の緯度Θd
-	const float kLatEvery = std::numbers::pi_v<float> / (float)kSubdivision;
-	//緯度方向に分割しながら線を描く
-	const float w = 2.0f;
-	for (uint32_t latIndex = 0; latIndex < kSubdivision; ++latIndex) {
-		float lat = -std::numbers::pi_v<float> / 2.0f + kLatEvery * latIndex;//θ
-		for (uint32_t lonIndex = 0; lonIndex < kSubdivision; ++lonIndex) {
-			//テクスチャ用のTexcoord
-
-			//書き込む最初の場所
-			uint32_t start = (latIndex * kSubdivision + lonIndex) * 6;
-			float lon = lonIndex * kLonEvery;
-			//基準点a
-			vertexData[start].position.x = std::cosf(lat) * std::cosf(lon);
-			vertexData[start].position.y = std::sinf(lat);
-			vertexData[start].position.z = std::cosf(lat) * std::sinf(lon);
-			vertexData[start].position.w = w;
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-			vertexData[start].texcoord = { float(lonIndex) / float(kSubdivision), 1.0f - float(latIndex) / float(kSubdivision) };
-			//基準点b
-			start++;
-			vertexData[start].position.x = std::cosf(lat + kLatEvery) * std::cosf(lon);
-			vertexData[start].position.y = std::sinf(lat + kLatEvery);
-			vertexData[start].position.z = std::cosf(lat + kLatEvery) * std::sinf(lon);
-			vertexData[start].position.w = w;
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-			vertexData[start].texcoord = { float(lonIndex) / float(kSubdivision), 1.0f - float(latIndex + 1.0f) / float(kSubdivision) };
-			//基準点c
-			start++;
-			vertexData[start].position.x = std::cosf(lat) * std::cosf(lon + kLonEvery);
-			vertexData[start].position.y = std::sinf(lat);
-			vertexData[start].position.z = std::cosf(lat) * std::sinf(lon + kLonEvery);
-			vertexData[start].position.w = w;
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-			vertexData[start].texcoord = { float(lonIndex + 1.0f) / float(kSubdivision), 1.0f - float(latIndex) / float(kSubdivision) };
-
-			//基準点c
-			start++;
-			vertexData[start].position.x = std::cosf(lat) * std::cosf(lon + kLonEvery);
-			vertexData[start].position.y = std::sinf(lat);
-			vertexData[start].position.z = std::cosf(lat) * std::sinf(lon + kLonEvery);
-			vertexData[start].position.w = w;
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-			vertexData[start].texcoord = { float(lonIndex + 1.0f) / float(kSubdivision), 1.0f - float(latIndex) / float(kSubdivision) };
-
-			//基準点b
-			start++;
-			vertexData[start].position.x = std::cosf(lat + kLatEvery) * std::cosf(lon);
-			vertexData[start].position.y = std::sinf(lat + kLatEvery);
-			vertexData[start].position.z = std::cosf(lat + kLatEvery) * std::sinf(lon);
-			vertexData[start].position.w = w;
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-			vertexData[start].texcoord = { float(lonIndex) / float(kSubdivision), 1.0f - float(latIndex + 1.0f) / float(kSubdivision) };
-
-			//基準点d
-			start++;
-			vertexData[start].position.x = std::cosf(lat + kLatEvery) * std::cosf(lon + kLonEvery);
-			vertexData[start].position.y = std::sinf(lat + kLatEvery);
-			vertexData[start].position.z = std::cosf(lat + kLatEvery) * std::sinf(lon + kLonEvery);
-			vertexData[start].position.w = w;
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-			vertexData[start].texcoord = { float(lonIndex + 1) / float(kSubdivision), 1.0f - float(latIndex + 1) / float(kSubdivision) };
-		}
-	}
+	//緯度・経度で分けた球を、Mapしたバッファに直接書く
+	GeneratePrimitiveLods(sphereLods, std::span<VertexData>(vertexData, sphereVertexCount), std::span<uint32_t>(indexData, sphereIndexCount));
 #pragma endregion
 
 
@@ -1030,85 +1019,65 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 #pragma endregion
 
 
-#pragma region Material用のResourceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> materialResource = CreateBufferResource(device, sizeof(Material));
-	//マテリアルにデータを書き込む	
-	Material* materialDataSphere = nullptr;
-	materialResource->Map(0, nullptr, reinterpret_cast<void**>(&materialDataSphere));
-	//色
-	materialDataSphere->color = { Vector4(1.0f, 1.0f, 1.0f, 1.0f) };
-	materialDataSphere->enableLighting = true;
-	materialDataSphere->uvTransform = MakeIdentity4x4();
+#pragma region 定数用のアップロードリングを作る
+	//定数はオブジェクトごとにResourceを作らず、1つの大きなバッファから毎フレーム切り出して書く
+	//GPUが読み終わったフレームの分はフェンスの値を見て回収する
+	const uint64_t kUploadRingSize = 1024 * 1024;
+	Microsoft::WRL::ComPtr<ID3D12Resource> uploadRingResource = CreateBufferResource(device, placedHeaps, kUploadRingSize);
+	//破棄するまでMapしたままにしておく
+	uint8_t* uploadRingData = nullptr;
+	uploadRingResource->Map(0, nullptr, reinterpret_cast<void**>(&uploadRingData));
+	UploadRingAllocator uploadRing(kUploadRingSize);
 #pragma endregion
 
 
-#pragma region WVP用のResourceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> wvpResource = CreateBufferResource(device, sizeof(TransformationMatrix));
-	//データを書き込む
-	TransformationMatrix* wvpData = nullptr;
-	//書き込むためのアドレスを取得
-	wvpResource->Map(0, nullptr, reinterpret_cast<void**>(&wvpData));
-	//単位行列を書き込む
-	wvpData->WVP = MakeIdentity4x4();
-	wvpData->World = MakeIdentity4x4();
+#pragma region Materialのデータを作る
+	Material materialDataSphere{};
+	//色
+	materialDataSphere.color = { Vector4(1.0f, 1.0f, 1.0f, 1.0f) };
+	materialDataSphere.enableLighting = true;
+	materialDataSphere.uvTransform = ToMatrix2x4(MakeIdentity4x4());
 #pragma endregion
 
 
-#pragma region Model用のResourceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> materialResourceModel = CreateBufferResource(device, sizeof(Material));
-	//マテリアルにデータを書き込む	
-	Material* materialDataModel = nullptr;
-	materialResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&materialDataModel));
-	//色
-	materialDataModel->color = { Vector4(1.0f, 1.0f, 1.0f, 1.0f) };
-	materialDataModel->enableLighting = true;
-	materialDataModel->uvTransform = MakeIdentity4x4();
+#pragma region WVPのデータを作る
+	//単位行列を入れておく
+	TransformationMatrix wvpData{};
+	wvpData.WVP = MakeIdentity4x4();
+	wvpData.World = ToMatrix3x4(MakeIdentity4x4());
 #pragma endregion
 
 
-#pragma region ModelTransform用のResourceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> transformationMatrixResourceModel = CreateBufferResource(device, sizeof(TransformationMatrix));
-	//データを書き込む
-	TransformationMatrix* transformaitionMatrixDataModel = nullptr;
-	//書き込むためのアドレスを取得
-	transformationMatrixResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&transformaitionMatrixDataModel));
-	//単位行列を書き込む
-	transformaitionMatrixDataModel->WVP = MakeIdentity4x4();
-	transformaitionMatrixDataModel->World = MakeIdentity4x4();
+#pragma region ModelTransformのデータを作る
+	//単位行列を入れておく
+	TransformationMatrix transformaitionMatrixDataModel{};
+	transformaitionMatrixDataModel.WVP = MakeIdentity4x4();
+	transformaitionMatrixDataModel.World = ToMatrix3x4(MakeIdentity4x4());
 #pragma endregion
 
 
-#pragma region Sprite用のTransfomationMatrix用のResourceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> transformationMatrixResourceSprite = CreateBufferResource(device, sizeof(TransformationMatrix));
-	//データを書き込む
-	TransformationMatrix* transformationMatrixDataSprite = nullptr;
-	//書き込むためのアドレスを取得
-	transformationMatrixResourceSprite->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixDataSprite));
-	//単位行列を書き込んでおく
-	transformationMatrixDataSprite->WVP = MakeIdentity4x4();
-	transformationMatrixDataSprite->World = MakeIdentity4x4();
+#pragma region Sprite用のTransfomationMatrixのデータを作る
+	//単位行列を入れておく
+	TransformationMatrix transformationMatrixDataSprite{};
+	transformationMatrixDataSprite.WVP = MakeIdentity4x4();
+	transformationMatrixDataSprite.World = ToMatrix3x4(MakeIdentity4x4());
 #pragma endregion
 
 
-#pragma region Sprite用のmaterial用のResourceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> materialResourceSprite = CreateBufferResource(device, sizeof(Material));
-	//マテリアルにデータを書き込む	
-	Material* materialDataSprite = nullptr;
-	materialResourceSprite->Map(0, nullptr, reinterpret_cast<void**>(&materialDataSprite));
+#pragma region Sprite用のmaterialのデータを作る
+	Material materialDataSprite{};
 	//色
-	materialDataSprite->color = { Vector4(1.0f, 1.0f, 1.0f, 1.0f) };
-	materialDataSprite->enableLighting = false;
-	materialDataSprite->uvTransform = MakeIdentity4x4();
+	materialDataSprite.color = { Vector4(1.0f, 1.0f, 1.0f, 1.0f) };
+	materialDataSprite.enableLighting = false;
+	materialDataSprite.uvTransform = ToMatrix2x4(MakeIdentity4x4());
 #pragma endregion
 
 
-#pragma region 平行光源用のResoureceを作る
-	Microsoft::WRL::ComPtr<ID3D12Resource> directionalLightResource = CreateBufferResource(device, sizeof(DirectionalLight));
-	DirectionalLight* directionalLightData = nullptr;
-	directionalLightResource->Map(0, nullptr, reinterpret_cast<void**>(&directionalLightData));
-	directionalLightData->color = { 1.0f,1.0f,1.0f,1.0f };
-	directionalLightData->direction = { 0.0f,-1.0f,1.0f };
-	directionalLightData->intensity = 1.0f;
+#pragma region 平行光源のデータを作る
+	DirectionalLight directionalLightData{};
+	directionalLightData.color = { 1.0f,1.0f,1.0f,1.0f };
+	directionalLightData.direction = { 0.0f,-1.0f,1.0f };
+	directionalLightData.intensity = 1.0f;
 #pragma endregion
 
 
@@ -1117,20 +1086,15 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// Textureを読んで転送する
 	DirectX::ScratchImage mipImages = LoadTexture("Resources/uvChecker.png");
 	const DirectX::TexMetadata& metadata = mipImages.GetMetadata();
-	Microsoft::WRL::ComPtr<ID3D12Resource> textureResource = CreateTextureResource(device, metadata);
-	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource = UploadTextureData(textureResource, mipImages, device, commandList);
+	Microsoft::WRL::ComPtr<ID3D12Resource> textureResource = CreateTextureResource(device, placedHeaps, metadata);
+	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource = UploadTextureData(textureResource, mipImages, device, placedHeaps, commandList);
 
 	//Texture2を読んで転送する
 	DirectX::ScratchImage mipImages2 = LoadTexture("Resources/monsterBall.png");
 	const DirectX::TexMetadata& metadata2 = mipImages2.GetMetadata();
-	Microsoft::WRL::ComPtr<ID3D12Resource> textureResource2 = CreateTextureResource(device, metadata2);
-	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource2 = UploadTextureData(textureResource2, mipImages2, device, commandList);
-
-	//Textur3を読んで転送する
-	DirectX::ScratchImage mipImages3 = LoadTexture(modelData.material.textureFilePath);
-	const DirectX::TexMetadata& metadata3 = mipImages3.GetMetadata();
-	Microsoft::WRL::ComPtr<ID3D12Resource> textureResource3 = CreateTextureResource(device, metadata3);
-	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource3 = UploadTextureData(textureResource3, mipImages3, device, commandList);
+	Microsoft::WRL::ComPtr<ID3D12Resource> textureResource2 = CreateTextureResource(device, placedHeaps, metadata2);
+	Microsoft::WRL::ComPtr<ID3D12Resource> intermediateResource2 = UploadTextureData(textureResource2, mipImages2, device, placedHeaps, commandList);
+
 #pragma endregion 
 
 #pragma region ShaderResourceView
@@ -1146,29 +1110,20 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	srvDesc2.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;//2Dテクスチャ
 	srvDesc2.Texture2D.MipLevels = UINT(metadata2.mipLevels);
 
-	//meraDara3を気にSRVの設定
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc3{  };
-	srvDesc3.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc3.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;//2Dテクスチャ
-	srvDesc3.Texture2D.MipLevels = UINT(metadata3.mipLevels);
-
-	// SRVを作成するDescriptHeap	の場所を決める
-	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU = srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU = srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
+	// SRVを作成するDescriptHeapの場所を借りる。ImGuiのフォントの分もここで借りておく
+	const DescriptorHandle imguiSrv = srvAllocator.AllocatePersistent();
+	const DescriptorHandle textureSrv = srvAllocator.AllocatePersistent();
+	const DescriptorHandle textureSrv2 = srvAllocator.AllocatePersistent();
+	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvAllocator.Resolve(textureSrv));
+	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvAllocator.Resolve(textureSrv));
 
-	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU2 = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
-	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU2 = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
+	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU2 = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvAllocator.Resolve(textureSrv2));
+	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU2 = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvAllocator.Resolve(textureSrv2));
 
-	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU3 = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 3);
-	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU3 = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 3);
-
-	// 先頭はImGuiが使っているのでその次を使う
-	textureSrvHandleCPU.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	textureSrvHandleGPU.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	// SRVの設定
 	device->CreateShaderResourceView(textureResource.Get(), &srvDesc, textureSrvHandleCPU);
 	device->CreateShaderResourceView(textureResource2.Get(), &srvDesc2, textureSrvHandleCPU2);
-	device->CreateShaderResourceView(textureResource3.Get(), &srvDesc3, textureSrvHandleCPU3);
+
 #pragma endregion 
 
 
@@ -1186,8 +1141,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		swapChainDesc.BufferCount,
 		rtvDesc.Format,
 		srvDescriptorHeap.Get(),
-		srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-		srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+		GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvAllocator.Resolve(imguiSrv)),
+		GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvAllocator.Resolve(imguiSrv)));
 #pragma endregion
 
 #pragma region Transform変数
@@ -1204,8 +1159,34 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 #pragma region model変数
 	Transform transformModel = { {1.0f,1.0f,1.0f},{0.0f,0.0f,0.0f} ,{0.0f,0.0f,0.0f} };
+	//Modelのデータと、読み込みが終わってから作るResource
+	ModelData modelData;
+	Microsoft::WRL::ComPtr<ID3D12Resource> vertexResourceModel;
+	Microsoft::WRL::ComPtr<ID3D12Resource> indexResourceModel;
+	D3D12_VERTEX_BUFFER_VIEW VertexBufferViewModel{};
+	D3D12_INDEX_BUFFER_VIEW indexBufferViewModel{};
+	std::vector<Material> materialDataModel;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textureResourcesModel;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> intermediateResourcesModel;  //転送したフレームのGPUの完了まで持っておく
+	std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> textureSrvHandleGPUModel;
+	std::vector<DescriptorHandle> textureSrvModel;  //Modelのテクスチャに借りているSRVの場所
+	//ModelのLODごとの誤差と、今描いているLOD
+	std::vector<float> lodErrorsModel;
+	uint32_t lodModel = 0;
+	//メッシュレットのカリングで残った、Modelの描画範囲
+	std::vector<SubMesh> drawListModel;
+	MeshletCullingStatistics cullingStatisticsModel = {};
 #pragma endregion
 
+	//球のLODごとの誤差と、今描いているLOD
+	std::vector<float> lodErrorsSphere;
+	for (const PrimitiveLodLevel& level : sphereLods) {
+		lodErrorsSphere.push_back(level.error);
+	}
+	uint32_t lodSphere = 0;
+	//1フレームで描画に送った三角形の数(ImGuiには前のフレームの値を出す)
+	uint64_t trianglesSubmitted = 0;
+
 	bool useMonsterBall = false;
 	while (msg.message != WM_QUIT) {
 		if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
@@ -1214,46 +1195,177 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		}
 		else {
 			//ゲームの処理
+#pragma region 読み込みが終わったModelのResourceを作る
+			//前のフレームのGPUの処理は終わっているので、ここでResourceを作り直してもよい
+			LoadedModel loadedModel;
+			if (modelLoader.TryPopCompleted(loadedModel) && !loadedModel.cancelled) {
+				modelData = std::move(loadedModel.modelData);
+				const MeshLoadInfo& modelLoadInfo = loadedModel.info;
+				//キャッシュから読んだときは、objから読んだとき(cold)と今回(warm)の時間を並べて出す
+				if (modelLoadInfo.fromCache) {
+					Log(std::format("Load Model {}: cold {:.3f}ms / warm {:.3f}ms (cache)\n", loadedModel.filename, modelLoadInfo.cookMilliseconds, modelLoadInfo.loadMilliseconds));
+				}
+				else {
+					Log(std::format("Load Model {}: cold {:.3f}ms (cooked)\n", loadedModel.filename, modelLoadInfo.loadMilliseconds));
+				}
+				//キャッシュを作ったときのOptimizeMeshの効果(最適化前→後)
+				const MeshOptimizationReport& optimization = modelLoadInfo.optimization;
+				Log(std::format("  VertexCache: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}\n",
+					optimization.vertexCacheBefore.acmr, optimization.vertexCacheAfter.acmr, optimization.vertexCacheBefore.atvr, optimization.vertexCacheAfter.atvr));
+				Log(std::format("  Overdraw: {:.3f} -> {:.3f}\n", optimization.overdrawBefore.overdraw, optimization.overdrawAfter.overdraw));
+				Log(std::format("  Closed: {} (meshlet backface culling {})\n", modelData.closed, modelData.closed ? "on" : "off"));
+				for (size_t i = 0; i < modelData.lods.size(); ++i) {
+					Log(std::format("  LOD{}: {} triangles, error {:.5f}\n", i, modelData.lods[i].triangleCount, modelData.lods[i].error));
+				}
+
+				//Modelは圧縮した頂点(36byte→20byte)で送る
+				std::vector<PackedVertexData> packedVerticesModel = PackVertices(modelData.vertices);
+				vertexResourceModel = CreateBufferResource(device, placedHeaps, sizeof(PackedVertexData) * packedVerticesModel.size());
+				VertexBufferViewModel.BufferLocation = vertexResourceModel->GetGPUVirtualAddress();
+				VertexBufferViewModel.SizeInBytes = UINT(sizeof(PackedVertexData) * packedVerticesModel.size());
+				VertexBufferViewModel.StrideInBytes = sizeof(PackedVertexData);
+				PackedVertexData* vertexDataModel = nullptr;
+				vertexResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&vertexDataModel));
+				std::memcpy(vertexDataModel, packedVerticesModel.data(), sizeof(PackedVertexData) * packedVerticesModel.size());
+
+				//頂点数が16bitで表せるならインデックスも16bitにして半分のサイズにする
+				const bool useIndex16Model = modelData.vertices.size() <= 0x10000;
+				const size_t indexSizeModel = useIndex16Model ? sizeof(uint16_t) : sizeof(uint32_t);
+				indexResourceModel = CreateBufferResource(device, placedHeaps, indexSizeModel * modelData.indices.size());
+				indexBufferViewModel.BufferLocation = indexResourceModel->GetGPUVirtualAddress();
+				indexBufferViewModel.SizeInBytes = UINT(indexSizeModel * modelData.indices.size());
+				indexBufferViewModel.Format = useIndex16Model ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+				void* indexDataModel = nullptr;
+				indexResourceModel->Map(0, nullptr, &indexDataModel);
+				if (useIndex16Model) {
+					uint16_t* indexDataModel16 = static_cast<uint16_t*>(indexDataModel);
+					for (size_t i = 0; i < modelData.indices.size(); ++i) {
+						indexDataModel16[i] = static_cast<uint16_t>(modelData.indices[i]);
+					}
+				}
+				else {
+					std::memcpy(indexDataModel, modelData.indices.data(), sizeof(uint32_t) * modelData.indices.size());
+				}
+
+				//mtlのマテリアルごとにマテリアルのデータを作る。描くときにアップロードリングに書く
+				materialDataModel.clear();
+				for (const MaterialData& material : modelData.materials) {
+					Material& materialModel = materialDataModel.emplace_back();
+					//色はmtlのKdとd
+					materialModel.color = material.color;
+					materialModel.enableLighting = true;
+					materialModel.uvTransform = ToMatrix2x4(MakeIdentity4x4());
+				}
+
+				//マテリアルごとのテクスチャを読んで、このフレームのコマンドリストで転送する。map_Kdがないマテリアルは作らない
+				//SRVはsrvAllocatorから借りる。テクスチャがないマテリアルと、場所を借りられなかったマテリアルはuvCheckerを使う
+				//前のModelのSRVの場所は、GPUが使い終わってから再利用される
+				for (const DescriptorHandle& srv : textureSrvModel) {
+					srvAllocator.FreePersistent(srv);
+				}
+				textureSrvModel.clear();
+				textureResourcesModel.assign(modelData.materials.size(), nullptr);
+				intermediateResourcesModel.assign(modelData.materials.size(), nullptr);
+				textureSrvHandleGPUModel.assign(modelData.materials.size(), textureSrvHandleGPU);
+				for (size_t i = 0; i < modelData.materials.size(); ++i) {
+					if (modelData.materials[i].textureFilePath.empty()) {
+						continue;
+					}
+					const DescriptorHandle srv = srvAllocator.AllocatePersistent();
+					if (!srvAllocator.IsAlive(srv)) {
+						Log(std::format("SRV heap is full ({} slots): {}\n", srvAllocator.PersistentCapacity(), modelData.materials[i].textureFilePath));
+						continue;
+					}
+					textureSrvModel.push_back(srv);
+					DirectX::ScratchImage mipImagesModel = LoadTexture(modelData.materials[i].textureFilePath);
+					const DirectX::TexMetadata& metadataModel = mipImagesModel.GetMetadata();
+					textureResourcesModel[i] = CreateTextureResource(device, placedHeaps, metadataModel);
+					intermediateResourcesModel[i] = UploadTextureData(textureResourcesModel[i], mipImagesModel, device, placedHeaps, commandList);
+
+					D3D12_SHADER_RESOURCE_VIEW_DESC srvDescModel{  };
+					srvDescModel.Format = textureResourcesModel[i]->GetDesc().Format;
+					srvDescModel.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+					srvDescModel.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;//2Dテクスチャ
+					srvDescModel.Texture2D.MipLevels = UINT(metadataModel.mipLevels);
+					const uint32_t srvIndex = srvAllocator.Resolve(srv);
+					device->CreateShaderResourceView(textureResourcesModel[i].Get(), &srvDescModel, GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvIndex));
+					textureSrvHandleGPUModel[i] = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvIndex);
+				}
+
+				lodErrorsModel.clear();
+				for (const MeshLod& lod : modelData.lods) {
+					lodErrorsModel.push_back(lod.error);
+				}
+				lodModel = 0;
+			}
+#pragma endregion
+
 #pragma region Transformを使ってCBufferを更新する
 			transform.rotate.y += 0.03f;
 			Matrix4x4 worldMatrix = MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
-			Matrix4x4 cameraMatrix = MakeAffineMatrix(cameraTransform.scale, cameraTransform.rotate, cameraTransform.translate);
-			Matrix4x4 viewMatrix = Inverse(cameraMatrix);
-			Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f, float(kClientWidth) / float(kClientHeight), 0.1f, 100.0f);
+			// カメラは拡縮しないので、逆行列を求めずにビュー行列を直接作る
+			Matrix4x4 viewMatrix = MakeViewMatrix(cameraTransform.rotate, cameraTransform.translate);
+			const float fovY = 0.45f;
+			Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(fovY, float(kClientWidth) / float(kClientHeight), 0.1f, 100.0f);
 			Matrix4x4 worldViewProjectionMatrix = Multiply(worldMatrix, Multiply(viewMatrix, projectionMatrix));
-			wvpData->WVP = worldViewProjectionMatrix;
-			wvpData->World = worldMatrix;
+			wvpData.WVP = worldViewProjectionMatrix;
+			wvpData.World = ToMatrix3x4(worldMatrix);
+
+			//球の誤差が画面上で1ピクセル以下になる一番粗い段を選ぶ。wが2なので実際の半径は1/w
+			const Vector3 cameraToSphere = Subtract(transform.translate, cameraTransform.translate);
+			const float sphereScale = (std::max)({ std::abs(transform.scale.x), std::abs(transform.scale.y), std::abs(transform.scale.z) }) / w;
+			const float pixelScaleSphere = ComputeLodPixelScale(std::sqrt(Dot(cameraToSphere, cameraToSphere)), fovY, float(kClientHeight)) * sphereScale;
+			lodSphere = SelectLod(lodErrorsSphere, pixelScaleSphere, lodSphere);
 #pragma endregion
 
 
 			Matrix4x4 worldMatrixmodel = MakeAffineMatrix(transformModel.scale, transformModel.rotate, transformModel.translate);
 			Matrix4x4 worldViewProjectionMatrixModel = Multiply(worldMatrixmodel, Multiply(viewMatrix, projectionMatrix));
-			transformaitionMatrixDataModel->WVP = worldViewProjectionMatrixModel;
-			transformaitionMatrixDataModel->World = worldMatrixmodel;
+			transformaitionMatrixDataModel.WVP = worldViewProjectionMatrixModel;
+			transformaitionMatrixDataModel.World = ToMatrix3x4(worldMatrixmodel);
+
+			//カメラからの距離で、誤差が画面上で1ピクセル以下になる一番粗いLODを選ぶ
+			const Vector3 cameraToModel = Subtract(transformModel.translate, cameraTransform.translate);
+			const float modelScale = (std::max)({ std::abs(transformModel.scale.x), std::abs(transformModel.scale.y), std::abs(transformModel.scale.z) });
+			const float pixelScaleModel = ComputeLodPixelScale(std::sqrt(Dot(cameraToModel, cameraToModel)), fovY, float(kClientHeight)) * modelScale;
+			lodModel = SelectLod(lodErrorsModel, pixelScaleModel, lodModel);
+
+			//選んだLODのメッシュレットのうち、見えるものだけを描く
+			if (!modelData.lods.empty() && !modelData.lods[lodModel].meshlets.empty()) {
+				MeshletCullingView cullingViewModel = {};
+				cullingViewModel.world = worldMatrixmodel;
+				cullingViewModel.viewProjection = Multiply(viewMatrix, projectionMatrix);
+				cullingViewModel.cameraPosition = cameraTransform.translate;
+				cullingViewModel.pixelScale = ComputeLodPixelScale(1.0f, fovY, float(kClientHeight));
+				//PSOは両面を描く(D3D12_CULL_MODE_NONE)ので、裏が見えることのある開いたメッシュでは裏向きのメッシュレットを捨てない
+				cullingViewModel.cullBackfaces = modelData.closed;
+				CullMeshlets(modelData.lods[lodModel].meshlets, cullingViewModel, drawListModel, &cullingStatisticsModel);
+			}
+			else {
+				drawListModel = modelData.lods.empty() ? modelData.submeshes : modelData.lods[lodModel].submeshes;
+			}
 
 
 #pragma region WVPMatrixを作って書き込む
 			Matrix4x4 worldMatrixSprite = MakeAffineMatrix(transformSprite.scale, transformSprite.rotate, transformSprite.translate);
-			Matrix4x4 viewMatrixSprite = MakeIdentity4x4();
-			Matrix4x4 projectionMatrixSprite = MakeOrthographicMatrix(0.0f, 0.0f, float(kClientWidth), float(kClientHeight), 0.0f, 100.0f);
-			Matrix4x4 worldViewProjectionMatrixSprite = Multiply(worldMatrixSprite, Multiply(viewMatrixSprite, projectionMatrixSprite));
-			transformationMatrixDataSprite->WVP = worldViewProjectionMatrixSprite;
-			transformationMatrixDataSprite->World = worldMatrix;
+			// スプライトのビュー・プロジェクション行列は定数なのでコンパイル時に計算しておく
+			constexpr Matrix4x4 viewProjectionMatrixSprite = Multiply(MakeIdentity4x4(), MakeOrthographicMatrix(0.0f, 0.0f, float(kClientWidth), float(kClientHeight), 0.0f, 100.0f));
+			Matrix4x4 worldViewProjectionMatrixSprite = Multiply(worldMatrixSprite, viewProjectionMatrixSprite);
+			transformationMatrixDataSprite.WVP = worldViewProjectionMatrixSprite;
+			transformationMatrixDataSprite.World = ToMatrix3x4(worldMatrix);
 #pragma endregion
 
-			Matrix4x4 uvTransformMatrix = MakeScaleMatrix(uvTransformSprite.scale);
-			uvTransformMatrix = Multiply(uvTransformMatrix, MakeRotateZMatrix(uvTransformSprite.rotate.z));
-			uvTransformMatrix = Multiply(uvTransformMatrix, MakeTranslateMatrix(uvTransformSprite.translate));
-			materialDataSprite->uvTransform = uvTransformMatrix;
+			materialDataSprite.uvTransform = MakeUVTransformMatrix(uvTransformSprite.scale, uvTransformSprite.rotate.z, uvTransformSprite.translate);
 
 			ImGui_ImplDX12_NewFrame();
 			ImGui_ImplWin32_NewFrame();
 			ImGui::NewFrame();
 			ImGui::Begin("Settings");
+			ImGui::Text("Triangles submitted %llu", static_cast<unsigned long long>(trianglesSubmitted));
 
 			// Color Edit ウィンドウ
 			if (ImGui::CollapsingHeader("SetColor")) {
-				ImGui::ColorEdit4("materialData", &materialDataSphere->color.x);
+				ImGui::ColorEdit4("materialData", &materialDataSphere.color.x);
 			}
 			ImGui::Separator();
 
@@ -1265,8 +1377,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 			// Lighting
 			if (ImGui::CollapsingHeader("Lighting")) {
-				ImGui::ColorEdit4("LightSetColor", &directionalLightData->color.x);
-				ImGui::DragFloat3("Lightdirection", &directionalLightData->direction.x, 0.01f, -1.0f, 1.0f);
+				ImGui::ColorEdit4("LightSetColor", &directionalLightData.color.x);
+				ImGui::DragFloat3("Lightdirection", &directionalLightData.direction.x, 0.01f, -1.0f, 1.0f);
 			}
 			ImGui::Separator();
 
@@ -1275,6 +1387,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 				ImGui::DragFloat3("Translation", &transform.translate.x, 0.01f);
 				ImGui::DragFloat3("Rotation", &transform.rotate.x, 0.01f);
 				ImGui::DragFloat2("Scale", &transform.scale.x, 0.01f);
+				ImGui::Text("LOD %u / %zu  subdivision %u  triangles %u", lodSphere, sphereLods.size() - 1,
+					sphereLods[lodSphere].desc.segments, sphereLods[lodSphere].indexCount / 3);
 				if (ImGui::Button("Reset Transform")) {
 					transform = { {1.0f, 1.0f, 1.0f}, {0.0f, -1.5f, 0.0f}, {0.0f, 0.0f, 0.0f} };
 				}
@@ -1287,6 +1401,23 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 				ImGui::DragFloat3("ModelTransrate", &transformModel.translate.x, 0.01f);
 				ImGui::DragFloat3("ModelRotate", &transformModel.rotate.x, 0.01f);
 				ImGui::DragFloat3("ModelScale", &transformModel.scale.x, 0.01f);
+				//読み込み中は進み具合を出す。中断したら描かないまま
+				if (modelLoadHandle.IsValid() && !modelLoadHandle.IsDone()) {
+					ImGui::ProgressBar(modelLoadHandle.Progress());
+					ImGui::Text("Loading %llu / %llu bytes  %llu faces", static_cast<unsigned long long>(modelLoadHandle.BytesParsed()),
+						static_cast<unsigned long long>(modelLoadHandle.BytesTotal()), static_cast<unsigned long long>(modelLoadHandle.FacesParsed()));
+					if (ImGui::Button("Cancel Load")) {
+						modelLoadHandle.Cancel();
+					}
+				}
+				if (!modelData.lods.empty()) {
+					const MeshLod& lod = modelData.lods[lodModel];
+					ImGui::Text("LOD %u / %zu  triangles %u  error %.5f", lodModel, modelData.lods.size() - 1, lod.triangleCount, lod.error);
+					ImGui::Text("Meshlets %u  culled: frustum %u / back %u / small %u", cullingStatisticsModel.meshletCount,
+						cullingStatisticsModel.frustumCulled, cullingStatisticsModel.backfaceCulled, cullingStatisticsModel.smallCulled);
+					ImGui::Text("Triangles drawn %llu / %llu", static_cast<unsigned long long>(cullingStatisticsModel.visibleTriangleCount),
+						static_cast<unsigned long long>(cullingStatisticsModel.triangleCount));
+				}
 				if (ImGui::Button("Reset Transform")) {
 					transformModel = { {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f} };
 				}
@@ -1312,12 +1443,32 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			}
 			ImGui::Separator();
 
+			// 配置リソース用のヒープの使い方
+			if (ImGui::CollapsingHeader("GpuMemory")) {
+				const char* groupNames[kPlacedHeapGroupCount] = { "UploadBuffer", "Texture", "DepthStencil" };
+				for (uint32_t group = 0; group < kPlacedHeapGroupCount; ++group) {
+					const GpuHeapStatistics heapStatistics = placedHeaps.allocator.GetStatistics(group);
+					ImGui::Text("%s: %u heaps, %.1f / %.1f MB, %u resources", groupNames[group], heapStatistics.blockCount,
+						heapStatistics.usedBytes / (1024.0 * 1024.0), heapStatistics.capacity / (1024.0 * 1024.0), heapStatistics.allocationCount);
+					ImGui::Text("  free blocks %u, largest %.1f MB, fragmentation %.2f", heapStatistics.freeBlockCount,
+						heapStatistics.largestFreeBlock / (1024.0 * 1024.0), heapStatistics.fragmentation);
+				}
+			}
+			ImGui::Separator();
+
+
 
 			ImGui::End();
 			ImGui::Render();
 
 #pragma region コマンドを積み込み確定させる
 			UINT backBufferIndex = swapChain->GetCurrentBackBufferIndex();
+			trianglesSubmitted = 0;
+			//GPUが読み終わったフレームの定数とSRVの場所を回収する
+			uploadRing.Reclaim(fence->GetCompletedValue());
+			srvAllocator.Reclaim(fence->GetCompletedValue());
+			//平行光源はどの描画でも同じものを使う
+			const D3D12_GPU_VIRTUAL_ADDRESS directionalLightAddress = PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, directionalLightData);
 #pragma region TransitionBarrierを貼る
 			D3D12_RESOURCE_BARRIER barrier{};
 			//今回のバリアはTransition
@@ -1355,43 +1506,62 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 #pragma region スフィアの描画
 			commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+			commandList->IASetIndexBuffer(&indexBufferView);
 			//現状を設定。POSに設定しているものとはまた別。おなじ物を設定すると考えておけばいい
 			commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-			commandList->SetGraphicsRootConstantBufferView(0, materialResource->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(0, PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, materialDataSphere));
 			//wvp用のCBufferの場所を設定
-			commandList->SetGraphicsRootConstantBufferView(1, wvpResource->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(1, PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, wvpData));
 			commandList->SetGraphicsRootDescriptorTable(2, useMonsterBall ? textureSrvHandleGPU2 : textureSrvHandleGPU);
-			commandList->SetGraphicsRootConstantBufferView(3, directionalLightResource->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(3, directionalLightAddress);
 			//描画！
-			commandList->DrawInstanced(kSubdivision * kSubdivision * 6, 1, 0, 0);
+			const PrimitiveLodLevel& sphereLod = sphereLods[lodSphere];
+			commandList->DrawIndexedInstanced(sphereLod.indexCount, 1, sphereLod.indexStart, sphereLod.vertexStart, 0);
+			trianglesSubmitted += sphereLod.indexCount / 3;
 #pragma endregion
 
 
 #pragma region Spriteの描画
 			commandList->IASetVertexBuffers(0, 1, &vertexBufferViewSprite);
 			commandList->IASetIndexBuffer(&indexBufferViewSprite);
-			commandList->SetGraphicsRootConstantBufferView(0, materialResourceSprite->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(0, PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, materialDataSprite));
 			//TransFormationMatrixBufferの場所を設定
-			commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResourceSprite->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(1, PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, transformationMatrixDataSprite));
 			commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandleGPU);
-			commandList->SetGraphicsRootConstantBufferView(3, directionalLightResource->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(3, directionalLightAddress);
 			//描画！
 			// commandList->DrawInstanced(6, 1, 0, 0);
 			commandList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+			trianglesSubmitted += 2;
 #pragma endregion
 
 
 #pragma region Modelの描画
-			commandList->IASetVertexBuffers(0, 1, &VertexBufferViewModel);
-			//現状を設定。POSに設定しているものとはまた別。おなじ物を設定すると考えておけばいい
-			commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-			commandList->SetGraphicsRootConstantBufferView(0, materialResourceModel->GetGPUVirtualAddress());
-			//wvp用のCBufferの場所を設定
-			commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResourceModel->GetGPUVirtualAddress());
-			commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandleGPU3);
-			commandList->SetGraphicsRootConstantBufferView(3, directionalLightResource->GetGPUVirtualAddress());
-			//描画！
-			commandList->DrawInstanced(UINT(modelData.vertices.size()), 1, 0, 0);
+			//読み込みが終わるまでは描くものがない
+			if (!drawListModel.empty()) {
+				commandList->SetPipelineState(graphicsPipelineStatePacked.Get());
+				commandList->IASetVertexBuffers(0, 1, &VertexBufferViewModel);
+				commandList->IASetIndexBuffer(&indexBufferViewModel);
+				//現状を設定。POSに設定しているものとはまた別。おなじ物を設定すると考えておけばいい
+				commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+				//wvp用のCBufferの場所を設定
+				commandList->SetGraphicsRootConstantBufferView(1, PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, transformaitionMatrixDataModel));
+				commandList->SetGraphicsRootConstantBufferView(3, directionalLightAddress);
+				//マテリアルはこのフレームで使うものだけを1回ずつ書く
+				std::vector<D3D12_GPU_VIRTUAL_ADDRESS> materialAddressesModel(materialDataModel.size(), 0);
+				//マテリアルごとにまとめてあるので、マテリアルの数だけ描画する
+				for (const SubMesh& submesh : drawListModel) {
+					D3D12_GPU_VIRTUAL_ADDRESS& materialAddress = materialAddressesModel[submesh.materialIndex];
+					if (materialAddress == 0) {
+						materialAddress = PushUploadRing(uploadRing, uploadRingResource.Get(), uploadRingData, materialDataModel[submesh.materialIndex]);
+					}
+					commandList->SetGraphicsRootConstantBufferView(0, materialAddress);
+					commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandleGPUModel[submesh.materialIndex]);
+					//描画！
+					commandList->DrawIndexedInstanced(submesh.indexCount, 1, submesh.indexStart, 0, 0);
+					trianglesSubmitted += submesh.indexCount / 3;
+				}
+			}
 #pragma endregion
 
 
@@ -1417,6 +1587,9 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 #pragma region GPUにSignalを送る
 			fenceValue++;
 			commandQueue->Signal(fence.Get(), fenceValue);
+			//このフレームで書いた定数と解放したSRVの場所は、GPUがfenceValueまで進んだら回収してよい
+			uploadRing.FinishFrame(fenceValue);
+			srvAllocator.FinishFrame(fenceValue);
 
 
 #pragma region Fenceの値を確認してGPUを待つ
@@ -1425,6 +1598,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 				WaitForSingleObject(fenceEvent, INFINITE);
 			}
+			//転送が終わったので、Modelのテクスチャの転送元はもういらない
+			intermediateResourcesModel.clear();
+			//GPUが止まっているので、破棄されたResourceのヒープの範囲を返す
+			ReleasePlacedAllocations(placedHeaps);
 
 
 			hr = commandAllocator->Reset();
@@ -1,7 +0,0 @@
-#pragma once
-/// <summary>
-/// 4x4行列
-/// </summary>
-struct Matrix4x4 final {
-	float m[4][4];
-};
@@ -1,9 +0,0 @@
-#pragma once
-
-/// <summary>
-/// 2次元ベクトル
-/// </summary>
-struct Vector2 final {
-	float x;
-	float y;
-};
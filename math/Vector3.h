@@ -1,10 +0,0 @@
-#pragma once
-
-/// <summary>
-/// 3次元ベクトル
-/// </summary>
-struct Vector3 final {
-	float x;
-	float y;
-	float z;
-};
\ No newline at end of file
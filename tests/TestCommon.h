@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdio>
+
+// テスト用の小さなチェックマクロ
+// assertと違ってReleaseビルド(NDEBUG)でも消えず、失敗しても止まらずに数えて最後にまとめて返す
+
+inline int& TestFailureCount() {
+	static int count = 0;
+	return count;
+}
+
+inline void TestCheck(bool condition, const char* expression, const char* file, int line) {
+	if (!condition) {
+		std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+		TestFailureCount()++;
+	}
+}
+
+#define TEST_CHECK(condition) TestCheck(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+// mainの最後で呼ぶ。失敗があれば1を返す
+inline int TestResult(const char* name) {
+	if (TestFailureCount() != 0) {
+		std::fprintf(stderr, "%s: %d check(s) failed\n", name, TestFailureCount());
+		return 1;
+	}
+	std::printf("%s: ok\n", name);
+	return 0;
+}
\ No newline at end of file
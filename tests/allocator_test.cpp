@@ -0,0 +1,408 @@
+#include "TestCommon.h"
+#include "DescriptorAllocator.h"
+#include "GpuHeapAllocator.h"
+#include "TlsfAllocator.h"
+#include "UploadRingAllocator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+// 4つのアロケータを乱数で確保・解放し続け、1回ごとに管理情報(Validate)と、貸し出した範囲が重ならないことを確かめる
+// TlsfAllocator::Compact・GpuHeapAllocator::Defragment/CompactBlockは、動かした範囲どおりに中身を移せば元の中身に戻ることも確かめる
+
+namespace {
+
+void TestTlsfBasic() {
+	TlsfAllocator allocator(1 << 20);
+	const TlsfAllocation a = allocator.Allocate(100);
+	TEST_CHECK(a.offset == 0 && a.size == 112);
+	const TlsfAllocation b = allocator.Allocate(1000, 4096);
+	TEST_CHECK(b.offset == 4096);
+	TEST_CHECK(allocator.Allocate(1 << 20).node == UINT32_MAX);
+	TEST_CHECK(allocator.Validate());
+	allocator.Free(a);
+	allocator.Free(b);
+	TEST_CHECK(allocator.Validate());
+	const TlsfStatistics statistics = allocator.GetStatistics();
+	TEST_CHECK(statistics.freeBlockCount == 1 && statistics.largestFreeBlock == (1 << 20));
+	//全体をちょうど1つで使い切れる
+	const TlsfAllocation whole = allocator.Allocate(1 << 20);
+	TEST_CHECK(whole.node != UINT32_MAX && whole.offset == 0);
+}
+
+// 16バイトごとの持ち主(node)を覚えておき、確保・解放のたびに重なりがないかを見る
+void TestTlsfStress() {
+	const uint64_t capacity = 16 << 20;
+	TlsfAllocator allocator(capacity);
+	std::mt19937_64 random(3);
+	std::vector<TlsfAllocation> live;
+	std::vector<uint32_t> owners(capacity / 16, UINT32_MAX);
+	size_t overlapCount = 0;
+	size_t invalidCount = 0;
+	size_t failedCount = 0;
+	auto mark = [&](const TlsfAllocation& allocation, uint32_t owner, uint32_t expected) {
+		for (uint64_t i = allocation.offset / 16; i < (allocation.offset + allocation.size) / 16; i++) {
+			overlapCount += owners[i] != expected;
+			owners[i] = owner;
+		}
+	};
+	auto freeRandom = [&]() {
+		const size_t k = random() % live.size();
+		mark(live[k], UINT32_MAX, live[k].node);
+		allocator.Free(live[k]);
+		live[k] = live.back();
+		live.pop_back();
+	};
+
+	for (int op = 0; op < 100000; op++) {
+		if (live.empty() || random() % 100 < 52) {
+			const uint64_t size = random() % 10 == 0 ? 1 + random() % (512 << 10) : 1 + random() % 8192;
+			const uint64_t alignment = 1ull << (random() % 17);
+			const TlsfAllocation allocation = allocator.Allocate(size, alignment);
+			if (allocation.node == UINT32_MAX) {
+				//いっぱいなら1つ返して続ける
+				failedCount++;
+				if (!live.empty()) {
+					freeRandom();
+				}
+			}
+			else {
+				TEST_CHECK(allocation.offset % alignment == 0 && allocation.size >= size && allocation.offset + allocation.size <= capacity);
+				mark(allocation, allocation.node, UINT32_MAX);
+				live.push_back(allocation);
+			}
+		}
+		else {
+			freeRandom();
+		}
+		invalidCount += !allocator.Validate();
+
+		//ときどき詰める。動かした範囲の順にmemmoveすれば、どの範囲も元の中身のままになる
+		if (op % 25000 == 24999) {
+			std::vector<uint8_t> memory(capacity);
+			for (const TlsfAllocation& allocation : live) {
+				std::memset(&memory[allocation.offset], uint8_t(allocation.node * 7 + 1), allocation.size);
+			}
+			const TlsfStatistics before = allocator.GetStatistics();
+			const std::vector<TlsfMove> moves = allocator.Compact();
+			TEST_CHECK(allocator.Validate());
+			for (const TlsfMove& move : moves) {
+				TEST_CHECK(move.destinationOffset < move.sourceOffset);
+				std::memmove(&memory[move.destinationOffset], &memory[move.sourceOffset], move.size);
+			}
+			std::fill(owners.begin(), owners.end(), UINT32_MAX);
+			size_t corruptCount = 0;
+			for (TlsfAllocation& allocation : live) {
+				allocation.offset = allocator.GetOffset(allocation.node);
+				TEST_CHECK(allocation.offset % allocator.GetAlignment(allocation.node) == 0);
+				for (uint64_t i = 0; i < allocation.size; i++) {
+					corruptCount += memory[allocation.offset + i] != uint8_t(allocation.node * 7 + 1);
+				}
+				mark(allocation, allocation.node, UINT32_MAX);
+			}
+			TEST_CHECK(corruptCount == 0);
+			const TlsfStatistics after = allocator.GetStatistics();
+			TEST_CHECK(after.usedBytes == before.usedBytes && after.allocationCount == before.allocationCount);
+			//アラインメントの隙間は残るので、空きが1か所になるとは限らない
+			TEST_CHECK(after.largestFreeBlock >= before.largestFreeBlock && after.freeBlockCount <= before.freeBlockCount);
+			std::printf("tlsf compact: %zu moves, fragmentation %.3f -> %.3f, free blocks %u -> %u\n",
+				moves.size(), before.fragmentation, after.fragmentation, before.freeBlockCount, after.freeBlockCount);
+		}
+	}
+	TEST_CHECK(overlapCount == 0);
+	TEST_CHECK(invalidCount == 0);
+
+	for (const TlsfAllocation& allocation : live) {
+		allocator.Free(allocation);
+	}
+	TEST_CHECK(allocator.Validate());
+	const TlsfStatistics statistics = allocator.GetStatistics();
+	TEST_CHECK(statistics.usedBytes == 0 && statistics.freeBlockCount == 1);
+	std::printf("tlsf stress: %zu allocations failed (full)\n", failedCount);
+}
+
+// 3つのグループに確保・解放し続け、ときどき全ブロックをCompactBlockで詰めてから、Defragment → ReleaseEmptyBlocksを行う
+// 動かした範囲どおりに付け替えれば、どの範囲も重ならず、使用量も変わらない
+void TestGpuHeapStress() {
+	const uint64_t kMegabyte = 1 << 20;
+	const uint64_t kAlignment = 65536;
+	GpuHeapAllocator allocator(64 * kMegabyte);
+	std::mt19937_64 random(5);
+	std::vector<GpuHeapAllocation> live;
+	size_t invalidCount = 0;
+	size_t defragmentMoveCount = 0;
+	size_t compactMoveCount = 0;
+
+	auto overlaps = [&]() {
+		std::map<std::pair<uint32_t, uint32_t>, std::vector<std::pair<uint64_t, uint64_t>>> ranges;
+		bool overlapping = false;
+		for (const GpuHeapAllocation& allocation : live) {
+			const uint64_t end = allocation.allocation.offset + allocation.allocation.size;
+			overlapping = overlapping || end > allocator.BlockSize(allocation.group, allocation.block);
+			ranges[{ allocation.group, allocation.block }].push_back({ allocation.allocation.offset, end });
+		}
+		for (auto& [block, blockRanges] : ranges) {
+			std::sort(blockRanges.begin(), blockRanges.end());
+			for (size_t i = 1; i < blockRanges.size(); i++) {
+				overlapping = overlapping || blockRanges[i - 1].second > blockRanges[i].first;
+			}
+		}
+		return overlapping;
+	};
+	auto find = [&](const GpuHeapAllocation& target) {
+		return std::find_if(live.begin(), live.end(), [&](const GpuHeapAllocation& allocation) {
+			return allocation.group == target.group && allocation.block == target.block && allocation.allocation.node == target.allocation.node;
+		});
+	};
+
+	for (int op = 0; op < 40000; op++) {
+		if (live.empty() || random() % 100 < 50) {
+			const uint32_t group = random() % 3;
+			const uint64_t size = random() % 50 == 0 ? (64 + random() % 64) * kMegabyte : kAlignment * (1 + random() % 32);
+			const GpuHeapAllocation allocation = allocator.Allocate(group, size, kAlignment);
+			TEST_CHECK(allocation.block != UINT32_MAX && allocation.allocation.offset % kAlignment == 0 && allocation.allocation.size >= size);
+			live.push_back(allocation);
+		}
+		else {
+			const size_t k = random() % live.size();
+			allocator.Free(live[k]);
+			live[k] = live.back();
+			live.pop_back();
+		}
+		invalidCount += !allocator.Validate();
+
+		if (op % 10000 == 9999) {
+			TEST_CHECK(!overlaps());
+			for (uint32_t group = 0; group < 3; group++) {
+				const GpuHeapStatistics before = allocator.GetStatistics(group);
+				size_t lostCount = 0;
+				const size_t compactMoveStart = compactMoveCount;
+				for (uint32_t block = 0; block < allocator.BlockCount(group); block++) {
+					if (allocator.BlockSize(group, block) == 0) {
+						continue;
+					}
+					for (const TlsfMove& move : allocator.CompactBlock(group, block)) {
+						auto it = find({ group, block, { move.node } });
+						lostCount += it == live.end();
+						if (it != live.end()) {
+							it->allocation.offset = move.destinationOffset;
+						}
+						compactMoveCount++;
+					}
+				}
+				TEST_CHECK(lostCount == 0);
+				TEST_CHECK(allocator.Validate());
+
+				const std::vector<GpuHeapMove> moves = allocator.Defragment(group);
+				TEST_CHECK(allocator.Validate());
+				for (const GpuHeapMove& move : moves) {
+					auto it = find(move.source);
+					lostCount += it == live.end();
+					if (it != live.end()) {
+						*it = move.destination;
+					}
+				}
+				TEST_CHECK(lostCount == 0);
+				std::vector<uint32_t> releasedBlocks;
+				allocator.ReleaseEmptyBlocks(group, releasedBlocks);
+				TEST_CHECK(allocator.Validate());
+				defragmentMoveCount += moves.size();
+
+				const GpuHeapStatistics after = allocator.GetStatistics(group);
+				TEST_CHECK(after.usedBytes == before.usedBytes && after.allocationCount == before.allocationCount);
+				TEST_CHECK(after.blockCount == before.blockCount - releasedBlocks.size());
+				if (group == 0) {
+					std::printf("gpu heap defragment: blocks %u -> %u (%zu moved), fragmentation %.3f -> %.3f, %zu compact moves\n",
+						before.blockCount, after.blockCount, moves.size(), before.fragmentation, after.fragmentation, compactMoveCount - compactMoveStart);
+				}
+			}
+			TEST_CHECK(!overlaps());
+		}
+	}
+	TEST_CHECK(invalidCount == 0);
+	//移す・詰める経路を両方通っていること
+	TEST_CHECK(defragmentMoveCount > 0 && compactMoveCount > 0);
+
+	for (const GpuHeapAllocation& allocation : live) {
+		allocator.Free(allocation);
+	}
+	for (uint32_t group = 0; group < 3; group++) {
+		std::vector<uint32_t> releasedBlocks;
+		allocator.ReleaseEmptyBlocks(group, releasedBlocks);
+		TEST_CHECK(allocator.GetStatistics(group).blockCount == 0);
+	}
+	TEST_CHECK(allocator.Validate());
+}
+
+void TestUploadRing() {
+	const uint64_t kInvalid = UploadRingAllocator::kInvalidOffset;
+	{
+		UploadRingAllocator ring(1024);
+		TEST_CHECK(ring.Allocate(100) == 0);
+		TEST_CHECK(ring.Allocate(10) == 256);
+		TEST_CHECK(ring.Allocate(600) == kInvalid);
+		TEST_CHECK(ring.Allocate(400) == 512);
+		ring.FinishFrame(1);
+		TEST_CHECK(ring.Allocate(1) == kInvalid);
+		ring.Reclaim(0);
+		TEST_CHECK(ring.Allocate(1) == kInvalid);
+		ring.Reclaim(1);
+		TEST_CHECK(ring.UsedBytes() == 0);
+		//末尾の余りを捨てて先頭に戻る
+		TEST_CHECK(ring.Allocate(300) == 0);
+		TEST_CHECK(ring.Allocate(2000) == kInvalid);
+		TEST_CHECK(ring.Allocate(0) == kInvalid);
+		ring.FinishFrame(2);
+		ring.Reclaim(2);
+		TEST_CHECK(ring.FramesInFlight() == 0);
+	}
+
+	//GPUが0~3フレーム遅れて終わるものとして、回収されていない範囲と重ならないことを確かめる
+	struct LiveRange {
+		uint64_t offset;
+		uint64_t size;
+		uint64_t fenceValue;
+	};
+	std::mt19937 random(1);
+	UploadRingAllocator ring(64 * 1024);
+	std::deque<LiveRange> live;
+	uint64_t fenceValue = 0;
+	uint64_t completed = 0;
+	size_t overlapCount = 0;
+	for (int frame = 0; frame < 20000; frame++) {
+		const uint64_t target = fenceValue > 3 ? fenceValue - random() % 4 : 0;
+		completed = (std::max)(completed, target);
+		ring.Reclaim(completed);
+		while (!live.empty() && live.front().fenceValue <= completed) {
+			live.pop_front();
+		}
+		const int count = random() % 40;
+		for (int i = 0; i < count; i++) {
+			const uint64_t size = 1 + random() % 700;
+			const uint64_t alignment = random() % 3 == 0 ? 16 : 256;
+			const uint64_t offset = ring.Allocate(size, alignment);
+			if (offset == kInvalid) {
+				continue;
+			}
+			TEST_CHECK(offset % alignment == 0 && offset + size <= ring.Capacity());
+			for (const LiveRange& range : live) {
+				overlapCount += !(offset + size <= range.offset || range.offset + range.size <= offset);
+			}
+			live.push_back({ offset, size, fenceValue + 1 });
+		}
+		TEST_CHECK(ring.UsedBytes() <= ring.Capacity());
+		fenceValue++;
+		ring.FinishFrame(fenceValue);
+	}
+	TEST_CHECK(overlapCount == 0);
+}
+
+void TestDescriptorAllocator() {
+	{
+		DescriptorAllocator allocator(4, 8);
+		const DescriptorHandle h0 = allocator.AllocatePersistent();
+		const DescriptorHandle h1 = allocator.AllocatePersistent();
+		TEST_CHECK(h0.index == 0 && h1.index == 1 && allocator.IsAlive(h0));
+		allocator.FreePersistent(h0);
+		TEST_CHECK(!allocator.IsAlive(h0));
+		//GPUが終わるまで場所は再利用しない
+		TEST_CHECK(allocator.AllocatePersistent().index == 2);
+		allocator.FinishFrame(1);
+		allocator.Reclaim(1);
+		const DescriptorHandle h3 = allocator.AllocatePersistent();
+		TEST_CHECK(h3.index == 0 && !allocator.IsAlive(h0) && allocator.IsAlive(h3));
+		TEST_CHECK(allocator.AllocatePersistent().index == 3);
+		TEST_CHECK(allocator.AllocatePersistent().index == DescriptorAllocator::kInvalidIndex);
+		TEST_CHECK(allocator.AllocateTransient(5) == 4);
+		TEST_CHECK(allocator.AllocateTransient(4) == DescriptorAllocator::kInvalidIndex);
+		TEST_CHECK(allocator.AllocateTransient(3) == 9);
+		TEST_CHECK(!allocator.IsAlive(DescriptorHandle{}));
+		TEST_CHECK(allocator.Capacity() == 12);
+	}
+
+	//解放した場所は、GPUがそのフレームを終えるまでどのハンドルにも貸し出されないこと
+	std::mt19937 random(7);
+	const uint32_t kPersistentCapacity = 4096;
+	const uint32_t kTransientCapacity = 1024;
+	DescriptorAllocator allocator(kPersistentCapacity, kTransientCapacity);
+	std::vector<DescriptorHandle> live;
+	std::vector<DescriptorHandle> freed;
+	std::deque<std::pair<uint64_t, uint32_t>> inFlight;  //解放したがGPUが読んでいるかもしれない場所
+	std::deque<std::pair<uint64_t, std::pair<uint32_t, uint32_t>>> transients;
+	std::vector<bool> used(kPersistentCapacity, false);
+	uint64_t fenceValue = 0;
+	uint64_t completed = 0;
+	size_t reuseCount = 0;
+	size_t staleAliveCount = 0;
+	for (int frame = 0; frame < 20000; frame++) {
+		completed = (std::max)(completed, fenceValue > 2 ? fenceValue - random() % 3 : 0);
+		allocator.Reclaim(completed);
+		while (!inFlight.empty() && inFlight.front().first <= completed) {
+			used[inFlight.front().second] = false;
+			inFlight.pop_front();
+		}
+		while (!transients.empty() && transients.front().first <= completed) {
+			transients.pop_front();
+		}
+		const int count = random() % 20;
+		for (int i = 0; i < count; i++) {
+			if (random() % 2 && live.size() < 4000) {
+				const DescriptorHandle handle = allocator.AllocatePersistent();
+				if (handle.index == DescriptorAllocator::kInvalidIndex) {
+					continue;
+				}
+				reuseCount += used[handle.index];
+				used[handle.index] = true;
+				live.push_back(handle);
+			}
+			else if (!live.empty()) {
+				const size_t k = random() % live.size();
+				allocator.FreePersistent(live[k]);
+				inFlight.push_back({ fenceValue + 1, live[k].index });
+				freed.push_back(live[k]);
+				live[k] = live.back();
+				live.pop_back();
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			const uint32_t transientCount = 1 + random() % 64;
+			const uint32_t start = allocator.AllocateTransient(transientCount);
+			if (start == DescriptorAllocator::kInvalidIndex) {
+				continue;
+			}
+			TEST_CHECK(start >= kPersistentCapacity && start + transientCount <= kPersistentCapacity + kTransientCapacity);
+			for (const auto& [transientFence, range] : transients) {
+				reuseCount += !(start + transientCount <= range.first || range.first + range.second <= start);
+			}
+			transients.push_back({ fenceValue + 1, { start, transientCount } });
+		}
+		//解放したハンドルは、場所が再利用されていても生きていることにならない
+		for (const DescriptorHandle& handle : freed) {
+			staleAliveCount += allocator.IsAlive(handle);
+		}
+		freed.clear();
+		fenceValue++;
+		allocator.FinishFrame(fenceValue);
+	}
+	TEST_CHECK(reuseCount == 0);
+	TEST_CHECK(staleAliveCount == 0);
+	TEST_CHECK(allocator.PersistentCount() == live.size());
+	for (const DescriptorHandle& handle : live) {
+		TEST_CHECK(allocator.IsAlive(handle) && allocator.Resolve(handle) == handle.index);
+	}
+}
+
+}
+
+int main() {
+	TestTlsfBasic();
+	TestTlsfStress();
+	TestGpuHeapStress();
+	TestUploadRing();
+	TestDescriptorAllocator();
+	return TestResult("allocator_test");
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "TestCommon.h"
+#include "AsyncModelLoader.h"
+#include "ObjBenchmark.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// AsyncModelLoaderが合成objを読み切り、中断・破棄のときにキャッシュを残さず、結果がLoadObjFileCachedと同じになること
+// SpscQueueが入れた順に取り出せることを確かめる
+
+namespace {
+
+template<typename T>
+bool SameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+	return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+bool SameModel(const ModelData& a, const ModelData& b) {
+	if (!SameBytes(a.vertices, b.vertices) || a.indices != b.indices || a.closed != b.closed) {
+		return false;
+	}
+	if (!SameBytes(a.submeshes, b.submeshes) || a.materials.size() != b.materials.size() || a.lods.size() != b.lods.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.materials.size(); i++) {
+		if (a.materials[i].name != b.materials[i].name || a.materials[i].textureFilePath != b.materials[i].textureFilePath) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i < a.lods.size(); i++) {
+		if (a.lods[i].triangleCount != b.lods[i].triangleCount || a.lods[i].error != b.lods[i].error ||
+			!SameBytes(a.lods[i].submeshes, b.lods[i].submeshes) || !SameBytes(a.lods[i].meshlets, b.lods[i].meshlets)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 結果が来るまで待つ。来なければfalse
+bool WaitCompleted(AsyncModelLoader& loader, LoadedModel& model) {
+	const auto limit = std::chrono::steady_clock::now() + std::chrono::minutes(5);
+	while (!loader.TryPopCompleted(model)) {
+		if (std::chrono::steady_clock::now() > limit) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+// 読み込み中であることが分かるまで待つ(objを開いて、まだ結果が出ていない)
+bool WaitStarted(const ModelLoadHandle& handle) {
+	while (handle.BytesTotal() == 0) {
+		if (handle.IsDone()) {
+			return false;
+		}
+		std::this_thread::yield();
+	}
+	return !handle.IsDone();
+}
+
+std::string PrepareObj(const std::filesystem::path& directory, uint64_t targetBytes) {
+	SyntheticObjSettings settings;
+	settings.targetBytes = targetBytes;
+	std::string filename;
+	TEST_CHECK(PrepareSyntheticObj(directory.string(), settings, filename));
+	std::filesystem::remove(directory / (filename + ".cmesh"));
+	return filename;
+}
+
+// 進み具合は減らずに1で終わり、読み込んだ結果が入る
+void TestProgress(const std::filesystem::path& directory) {
+	const std::string filename = PrepareObj(directory, 1ull << 20);
+	AsyncModelLoader loader;
+	ModelLoadHandle handle = loader.Load(directory.string(), filename);
+	TEST_CHECK(handle.IsValid());
+	float lastProgress = 0.0f;
+	bool decreased = false;
+	LoadedModel model;
+	while (!loader.TryPopCompleted(model)) {
+		const float progress = handle.Progress();
+		decreased |= progress < lastProgress;
+		lastProgress = progress;
+		std::this_thread::yield();
+	}
+	TEST_CHECK(!decreased);
+	//結果はdoneより先にキューに入るので、doneになるまで待ってから見る
+	while (!handle.IsDone()) {
+		std::this_thread::yield();
+	}
+	TEST_CHECK(handle.Progress() == 1.0f);
+	TEST_CHECK(handle.BytesParsed() == handle.BytesTotal() && handle.BytesTotal() == std::filesystem::file_size(directory / filename));
+	TEST_CHECK(!model.cancelled);
+	TEST_CHECK(model.filename == filename);
+	TEST_CHECK(!model.modelData.indices.empty() && !model.modelData.lods.empty());
+	TEST_CHECK(handle.FacesParsed() == model.modelData.lods[0].triangleCount);
+	TEST_CHECK(std::filesystem::exists(directory / (filename + ".cmesh")));
+}
+
+// 読み込み中に中断すると、cancelledになってmodelDataが空で、キャッシュを書かない
+void TestCancel(const std::filesystem::path& directory) {
+	const std::string filename = PrepareObj(directory, 8ull << 20);
+	AsyncModelLoader loader;
+	ModelLoadHandle handle = loader.Load(directory.string(), filename);
+	TEST_CHECK(WaitStarted(handle));
+	handle.Cancel();
+	LoadedModel model;
+	TEST_CHECK(WaitCompleted(loader, model));
+	TEST_CHECK(model.cancelled);
+	TEST_CHECK(model.modelData.vertices.empty() && model.modelData.indices.empty() && model.modelData.lods.empty());
+	TEST_CHECK(!std::filesystem::exists(directory / (filename + ".cmesh")));
+
+	//中断したあとも次の読み込みはできる
+	const std::string smallFilename = PrepareObj(directory, 64ull << 10);
+	loader.Load(directory.string(), smallFilename);
+	TEST_CHECK(WaitCompleted(loader, model));
+	TEST_CHECK(!model.cancelled && !model.modelData.indices.empty());
+}
+
+// 非同期に作った結果が、LoadObjFileCachedで作った結果・キャッシュから読んだ結果と同じ
+void TestMatchesSynchronous(const std::filesystem::path& directory) {
+	const std::string filename = PrepareObj(directory, 256ull << 10);
+	MeshLoadInfo info;
+	const ModelData cooked = LoadObjFileCached(directory.string(), filename, &info);
+	TEST_CHECK(!info.fromCache);
+	std::filesystem::remove(directory / (filename + ".cmesh"));
+
+	AsyncModelLoader loader;
+	loader.Load(directory.string(), filename);
+	LoadedModel model;
+	TEST_CHECK(WaitCompleted(loader, model));
+	TEST_CHECK(!model.cancelled && !model.info.fromCache);
+	TEST_CHECK(SameModel(model.modelData, cooked));
+
+	const ModelData cached = LoadObjFileCached(directory.string(), filename, &info);
+	TEST_CHECK(info.fromCache);
+	TEST_CHECK(SameModel(model.modelData, cached));
+
+	//キャッシュがあれば非同期でもキャッシュから読む
+	loader.Load(directory.string(), filename);
+	TEST_CHECK(WaitCompleted(loader, model));
+	TEST_CHECK(model.info.fromCache);
+	TEST_CHECK(SameModel(model.modelData, cached));
+}
+
+// 読み込み中・順番待ちのものがあっても、破棄すると中断してスレッドを止め、キャッシュを書かない
+void TestDestroyWhileLoading(const std::filesystem::path& directory) {
+	const std::string filename = PrepareObj(directory, 8ull << 20);
+	const std::string queuedFilename = PrepareObj(directory, 1ull << 20);
+	ModelLoadHandle handle;
+	ModelLoadHandle queuedHandle;
+	{
+		AsyncModelLoader loader;
+		handle = loader.Load(directory.string(), filename);
+		queuedHandle = loader.Load(directory.string(), queuedFilename);
+		TEST_CHECK(WaitStarted(handle));
+	}
+	//順番待ちだったものは始まらない
+	TEST_CHECK(queuedHandle.BytesTotal() == 0 && !queuedHandle.IsDone());
+	TEST_CHECK(!std::filesystem::exists(directory / (filename + ".cmesh")));
+	TEST_CHECK(!std::filesystem::exists(directory / (queuedFilename + ".cmesh")));
+}
+
+// 1つのスレッドが入れたものを、もう1つのスレッドが同じ順番で受け取る
+void TestSpscQueueOrder() {
+	constexpr uint64_t kItemCount = 200000;
+	SpscQueue<std::vector<uint64_t>> queue(8);
+	TEST_CHECK(queue.Capacity() == 8);
+	std::thread producer([&]() {
+		for (uint64_t i = 0; i < kItemCount; i++) {
+			std::vector<uint64_t> item = { i, i * 3 + 1 };
+			while (!queue.TryPush(std::move(item))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	uint64_t expected = 0;
+	bool ordered = true;
+	std::vector<uint64_t> item;
+	while (expected < kItemCount) {
+		if (!queue.TryPop(item)) {
+			std::this_thread::yield();
+			continue;
+		}
+		ordered &= item.size() == 2 && item[0] == expected && item[1] == expected * 3 + 1;
+		expected++;
+	}
+	producer.join();
+	TEST_CHECK(ordered);
+	TEST_CHECK(!queue.TryPop(item));
+
+	//いっぱいなら入れられず、渡したものはそのまま残る
+	SpscQueue<std::vector<uint64_t>> full(2);
+	std::vector<uint64_t> value = { 1 };
+	TEST_CHECK(full.TryPush(std::move(value)));
+	value = { 2 };
+	TEST_CHECK(full.TryPush(std::move(value)));
+	value = { 3 };
+	TEST_CHECK(!full.TryPush(std::move(value)));
+	TEST_CHECK(value.size() == 1 && value[0] == 3);
+	TEST_CHECK(full.TryPop(item) && item[0] == 1);
+	TEST_CHECK(full.TryPush(std::move(value)));
+	TEST_CHECK(full.TryPop(item) && item[0] == 2);
+	TEST_CHECK(full.TryPop(item) && item[0] == 3);
+}
+
+}
+
+int main() {
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "cg3_async_loader_test";
+	std::filesystem::create_directories(directory);
+	TestProgress(directory);
+	TestCancel(directory);
+	TestMatchesSynchronous(directory);
+	TestDestroyWhileLoading(directory);
+	TestSpscQueueOrder();
+	std::filesystem::remove_all(directory);
+	return TestResult("async_loader_test");
+}
\ No newline at end of file
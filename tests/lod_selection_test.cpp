@@ -0,0 +1,132 @@
+#include "TestCommon.h"
+#include "LodSelection.h"
+#include "ProceduralMesh.h"
+#include <vector>
+
+// SelectLodの境目での粘り(ヒステリシス)と、MakePrimitiveLodLevelsの段の作り方を確かめる
+
+namespace {
+
+constexpr float kFovY = 0.45f;
+constexpr float kScreenHeight = 720.0f;
+
+std::vector<float> GetLodErrors(const std::vector<PrimitiveLodLevel>& levels) {
+	std::vector<float> errors;
+	for (const PrimitiveLodLevel& level : levels) {
+		errors.push_back(level.error);
+	}
+	return errors;
+}
+
+PrimitiveDesc MakeSphereDesc() {
+	PrimitiveDesc desc;
+	desc.segments = 64;
+	desc.rings = 32;
+	return desc;
+}
+
+// 段は細かい順に並んで誤差が増えていき、遠くでは一番粗い段、近くでは一番細かい段を選ぶ
+void TestSphereLevels() {
+	const std::vector<PrimitiveLodLevel> levels = MakePrimitiveLodLevels(MakeSphereDesc(), 4);
+	TEST_CHECK(levels.size() == 4);
+	for (size_t i = 1; i < levels.size(); i++) {
+		TEST_CHECK(levels[i].error > levels[i - 1].error);
+		TEST_CHECK(levels[i].desc.segments == levels[i - 1].desc.segments / 2);
+		TEST_CHECK(levels[i].vertexStart == levels[i - 1].vertexStart + levels[i - 1].vertexCount);
+		TEST_CHECK(levels[i].indexStart == levels[i - 1].indexStart + levels[i - 1].indexCount);
+	}
+	const std::vector<float> errors = GetLodErrors(levels);
+	TEST_CHECK(SelectLod(errors, ComputeLodPixelScale(1000.0f, kFovY, kScreenHeight), 0) == levels.size() - 1);
+	TEST_CHECK(SelectLod(errors, ComputeLodPixelScale(1.5f, kFovY, kScreenHeight), static_cast<uint32_t>(levels.size() - 1)) == 0);
+
+	//minSegmentsより細かくは減らさず、それ以上減らせなければそこで終わる
+	const std::vector<PrimitiveLodLevel> limited = MakePrimitiveLodLevels(MakeSphereDesc(), 8, 16);
+	TEST_CHECK(limited.size() == 3);
+	TEST_CHECK(limited.back().desc.segments == 16 && limited.back().desc.rings == 16);
+}
+
+// 平らな形は分割を減らしても誤差が0のままなので、1段だけになる
+void TestFlatShapesCollapse() {
+	for (PrimitiveShape shape : { PrimitiveShape::Cube, PrimitiveShape::Plane }) {
+		PrimitiveDesc desc;
+		desc.shape = shape;
+		desc.segments = 32;
+		const std::vector<PrimitiveLodLevel> levels = MakePrimitiveLodLevels(desc, 4);
+		TEST_CHECK(levels.size() == 1);
+		TEST_CHECK(levels[0].desc == desc && levels[0].error == 0.0f);
+		TEST_CHECK(SelectLod(GetLodErrors(levels), ComputeLodPixelScale(0.5f, kFovY, kScreenHeight), 0) == 0);
+	}
+}
+
+// 近づく・遠ざかるときに段が変わるのは、誤差が±ヒステリシスの幅の外に出たときだけ
+// 幅の中で行ったり来たりしても段は変わらない
+void TestHysteresis() {
+	const std::vector<float> errors = GetLodErrors(MakePrimitiveLodLevels(MakeSphereDesc(), 4));
+	const float hysteresis = 0.25f;
+	auto pixelScaleAt = [](float distance) { return ComputeLodPixelScale(distance, kFovY, kScreenHeight); };
+
+	//遠くから近づいて、また遠ざかる
+	std::vector<float> distances;
+	for (float distance = 400.0f; distance > 1.0f; distance *= 0.99f) {
+		distances.push_back(distance);
+	}
+	for (float distance = 1.0f; distance < 400.0f; distance *= 1.01f) {
+		distances.push_back(distance);
+	}
+	uint32_t lod = static_cast<uint32_t>(errors.size() - 1);
+	uint32_t changeCount = 0;
+	bool changedOnlyOutsideBand = true;
+	for (float distance : distances) {
+		const float pixelScale = pixelScaleAt(distance);
+		const uint32_t next = SelectLod(errors, pixelScale, lod, 1.0f, hysteresis);
+		if (next < lod) {
+			//細かくするのは今の段の誤差が幅の上を超えたときだけ
+			changedOnlyOutsideBand &= errors[lod] * pixelScale > 1.0f + hysteresis;
+		}
+		else if (next > lod) {
+			//粗くするのは次の段の誤差が幅の下に入ったときだけ
+			changedOnlyOutsideBand &= errors[next] * pixelScale <= 1.0f - hysteresis;
+		}
+		changeCount += next != lod;
+		lod = next;
+	}
+	TEST_CHECK(changedOnlyOutsideBand);
+	//近づくときに3回細かくなり、遠ざかるときに3回粗くなる
+	TEST_CHECK(changeCount == 2 * (errors.size() - 1));
+	TEST_CHECK(lod == errors.size() - 1);
+
+	//LOD1とLOD2の境目(LOD2の誤差がちょうど1ピクセル)の前後、幅の中で行ったり来たりする
+	const float boundaryPixelScale = 1.0f / errors[2];
+	for (uint32_t start : { 1u, 2u }) {
+		uint32_t current = start;
+		bool stayed = true;
+		for (int step = 0; step < 100; step++) {
+			const float wobble = (step % 2 == 0) ? 1.2f : 0.8f;
+			current = SelectLod(errors, boundaryPixelScale * wobble, current, 1.0f, hysteresis);
+			stayed &= current == start;
+		}
+		TEST_CHECK(stayed);
+	}
+	//幅の外に出れば変わる
+	TEST_CHECK(SelectLod(errors, boundaryPixelScale * 1.3f, 2, 1.0f, hysteresis) == 1);
+	TEST_CHECK(SelectLod(errors, boundaryPixelScale * 0.7f, 1, 1.0f, hysteresis) >= 2);
+}
+
+// 前の段がLODの数より大きくても(段の少ないモデルに差し替えたとき)、範囲に収めてから選ぶ
+void TestCurrentLodOutOfRange() {
+	const std::vector<float> errors = { 0.0f, 0.01f, 0.02f, 0.04f };
+	TEST_CHECK(SelectLod(errors, 1.0f, 10) == 3);
+	TEST_CHECK(SelectLod(errors, 40.0f, 10) == 2);
+	TEST_CHECK(SelectLod(errors, 1000.0f, 10) == 0);
+	TEST_CHECK(SelectLod({}, 1.0f, 10) == 0);
+}
+
+}
+
+int main() {
+	TestSphereLevels();
+	TestFlatShapesCollapse();
+	TestHysteresis();
+	TestCurrentLodOutOfRange();
+	return TestResult("lod_selection_test");
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "TestCommon.h"
+#include "MyMath.h"
+#include <algorithm>
+#include <random>
+
+// MyMath.hの特殊化した関数が一般の4x4版と同じ結果になるかを確かめる
+
+namespace {
+
+// 倍精度のGauss-Jordan法(部分ピボット選択)で求めた逆行列。誤差を測るための基準
+bool GaussJordanInverse(const Matrix4x4& m, double result[4][4]) {
+	double a[4][8] = {};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			a[i][j] = m.m[i][j];
+		}
+		a[i][4 + i] = 1.0;
+	}
+	for (int column = 0; column < 4; column++) {
+		int pivot = column;
+		for (int row = column + 1; row < 4; row++) {
+			if (std::abs(a[row][column]) > std::abs(a[pivot][column])) {
+				pivot = row;
+			}
+		}
+		if (a[pivot][column] == 0.0) {
+			return false;
+		}
+		std::swap(a[pivot], a[column]);
+		double recp = 1.0 / a[column][column];
+		for (int j = 0; j < 8; j++) {
+			a[column][j] *= recp;
+		}
+		for (int row = 0; row < 4; row++) {
+			if (row != column) {
+				double factor = a[row][column];
+				for (int j = 0; j < 8; j++) {
+					a[row][j] -= factor * a[column][j];
+				}
+			}
+		}
+	}
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result[i][j] = a[i][4 + j];
+		}
+	}
+	return true;
+}
+
+// 基準との差の最大値を、基準の最大絶対値要素で割ったもの
+double RelativeError(const Matrix4x4& m, const double reference[4][4]) {
+	double maxDifference = 0.0;
+	double maxReference = 0.0;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			maxDifference = std::max(maxDifference, std::abs(m.m[i][j] - reference[i][j]));
+			maxReference = std::max(maxReference, std::abs(reference[i][j]));
+		}
+	}
+	return maxDifference / maxReference;
+}
+
+// 全要素が等しいか(誤差を許さない)
+bool Equal(const Matrix4x4& m1, const Matrix4x4& m2) {
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			if (m1.m[i][j] != m2.m[i][j]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void TestAffineInverse() {
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> scaleDist(0.1f, 10.0f);
+	std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> positionDist(-1000.0f, 1000.0f);
+	double maxGeneral = 0.0, maxAffine = 0.0, maxRigid = 0.0;
+	for (int i = 0; i < 10000; i++) {
+		Vector3 rotate = { angleDist(random), angleDist(random), angleDist(random) };
+		Vector3 translate = { positionDist(random), positionDist(random), positionDist(random) };
+		Vector3 scale = { scaleDist(random), scaleDist(random), scaleDist(random) };
+
+		double reference[4][4];
+		Matrix4x4 affine = MakeAffineMatrix(scale, rotate, translate);
+		TEST_CHECK(GaussJordanInverse(affine, reference));
+		maxGeneral = std::max(maxGeneral, RelativeError(Inverse(affine), reference));
+		maxAffine = std::max(maxAffine, RelativeError(InverseAffine(affine), reference));
+
+		Matrix4x4 rigid = MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, rotate, translate);
+		TEST_CHECK(GaussJordanInverse(rigid, reference));
+		maxRigid = std::max(maxRigid, RelativeError(InverseRigid(rigid), reference));
+	}
+	std::printf("inverse relative error vs Gauss-Jordan: Inverse %.3g, InverseAffine %.3g, InverseRigid %.3g\n", maxGeneral, maxAffine, maxRigid);
+	TEST_CHECK(maxGeneral < 1.0e-5);
+	TEST_CHECK(maxAffine < 1.0e-5);
+	TEST_CHECK(maxRigid < 1.0e-5);
+}
+
+void TestQuaternionAffine() {
+	// { }で渡しても曖昧にならないこと(コンパイルが通ればよい)
+	Matrix4x4 braced = MakeAffineMatrix({ 1.0f, 2.0f, 3.0f }, { 0.1f, 0.2f, 0.3f }, { 4.0f, 5.0f, 6.0f });
+
+	// オイラー角版と同じ回転になること
+	Matrix4x4 quaternion = MakeAffineMatrixQuaternion({ 1.0f, 2.0f, 3.0f }, MakeRotateQuaternion({ 0.1f, 0.2f, 0.3f }), { 4.0f, 5.0f, 6.0f });
+	float maxDifference = 0.0f;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			maxDifference = std::max(maxDifference, std::abs(braced.m[i][j] - quaternion.m[i][j]));
+		}
+	}
+	TEST_CHECK(maxDifference < 1.0e-5f);
+}
+
+// 3x4版の乗算・座標変換は4x4版と同じ順番で加算するので結果がビット単位で一致し、逆行列はInverseAffineと一致すること
+void TestMatrix3x4() {
+	std::mt19937 random(2);
+	std::uniform_real_distribution<float> scaleDist(0.1f, 10.0f);
+	std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> positionDist(-1000.0f, 1000.0f);
+	auto randomVector = [&](std::uniform_real_distribution<float>& dist) {
+		return Vector3{ dist(random), dist(random), dist(random) };
+	};
+	double maxInverseError = 0.0;
+	for (int i = 0; i < 10000; i++) {
+		Matrix4x4 a = MakeAffineMatrix(randomVector(scaleDist), randomVector(angleDist), randomVector(positionDist));
+		Matrix4x4 b = MakeAffineMatrix(randomVector(scaleDist), randomVector(angleDist), randomVector(positionDist));
+		Matrix3x4 a3x4 = ToMatrix3x4(a);
+		Matrix3x4 b3x4 = ToMatrix3x4(b);
+		TEST_CHECK(Equal(ToMatrix4x4(a3x4), a));
+
+		Vector3 point = randomVector(positionDist);
+		Vector3 transformed = Transform(point, a3x4);
+		Vector3 expected = Transform(point, a);
+		TEST_CHECK(transformed.x == expected.x && transformed.y == expected.y && transformed.z == expected.z);
+
+		TEST_CHECK(Equal(ToMatrix4x4(Multiply(a3x4, b3x4)), Multiply(a, b)));
+
+		TEST_CHECK(Equal(ToMatrix4x4(Inverse(a3x4)), InverseAffine(a)));
+		double reference[4][4];
+		TEST_CHECK(GaussJordanInverse(a, reference));
+		maxInverseError = std::max(maxInverseError, RelativeError(ToMatrix4x4(Inverse(a3x4)), reference));
+	}
+	std::printf("Inverse(Matrix3x4) relative error vs Gauss-Jordan: %.3g\n", maxInverseError);
+	TEST_CHECK(maxInverseError < 1.0e-5);
+}
+
+// UV変換の2x4行列が、4x4行列を掛けてからTransformした結果と同じになること
+// シェーダーと同じくmul(M, float4(uv, 0, 1))で変換する
+void TestUVTransform() {
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> scaleDist(0.1f, 4.0f);
+	std::uniform_real_distribution<float> angleDist(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> uvDist(-2.0f, 2.0f);
+	float maxError = 0.0f;
+	for (int i = 0; i < 10000; i++) {
+		Vector3 scale = { scaleDist(random), scaleDist(random), 1.0f };
+		float rotateZ = angleDist(random);
+		Vector3 translate = { uvDist(random), uvDist(random), 0.0f };
+		Matrix4x4 uv4x4 = Multiply(Multiply(MakeScaleMatrix(scale), MakeRotateZMatrix(rotateZ)), MakeTranslateMatrix(translate));
+		Matrix2x4 uv2x4 = MakeUVTransformMatrix(scale, rotateZ, translate);
+		Matrix2x4 converted = ToMatrix2x4(uv4x4);
+
+		for (int sample = 0; sample < 4; sample++) {
+			Vector2 uv = { uvDist(random), uvDist(random) };
+			Vector3 expected = Transform(Vector3{ uv.x, uv.y, 0.0f }, uv4x4);
+			for (const Matrix2x4* m : { &uv2x4, &converted }) {
+				float u = m->m[0][0] * uv.x + m->m[0][1] * uv.y + m->m[0][2] * 0.0f + m->m[0][3];
+				float v = m->m[1][0] * uv.x + m->m[1][1] * uv.y + m->m[1][2] * 0.0f + m->m[1][3];
+				maxError = std::max({ maxError, std::abs(u - expected.x), std::abs(v - expected.y) });
+			}
+		}
+	}
+	std::printf("UV 2x4 vs 4x4 max abs error: %.3g\n", maxError);
+	TEST_CHECK(maxError < 1.0e-5f);
+}
+
+// SinCosApproxの誤差がコメントに書いた範囲(|radian| <= 8192で絶対誤差1.0e-7程度)に収まること
+void TestSinCosApprox() {
+	double maxError = 0.0;
+	const int stepCount = 1 << 20;
+	for (int i = 0; i <= stepCount; i++) {
+		float radian = -8192.0f + 16384.0f * static_cast<float>(i) / static_cast<float>(stepCount);
+		float sinValue, cosValue;
+		SinCosApprox(radian, sinValue, cosValue);
+		maxError = std::max(maxError, std::abs(sinValue - std::sin(static_cast<double>(radian))));
+		maxError = std::max(maxError, std::abs(cosValue - std::cos(static_cast<double>(radian))));
+	}
+	std::printf("SinCosApprox max abs error (|x| <= 8192): %.3g\n", maxError);
+	TEST_CHECK(maxError < 2.0e-7);
+}
+
+}
+
+int main() {
+	TestAffineInverse();
+	TestQuaternionAffine();
+	TestMatrix3x4();
+	TestUVTransform();
+	TestSinCosApprox();
+	return TestResult("math_test");
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "TestCommon.h"
+#include "MeshCache.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// LoadObjFileCachedが、壊れたキャッシュを使わずに作り直すことと、最適化の解析結果・閉じているかを残すことを確かめる
+
+namespace {
+
+// 格子状の平面(頂点を共有する三角形)。shuffleなら面の順番を混ぜる
+std::string MakeGridObj(int size, bool shuffle = false) {
+	std::string text;
+	for (int y = 0; y <= size; y++) {
+		for (int x = 0; x <= size; x++) {
+			text += "v " + std::to_string(x) + " " + std::to_string(y) + " 0\n";
+			text += "vt " + std::to_string(x / float(size)) + " " + std::to_string(y / float(size)) + "\n";
+		}
+	}
+	text += "vn 0 0 1\n";
+	auto vertex = [&](int x, int y) {
+		std::string index = std::to_string(y * (size + 1) + x + 1);
+		return index + "/" + index + "/1";
+	};
+	std::vector<std::string> faces;
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			faces.push_back("f " + vertex(x, y) + " " + vertex(x + 1, y) + " " + vertex(x, y + 1) + "\n");
+			faces.push_back("f " + vertex(x + 1, y) + " " + vertex(x + 1, y + 1) + " " + vertex(x, y + 1) + "\n");
+		}
+	}
+	if (shuffle) {
+		std::shuffle(faces.begin(), faces.end(), std::mt19937(1));
+	}
+	for (const std::string& face : faces) {
+		text += face;
+	}
+	return text;
+}
+
+// 面ごとにUV・法線が違う(継ぎ目のある)立方体。skipFaceの面は書かず、flipFaceの面は三角形の向きを逆にする
+std::string MakeCubeObj(int skipFace = -1, int flipFace = -1) {
+	std::string text = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n";
+	text += "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n";
+	text += "vn 0 0 -1\nvn 0 0 1\nvn 0 -1 0\nvn 0 1 0\nvn -1 0 0\nvn 1 0 0\n";
+	const int quads[6][4] = { { 1, 4, 3, 2 }, { 5, 6, 7, 8 }, { 1, 2, 6, 5 }, { 3, 4, 8, 7 }, { 4, 1, 5, 8 }, { 2, 3, 7, 6 } };
+	for (int face = 0; face < 6; face++) {
+		if (face == skipFace) {
+			continue;
+		}
+		auto vertex = [&](int corner) {
+			return std::to_string(quads[face][corner]) + "/" + std::to_string(corner + 1) + "/" + std::to_string(face + 1);
+		};
+		if (face == flipFace) {
+			text += "f " + vertex(0) + " " + vertex(2) + " " + vertex(1) + "\n";
+			text += "f " + vertex(0) + " " + vertex(3) + " " + vertex(2) + "\n";
+		}
+		else {
+			text += "f " + vertex(0) + " " + vertex(1) + " " + vertex(2) + "\n";
+			text += "f " + vertex(0) + " " + vertex(2) + " " + vertex(3) + "\n";
+		}
+	}
+	return text;
+}
+
+std::vector<char> ReadBytes(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void WriteBytes(const std::filesystem::path& path, const std::vector<char>& bytes) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool IndicesInRange(const ModelData& model) {
+	return std::all_of(model.indices.begin(), model.indices.end(), [&](uint32_t index) { return index < model.vertices.size(); });
+}
+
+void TestCorruptIndexRecooks(const std::filesystem::path& directory) {
+	{
+		std::ofstream file(directory / "grid.obj", std::ios::binary);
+		file << MakeGridObj(16);
+	}
+	const std::filesystem::path cachePath = directory / "grid.obj.cmesh";
+	std::filesystem::remove(cachePath);
+
+	MeshLoadInfo info;
+	ModelData cooked = LoadObjFileCached(directory.string(), "grid.obj", &info);
+	TEST_CHECK(!info.fromCache);
+	TEST_CHECK(std::filesystem::exists(cachePath));
+	ModelData cached = LoadObjFileCached(directory.string(), "grid.obj", &info);
+	TEST_CHECK(info.fromCache);
+	TEST_CHECK(cached.indices == cooked.indices);
+
+	//キャッシュの中のインデックスの並びを探して、1つを頂点数より大きい値に書き換える
+	std::vector<char> bytes = ReadBytes(cachePath);
+	const char* indexBytes = reinterpret_cast<const char*>(cooked.indices.data());
+	auto found = std::search(bytes.begin(), bytes.end(), indexBytes, indexBytes + 64 * sizeof(uint32_t));
+	TEST_CHECK(found != bytes.end());
+	if (found == bytes.end()) {
+		return;
+	}
+	const uint32_t corrupt = static_cast<uint32_t>(cooked.vertices.size()) + 1000;
+	std::copy_n(reinterpret_cast<const char*>(&corrupt), sizeof(corrupt), found + 10 * sizeof(uint32_t));
+	WriteBytes(cachePath, bytes);
+
+	ModelData recooked = LoadObjFileCached(directory.string(), "grid.obj", &info);
+	TEST_CHECK(!info.fromCache);
+	TEST_CHECK(IndicesInRange(recooked));
+	TEST_CHECK(recooked.indices == cooked.indices);
+
+	//作り直したキャッシュは次から使える
+	LoadObjFileCached(directory.string(), "grid.obj", &info);
+	TEST_CHECK(info.fromCache);
+}
+
+// キャッシュを作るときにOptimizeMeshの前後を解析してMeshLoadInfoに入れ、キャッシュから読んだときも同じ値が返ること
+void TestOptimizationReport(const std::filesystem::path& directory) {
+	{
+		std::ofstream file(directory / "shuffled.obj", std::ios::binary);
+		file << MakeGridObj(64, true);
+	}
+	std::filesystem::remove(directory / "shuffled.obj.cmesh");
+
+	MeshLoadInfo cookedInfo;
+	LoadObjFileCached(directory.string(), "shuffled.obj", &cookedInfo);
+	const MeshOptimizationReport& report = cookedInfo.optimization;
+	std::printf("shuffled grid: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overdraw %.3f -> %.3f\n",
+		report.vertexCacheBefore.acmr, report.vertexCacheAfter.acmr, report.vertexCacheBefore.atvr, report.vertexCacheAfter.atvr,
+		report.overdrawBefore.overdraw, report.overdrawAfter.overdraw);
+	TEST_CHECK(!cookedInfo.fromCache);
+	TEST_CHECK(report.vertexCacheBefore.acmr > 0.0f && report.overdrawBefore.pixelsCovered > 0);
+	TEST_CHECK(report.vertexCacheAfter.acmr < report.vertexCacheBefore.acmr);
+	TEST_CHECK(report.overdrawAfter.overdraw <= report.overdrawBefore.overdraw * 1.05f);
+
+	MeshLoadInfo cachedInfo;
+	LoadObjFileCached(directory.string(), "shuffled.obj", &cachedInfo);
+	TEST_CHECK(cachedInfo.fromCache);
+	TEST_CHECK(cachedInfo.optimization.vertexCacheBefore.acmr == report.vertexCacheBefore.acmr);
+	TEST_CHECK(cachedInfo.optimization.vertexCacheAfter.acmr == report.vertexCacheAfter.acmr);
+	TEST_CHECK(cachedInfo.optimization.overdrawAfter.pixelsShaded == report.overdrawAfter.pixelsShaded);
+}
+
+
+// 閉じたメッシュだけがclosedになり(継ぎ目は位置でつながる)、キャッシュから読んでも同じ値が返ること
+void TestClosedMeshFlag(const std::filesystem::path& directory) {
+	auto isClosed = [&](const std::string& filename, const std::string& text) {
+		{
+			std::ofstream file(directory / filename, std::ios::binary);
+			file << text;
+		}
+		std::filesystem::remove(directory / (filename + ".cmesh"));
+		MeshLoadInfo cookedInfo;
+		const bool cooked = LoadObjFileCached(directory.string(), filename, &cookedInfo).closed;
+		MeshLoadInfo cachedInfo;
+		const ModelData cached = LoadObjFileCached(directory.string(), filename, &cachedInfo);
+		TEST_CHECK(!cookedInfo.fromCache && cachedInfo.fromCache);
+		TEST_CHECK(cached.closed == cooked);
+		return cached.closed;
+	};
+	TEST_CHECK(isClosed("cube.obj", MakeCubeObj()));
+	TEST_CHECK(!isClosed("open_cube.obj", MakeCubeObj(2)));
+	TEST_CHECK(!isClosed("flipped_cube.obj", MakeCubeObj(-1, 3)));
+	TEST_CHECK(!isClosed("grid.obj", MakeGridObj(8)));
+}
+
+}
+
+int main() {
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "cg3_mesh_cache_test";
+	std::filesystem::create_directories(directory);
+	TestCorruptIndexRecooks(directory);
+	TestOptimizationReport(directory);
+	TestClosedMeshFlag(directory);
+	std::filesystem::remove_all(directory);
+	return TestResult("mesh_cache_test");
+}
\ No newline at end of file
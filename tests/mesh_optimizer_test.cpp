@@ -0,0 +1,114 @@
+#include "TestCommon.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// 頂点キャッシュ・重ね塗りの解析を手で数えられる小さなメッシュで確かめ、OptimizeVertexFetchが使われていない頂点を取り除くことを確かめる
+
+namespace {
+
+bool NearlyEqual(float a, float b) {
+	return std::abs(a - b) <= 1.0e-6f * (std::max)(1.0f, std::abs(b));
+}
+
+VertexData MakeVertex(float x, float y, float z) {
+	return { { x, y, z, 1.0f }, { x, y }, { 0.0f, 0.0f, 1.0f } };
+}
+
+// 三角形1つは3頂点とも初めてなのでACMR 3・ATVR 1。帯状に並べると1つ目の後は三角形ごとに1頂点だけ増える
+void TestVertexCache() {
+	const std::vector<uint32_t> triangle = { 0, 1, 2 };
+	VertexCacheStatistics statistics = AnalyzeVertexCache(triangle, 3);
+	TEST_CHECK(statistics.acmr == 3.0f);
+	TEST_CHECK(statistics.atvr == 1.0f);
+
+	//10頂点の帯(三角形8つ)。キャッシュが3以上ならどの頂点も1回だけ読む: ACMR 10/8、ATVR 1
+	std::vector<uint32_t> strip;
+	for (uint32_t i = 0; i + 2 < 10; i++) {
+		if (i % 2 == 0) {
+			strip.insert(strip.end(), { i, i + 1, i + 2 });
+		}
+		else {
+			strip.insert(strip.end(), { i + 1, i, i + 2 });
+		}
+	}
+	for (uint32_t cacheSize : { 3u, 16u }) {
+		statistics = AnalyzeVertexCache(strip, 10, cacheSize);
+		TEST_CHECK(NearlyEqual(statistics.acmr, 10.0f / 8.0f));
+		TEST_CHECK(statistics.atvr == 1.0f);
+	}
+
+	//大きさ3のFIFOで、三角形(0,1,2)(3,4,5)(0,1,2)の3つ目は追い出されているのでもう一度3回読む: ACMR 9/3、ATVR 9/6
+	const std::vector<uint32_t> revisit = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+	statistics = AnalyzeVertexCache(revisit, 6, 3);
+	TEST_CHECK(statistics.acmr == 3.0f);
+	TEST_CHECK(NearlyEqual(statistics.atvr, 1.5f));
+	//大きさ6なら全部残るので3つ目は読まない: ACMR 6/3、ATVR 1
+	statistics = AnalyzeVertexCache(revisit, 6, 6);
+	TEST_CHECK(statistics.acmr == 2.0f);
+	TEST_CHECK(statistics.atvr == 1.0f);
+}
+
+// z = 0とz = 0.5に重ねた1x0.4の四角形2枚
+// 一番長い辺(1)が255ピクセルになるので、±z方向から見ると255x102個のピクセルの中心が入る(対角線はピクセルの中心を通らない)
+// ±x・±y方向からは面積がないので描かれない。+z方向は手前(z = 0)から描くので1回ずつ、-z方向は奥から描くので2回ずつ塗る
+void TestOverdrawStackedQuads() {
+	std::vector<VertexData> vertices;
+	for (float z : { 0.0f, 0.5f }) {
+		vertices.push_back(MakeVertex(0.0f, 0.0f, z));
+		vertices.push_back(MakeVertex(1.0f, 0.0f, z));
+		vertices.push_back(MakeVertex(1.0f, 0.4f, z));
+		vertices.push_back(MakeVertex(0.0f, 0.4f, z));
+	}
+	const uint64_t quadPixels = 255 * 102;
+
+	const std::vector<uint32_t> single = { 0, 1, 2, 0, 2, 3 };
+	OverdrawStatistics statistics = AnalyzeOverdraw(vertices, single);
+	TEST_CHECK(statistics.pixelsCovered == 2 * quadPixels);
+	TEST_CHECK(statistics.pixelsShaded == 2 * quadPixels);
+	TEST_CHECK(statistics.overdraw == 1.0f);
+
+	const std::vector<uint32_t> stacked = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7 };
+	statistics = AnalyzeOverdraw(vertices, stacked);
+	TEST_CHECK(statistics.pixelsCovered == 2 * quadPixels);
+	TEST_CHECK(statistics.pixelsShaded == 3 * quadPixels);
+	TEST_CHECK(statistics.overdraw == 1.5f);
+
+	//描く順番を逆にしても、手前から描く方向と奥から描く方向が入れ替わるだけ
+	const std::vector<uint32_t> reversed = { 4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3 };
+	statistics = AnalyzeOverdraw(vertices, reversed);
+	TEST_CHECK(statistics.pixelsShaded == 3 * quadPixels);
+}
+
+// 最初に使われる順に並べ替え、使われていない頂点を取り除き、三角形は同じ頂点を指したまま
+void TestOptimizeVertexFetch() {
+	ModelData model;
+	for (uint32_t i = 0; i < 6; i++) {
+		model.vertices.push_back(MakeVertex(float(i), float(i * i), 0.0f));
+	}
+	model.indices = { 4, 2, 5, 2, 4, 0 };
+	model.submeshes = { { 0, 6, 0 } };
+	const ModelData source = model;
+	OptimizeVertexFetch(model);
+
+	TEST_CHECK(model.vertices.size() == 4);
+	TEST_CHECK((model.indices == std::vector<uint32_t>{ 0, 1, 2, 1, 0, 3 }));
+	TEST_CHECK(model.indices.size() == source.indices.size());
+	bool sameTriangles = true;
+	for (size_t i = 0; i < model.indices.size() && i < source.indices.size(); i++) {
+		sameTriangles &= model.vertices[model.indices[i]].position.x == source.vertices[source.indices[i]].position.x &&
+			model.vertices[model.indices[i]].position.y == source.vertices[source.indices[i]].position.y;
+	}
+	TEST_CHECK(sameTriangles);
+	TEST_CHECK(model.submeshes.size() == 1 && model.submeshes[0].indexCount == 6);
+}
+
+}
+
+int main() {
+	TestVertexCache();
+	TestOverdrawStackedQuads();
+	TestOptimizeVertexFetch();
+	return TestResult("mesh_optimizer_test");
+}
\ No newline at end of file
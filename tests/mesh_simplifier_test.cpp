@@ -0,0 +1,182 @@
+#include "TestCommon.h"
+#include "MeshSimplifier.h"
+#include "ProceduralMesh.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+// GenerateMeshLodsが同じ入力に同じ結果を返し、三角形をおよそ半分ずつ減らし、誤差が増えていき、
+// 縁・継ぎ目・マテリアルの境目を崩さないことを確かめる
+
+namespace {
+
+using Position = std::array<float, 3>;
+using Edge = std::pair<Position, Position>;
+
+Position GetPosition(const ModelData& model, uint32_t index) {
+	const Vector4& p = model.vertices[index].position;
+	return { p.x, p.y, p.z };
+}
+
+// descの形を、右半分(三角形の重心のx > 0)をマテリアル0、左半分をマテリアル1にして2つのサブメッシュに分ける
+ModelData MakeSplitModel(const PrimitiveDesc& desc) {
+	ModelData model;
+	model.vertices.resize(GetPrimitiveVertexCount(desc));
+	std::vector<uint32_t> indices(GetPrimitiveIndexCount(desc));
+	GeneratePrimitive(desc, model.vertices, indices);
+	std::vector<uint32_t> left;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const float x = model.vertices[indices[i]].position.x + model.vertices[indices[i + 1]].position.x + model.vertices[indices[i + 2]].position.x;
+		std::vector<uint32_t>& target = x > 0.0f ? model.indices : left;
+		target.insert(target.end(), indices.begin() + i, indices.begin() + i + 3);
+	}
+	const uint32_t rightCount = static_cast<uint32_t>(model.indices.size());
+	model.indices.insert(model.indices.end(), left.begin(), left.end());
+	model.materials.resize(2);
+	model.submeshes = { { 0, rightCount, 0 }, { rightCount, static_cast<uint32_t>(left.size()), 1 } };
+	return model;
+}
+
+// 位置でまとめた辺ごとに、いくつの三角形が使っているか(UV・法線の継ぎ目で分かれた頂点は同じ位置とみなす)
+std::map<Edge, uint32_t> CountEdges(const ModelData& model, std::span<const SubMesh> submeshes, uint32_t& degenerateCount) {
+	std::map<Edge, uint32_t> edges;
+	degenerateCount = 0;
+	for (const SubMesh& submesh : submeshes) {
+		for (uint32_t i = submesh.indexStart; i < submesh.indexStart + submesh.indexCount; i += 3) {
+			const Position p[3] = { GetPosition(model, model.indices[i]), GetPosition(model, model.indices[i + 1]), GetPosition(model, model.indices[i + 2]) };
+			if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0]) {
+				degenerateCount++;
+			}
+			for (int corner = 0; corner < 3; corner++) {
+				Position a = p[corner];
+				Position b = p[(corner + 1) % 3];
+				if (b < a) {
+					std::swap(a, b);
+				}
+				edges[{ a, b }]++;
+			}
+		}
+	}
+	return edges;
+}
+
+// 1つの三角形しか使っていない辺(縁)の端点
+std::set<Position> GetBorderPositions(const std::map<Edge, uint32_t>& edges) {
+	std::set<Position> positions;
+	for (const auto& [edge, count] : edges) {
+		if (count == 1) {
+			positions.insert(edge.first);
+			positions.insert(edge.second);
+		}
+	}
+	return positions;
+}
+
+bool SameModel(const ModelData& a, const ModelData& b) {
+	if (a.indices != b.indices || a.lods.size() != b.lods.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.lods.size(); i++) {
+		const MeshLod& lodA = a.lods[i];
+		const MeshLod& lodB = b.lods[i];
+		if (lodA.triangleCount != lodB.triangleCount || std::memcmp(&lodA.error, &lodB.error, sizeof(float)) != 0 || lodA.submeshes.size() != lodB.submeshes.size() ||
+			(!lodA.submeshes.empty() && std::memcmp(lodA.submeshes.data(), lodB.submeshes.data(), lodA.submeshes.size() * sizeof(SubMesh)) != 0)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// flatなら縮約しても形がずれないので、誤差は0のまま
+void CheckLods(const char* name, const PrimitiveDesc& desc, size_t minLodCount, bool flat) {
+	ModelData model = MakeSplitModel(desc);
+	const ModelData source = model;
+	GenerateMeshLods(model);
+
+	std::printf("%s:", name);
+	for (size_t i = 0; i < model.lods.size(); i++) {
+		std::printf(" LOD%zu %u tris err %.5f%s", i, model.lods[i].triangleCount, model.lods[i].error, i + 1 < model.lods.size() ? "," : "\n");
+	}
+	TEST_CHECK(model.lods.size() >= minLodCount);
+	TEST_CHECK(model.lods[0].triangleCount == source.indices.size() / 3 && model.lods[0].error == 0.0f);
+
+	//同じ入力からもう一度作っても、作ったものからもう一度作っても、ビット単位で同じ
+	ModelData again = source;
+	GenerateMeshLods(again);
+	TEST_CHECK(SameModel(model, again));
+	GenerateMeshLods(again);
+	TEST_CHECK(SameModel(model, again));
+
+	uint32_t degenerateCount = 0;
+	const std::map<Edge, uint32_t> sourceEdges = CountEdges(source, source.submeshes, degenerateCount);
+	const std::set<Position> sourceBorder = GetBorderPositions(sourceEdges);
+	const size_t sourceBorderEdges = std::count_if(sourceEdges.begin(), sourceEdges.end(), [](const auto& entry) { return entry.second == 1; });
+	for (size_t i = 1; i < model.lods.size(); i++) {
+		const MeshLod& lod = model.lods[i];
+		const MeshLod& previous = model.lods[i - 1];
+		//目標は前の段の半分。縮約1回で三角形が2つずつ減るので、少しだけ下回ることがある
+		TEST_CHECK(lod.triangleCount <= previous.triangleCount / 2 + 1);
+		TEST_CHECK(lod.triangleCount >= previous.triangleCount * 2 / 5);
+		TEST_CHECK(flat ? lod.error == 0.0f : lod.error > 0.0f && lod.error >= previous.error);
+
+		//マテリアルごとの範囲が元と同じ順番で残り、LOD0より後ろに重ならずに並ぶ
+		TEST_CHECK(lod.submeshes.size() == source.submeshes.size());
+		uint32_t next = static_cast<uint32_t>(source.indices.size());
+		uint32_t triangleCount = 0;
+		bool rangesKept = true;
+		for (size_t s = 0; s < lod.submeshes.size() && s < source.submeshes.size(); s++) {
+			rangesKept &= lod.submeshes[s].materialIndex == source.submeshes[s].materialIndex && lod.submeshes[s].indexStart >= next;
+			next = lod.submeshes[s].indexStart + lod.submeshes[s].indexCount;
+			triangleCount += lod.submeshes[s].indexCount / 3;
+		}
+		TEST_CHECK(rangesKept && next <= model.indices.size());
+		TEST_CHECK(triangleCount == lod.triangleCount);
+
+		//右半分のマテリアルは右に、左半分は左に残る(境目の頂点は境目に沿ってしか動かない)
+		bool materialSideKept = true;
+		for (const SubMesh& submesh : lod.submeshes) {
+			for (uint32_t j = submesh.indexStart; j < submesh.indexStart + submesh.indexCount; j++) {
+				const float x = model.vertices[model.indices[j]].position.x;
+				materialSideKept &= submesh.materialIndex == 0 ? x >= -1.0e-5f : x <= 1.0e-5f;
+			}
+		}
+		TEST_CHECK(materialSideKept);
+
+		//縁は増えず、縁の端点は元の縁の上にあり、3つ以上の三角形が使う辺もつぶれた三角形もできない
+		const std::map<Edge, uint32_t> edges = CountEdges(model, lod.submeshes, degenerateCount);
+		size_t borderEdges = 0;
+		size_t nonManifoldEdges = 0;
+		for (const auto& [edge, count] : edges) {
+			borderEdges += count == 1;
+			nonManifoldEdges += count > 2;
+		}
+		const std::set<Position> border = GetBorderPositions(edges);
+		TEST_CHECK(degenerateCount == 0);
+		TEST_CHECK(nonManifoldEdges == 0);
+		TEST_CHECK(borderEdges <= sourceBorderEdges);
+		TEST_CHECK(std::includes(sourceBorder.begin(), sourceBorder.end(), border.begin(), border.end()));
+	}
+}
+
+}
+
+int main() {
+	//UV球は経度0の列と極に継ぎ目がある閉じた形、平面は縁のある開いた形
+	PrimitiveDesc sphere;
+	sphere.segments = 64;
+	sphere.rings = 32;
+	CheckLods("UvSphere(64x32)", sphere, 3, false);
+	PrimitiveDesc torus;
+	torus.shape = PrimitiveShape::Torus;
+	torus.segments = 64;
+	torus.rings = 16;
+	CheckLods("Torus(64x16)", torus, 3, false);
+	PrimitiveDesc plane;
+	plane.shape = PrimitiveShape::Plane;
+	plane.segments = 32;
+	CheckLods("Plane(32)", plane, 3, true);
+	return TestResult("mesh_simplifier_test");
+}
\ No newline at end of file
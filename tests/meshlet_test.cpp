@@ -0,0 +1,189 @@
+#include "TestCommon.h"
+#include "LodSelection.h"
+#include "MeshletBuilder.h"
+#include "MyMath.h"
+#include "ProceduralMesh.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+// BuildMeshletsの上限・並べ替え・バウンディングスフィアと、CullMeshletsの裏向き・視錐台カリングを確かめる
+
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+// descの形を、インデックスの前半をマテリアル0、後半をマテリアル1にした2つのサブメッシュにする
+ModelData MakePrimitiveModel(const PrimitiveDesc& desc) {
+	ModelData model;
+	model.vertices.resize(GetPrimitiveVertexCount(desc));
+	model.indices.resize(GetPrimitiveIndexCount(desc));
+	GeneratePrimitive(desc, model.vertices, model.indices);
+	model.materials.resize(2);
+	const uint32_t half = static_cast<uint32_t>(model.indices.size() / 6) * 3;
+	model.submeshes = { { 0, half, 0 }, { half, static_cast<uint32_t>(model.indices.size()) - half, 1 } };
+	model.closed = true;
+	return model;
+}
+
+// 周り順を保ったまま、一番小さい番号が先頭になるように回した三角形の並び(並べ替え後の比較用)
+std::vector<Triangle> SortedTriangles(std::span<const uint32_t> indices) {
+	std::vector<Triangle> triangles;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		Triangle triangle = { indices[i], indices[i + 1], indices[i + 2] };
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+Vector3 ToVector3(const Vector4& v) {
+	return { v.x, v.y, v.z };
+}
+
+MeshletCullingView MakeView(const Matrix4x4& world, const Vector3& eye, const Vector3& target) {
+	const float fovY = 0.45f;
+	MeshletCullingView view = {};
+	view.world = world;
+	view.viewProjection = Multiply(MakeLookAtMatrix(eye, target, { 0.0f, 1.0f, 0.0f }), MakePerspectiveFovMatrix(fovY, 16.0f / 9.0f, 0.1f, 100.0f));
+	view.cameraPosition = eye;
+	view.pixelScale = ComputeLodPixelScale(1.0f, fovY, 720.0f);
+	view.minPixelSize = 0.0f;
+	return view;
+}
+
+// メッシュレットは上限を守ってサブメッシュを隙間なく覆い、並べ替えても三角形の集まりは変わらず、どの頂点も球に入る
+void TestBuildMeshlets(const PrimitiveDesc& desc) {
+	ModelData model = MakePrimitiveModel(desc);
+	const std::vector<Triangle> before = SortedTriangles(model.indices);
+	const std::vector<Meshlet> meshlets = BuildMeshlets(model, model.submeshes);
+	TEST_CHECK(!meshlets.empty());
+	TEST_CHECK(SortedTriangles(model.indices) == before);
+	//サブメッシュの中でも三角形の集まりが変わらない(サブメッシュをまたいで動かない)
+	for (const SubMesh& submesh : model.submeshes) {
+		ModelData original = MakePrimitiveModel(desc);
+		const std::span<const uint32_t> range(model.indices.data() + submesh.indexStart, submesh.indexCount);
+		const std::span<const uint32_t> originalRange(original.indices.data() + submesh.indexStart, submesh.indexCount);
+		TEST_CHECK(SortedTriangles(range) == SortedTriangles(originalRange));
+	}
+
+	bool withinLimits = true;
+	bool countsMatch = true;
+	bool insideSphere = true;
+	uint32_t next = 0;
+	size_t submeshIndex = 0;
+	for (const Meshlet& meshlet : meshlets) {
+		//メッシュレットは順に並んで、1つのサブメッシュの中に収まる
+		while (submeshIndex < model.submeshes.size() && next == model.submeshes[submeshIndex].indexStart + model.submeshes[submeshIndex].indexCount) {
+			submeshIndex++;
+		}
+		TEST_CHECK(submeshIndex < model.submeshes.size());
+		if (submeshIndex >= model.submeshes.size()) {
+			return;
+		}
+		const SubMesh& submesh = model.submeshes[submeshIndex];
+		TEST_CHECK(meshlet.indexStart == next);
+		TEST_CHECK(meshlet.materialIndex == submesh.materialIndex);
+		TEST_CHECK(meshlet.indexStart + meshlet.triangleCount * 3 <= submesh.indexStart + submesh.indexCount);
+		next = meshlet.indexStart + meshlet.triangleCount * 3;
+
+		std::unordered_set<uint32_t> unique(model.indices.begin() + meshlet.indexStart, model.indices.begin() + next);
+		withinLimits &= meshlet.triangleCount > 0 && meshlet.triangleCount <= kMeshletMaxTriangles && unique.size() <= kMeshletMaxVertices;
+		countsMatch &= unique.size() == meshlet.vertexCount;
+		for (uint32_t index : unique) {
+			const Vector3 d = Subtract(ToVector3(model.vertices[index].position), meshlet.center);
+			insideSphere &= std::sqrt(Dot(d, d)) <= meshlet.radius * 1.0001f + 1.0e-5f;
+		}
+	}
+	TEST_CHECK(next == model.indices.size());
+	TEST_CHECK(withinLimits);
+	TEST_CHECK(countsMatch);
+	TEST_CHECK(insideSphere);
+}
+
+// 裏向きとして捨てたメッシュレットには、カメラに表を向けた三角形が1つもない
+void TestBackfaceCulling(const PrimitiveDesc& desc) {
+	ModelData model = MakePrimitiveModel(desc);
+	const std::vector<Meshlet> meshlets = BuildMeshlets(model, model.submeshes);
+	//回転と均等な拡大を入れて、ワールド空間でも判定が合うことを見る
+	const Matrix4x4 world = MakeAffineMatrix({ 1.5f, 1.5f, 1.5f }, { 0.3f, 0.7f, 0.1f }, { 0.5f, -0.25f, 4.0f });
+	const Vector3 eyes[] = { { 0.0f, 0.0f, -4.0f }, { 3.0f, 2.0f, 0.0f }, { 0.5f, -0.25f, -20.0f } };
+	uint32_t culledCount = 0;
+	bool culledFacesAway = true;
+	for (const Vector3& eye : eyes) {
+		const MeshletCullingView view = MakeView(world, eye, { 0.5f, -0.25f, 4.0f });
+		std::vector<SubMesh> drawList;
+		for (const Meshlet& meshlet : meshlets) {
+			MeshletCullingStatistics statistics = {};
+			CullMeshlets(std::span<const Meshlet>(&meshlet, 1), view, drawList, &statistics);
+			TEST_CHECK(statistics.frustumCulled == 0);
+			if (statistics.backfaceCulled == 0) {
+				continue;
+			}
+			culledCount++;
+			for (uint32_t i = meshlet.indexStart; i < meshlet.indexStart + meshlet.triangleCount * 3; i += 3) {
+				const Vector3 p0 = Transform(ToVector3(model.vertices[model.indices[i]].position), world);
+				const Vector3 p1 = Transform(ToVector3(model.vertices[model.indices[i + 1]].position), world);
+				const Vector3 p2 = Transform(ToVector3(model.vertices[model.indices[i + 2]].position), world);
+				//(b-a)x(c-a)が表の向き。カメラ側を向いていれば表が見えている
+				const Vector3 normal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+				culledFacesAway &= Dot(normal, Subtract(eye, p0)) <= 0.0f;
+			}
+		}
+	}
+	TEST_CHECK(culledCount > 0);
+	TEST_CHECK(culledFacesAway);
+}
+
+// カメラの後ろにあるメッシュはすべて視錐台の外、前にあればどれも視錐台で捨てない
+void TestFrustumCulling(const PrimitiveDesc& desc) {
+	ModelData model = MakePrimitiveModel(desc);
+	const std::vector<Meshlet> meshlets = BuildMeshlets(model, model.submeshes);
+	const Vector3 eye = { 0.0f, 0.0f, -5.0f };
+	const Vector3 target = { 0.0f, 0.0f, 0.0f };
+	std::vector<SubMesh> drawList;
+	MeshletCullingStatistics statistics = {};
+
+	MeshletCullingView behind = MakeView(MakeTranslateMatrix({ 0.0f, 0.0f, -10.0f }), eye, target);
+	behind.cullBackfaces = false;
+	CullMeshlets(meshlets, behind, drawList, &statistics);
+	TEST_CHECK(statistics.meshletCount == meshlets.size());
+	TEST_CHECK(statistics.frustumCulled == meshlets.size());
+	TEST_CHECK(statistics.visibleTriangleCount == 0 && drawList.empty());
+	TEST_CHECK(statistics.triangleCount == model.indices.size() / 3);
+
+	MeshletCullingView front = MakeView(MakeIdentity4x4(), eye, target);
+	front.cullBackfaces = false;
+	CullMeshlets(meshlets, front, drawList, &statistics);
+	TEST_CHECK(statistics.frustumCulled == 0 && statistics.backfaceCulled == 0);
+	TEST_CHECK(statistics.visibleTriangleCount == statistics.triangleCount);
+	//隣り合う同じマテリアルのものはまとまるので、サブメッシュと同じ2つの範囲になる
+	TEST_CHECK(drawList.size() == model.submeshes.size());
+
+	//裏向きカリングを入れると、見える三角形は減るが半分より少なくはならない程度に残る
+	front.cullBackfaces = true;
+	CullMeshlets(meshlets, front, drawList, &statistics);
+	TEST_CHECK(statistics.backfaceCulled > 0);
+	TEST_CHECK(statistics.visibleTriangleCount < statistics.triangleCount && statistics.visibleTriangleCount * 2 >= statistics.triangleCount);
+}
+
+}
+
+int main() {
+	PrimitiveDesc sphere;
+	sphere.segments = 64;
+	sphere.rings = 32;
+	PrimitiveDesc torus;
+	torus.shape = PrimitiveShape::Torus;
+	torus.segments = 96;
+	torus.rings = 24;
+	for (const PrimitiveDesc& desc : { sphere, torus }) {
+		TestBuildMeshlets(desc);
+		TestBackfaceCulling(desc);
+		TestFrustumCulling(desc);
+	}
+	return TestResult("meshlet_test");
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "TestCommon.h"
+#include "ObjBenchmark.h"
+#include "ObjLoader.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// LoadObjFileが壊れた面を飛ばし、範囲外を読まないことと、合成objを設定ごとに作り分けることを確かめる
+
+namespace {
+
+const char* kMtl =
+	"newmtl A\n"
+	"Kd 1 0 0\n"
+	"newmtl B\n"
+	"Kd 0 1 0\n";
+
+// 頂点4つ・UV3つ・法線1つに対して、読める面と読めない面を混ぜる
+const char* kBody =
+	"v 0 0 0\n"
+	"v 1 0 0\n"
+	"v 0 1 0\n"
+	"v 1 1 0\n"
+	"vt 0 0\n"
+	"vt 1 0\n"
+	"vt 0 1\n"
+	"vn 0 0 1\n"
+	"usemtl A\n"
+	"f 1/1/1 2/2/1 3/3/1\n"            //読める(A)
+	"f 1//1 2//1 3//1\n"               //UVの省略
+	"f -1/-1/-1 -2/-2/-1 -3/-3/-1\n"   //負のインデックス
+	"usemtl B\n"
+	"f 1/1/1 2/2/1 999999/3/1\n"       //位置が範囲外
+	"f 2/2/1 4/3/1 3/3/1\n"            //読める(B)
+	"f 0/1/1 2/2/1 3/3/1\n"            //0は無効
+	"f 1 2 3\n"                        //「/」がない
+	"f 2/2/1 4/3/1 3/999999/1\n"       //UVが範囲外
+	"f 1/1/1 2/2/1 3/3/99999999999\n"  //uint32_tに収まらない
+	"usemtl A\n"
+	"f 1/1/1 3/3/1 4/2/999999\n"       //法線が範囲外
+	"f 1/1/1 4/2/1 3/3/1\n";           //読める(A)
+
+const uint64_t kValidFacesPerBody = 3;
+const uint64_t kSkippedFacesPerBody = 8;
+
+void WriteFile(const std::filesystem::path& path, const std::string& text) {
+	std::ofstream file(path, std::ios::binary);
+	file << text;
+}
+
+bool IndicesInRange(const ModelData& model) {
+	for (uint32_t index : model.indices) {
+		if (index >= model.vertices.size()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestSkipInvalidFaces(const std::filesystem::path& directory) {
+	WriteFile(directory / "invalid.mtl", kMtl);
+	WriteFile(directory / "invalid.obj", std::string("mtllib invalid.mtl\n") + kBody);
+
+	ObjLoadControl control;
+	ModelData model = LoadObjFile(directory.string(), "invalid.obj", 1, nullptr, &control);
+	TEST_CHECK(model.indices.size() == kValidFacesPerBody * 3);
+	TEST_CHECK(control.facesSkipped == kSkippedFacesPerBody);
+	TEST_CHECK(IndicesInRange(model));
+	//usemtlの切り替え位置は飛ばした面を除いた番号になる。Aが2面、Bが1面
+	TEST_CHECK(model.submeshes.size() == 2);
+	if (model.submeshes.size() == 2) {
+		TEST_CHECK(model.materials[model.submeshes[0].materialIndex].name == "A" && model.submeshes[0].indexCount == 6);
+		TEST_CHECK(model.materials[model.submeshes[1].materialIndex].name == "B" && model.submeshes[1].indexCount == 3);
+	}
+}
+
+// 区間に分けて並列に読んでも、飛ばす面と面のマテリアルが1スレッドのときと同じになること
+void TestSkipInvalidFacesParallel(const std::filesystem::path& directory) {
+	std::string text = "mtllib invalid.mtl\n";
+	const uint64_t repeatCount = 4096;  //約2MB。LoadObjFileは256KB以上で区間に分ける
+	for (uint64_t i = 0; i < repeatCount; i++) {
+		text += kBody;
+	}
+	WriteFile(directory / "invalid_large.obj", text);
+
+	ObjLoadControl singleControl;
+	ObjLoadControl parallelControl;
+	ModelData single = LoadObjFile(directory.string(), "invalid_large.obj", 1, nullptr, &singleControl);
+	ModelData parallel = LoadObjFile(directory.string(), "invalid_large.obj", 4, nullptr, &parallelControl);
+	//範囲外のインデックスは、繰り返して頂点が増えても範囲外のままの大きさにしてある
+	TEST_CHECK(singleControl.facesSkipped == kSkippedFacesPerBody * repeatCount);
+	TEST_CHECK(parallelControl.facesSkipped == singleControl.facesSkipped);
+	TEST_CHECK(single.indices == parallel.indices);
+	TEST_CHECK(single.submeshes.size() == parallel.submeshes.size());
+	for (size_t i = 0; i < single.submeshes.size() && i < parallel.submeshes.size(); i++) {
+		TEST_CHECK(single.submeshes[i].indexCount == parallel.submeshes[i].indexCount);
+		TEST_CHECK(single.submeshes[i].materialIndex == parallel.submeshes[i].materialIndex);
+	}
+	TEST_CHECK(IndicesInRange(parallel));
+}
+
+
+// 設定が1つでも違えば別のファイル名になり、書き終わっていないファイルは使われない
+void TestSyntheticObjNaming(const std::filesystem::path& directory) {
+	SyntheticObjSettings settings;
+	settings.targetBytes = 64 << 10;
+	const std::string name = MakeSyntheticObjFilename(settings);
+	TEST_CHECK(name == MakeSyntheticObjFilename(settings));
+	SyntheticObjSettings smaller = settings;
+	smaller.targetBytes = 32 << 10;  //1MB未満どうしでも区別する
+	SyntheticObjSettings otherSeed = settings;
+	otherSeed.seed = 2;
+	SyntheticObjSettings otherMix = settings;
+	otherMix.commentRatio = 0.5f;
+	TEST_CHECK(MakeSyntheticObjFilename(smaller) != name);
+	TEST_CHECK(MakeSyntheticObjFilename(otherSeed) != name);
+	TEST_CHECK(MakeSyntheticObjFilename(otherMix) != name);
+
+	std::string filename;
+	TEST_CHECK(PrepareSyntheticObj(directory.string(), settings, filename) && filename == name);
+	const uint64_t size = std::filesystem::file_size(directory / filename);
+	TEST_CHECK(size >= settings.targetBytes);
+	TEST_CHECK(!std::filesystem::exists(directory / (filename + ".partial")));
+	//mtlがなければ作り直す
+	const std::filesystem::path materialPath = std::filesystem::path(directory / filename).replace_extension(".mtl");
+	std::filesystem::remove(materialPath);
+	TEST_CHECK(PrepareSyntheticObj(directory.string(), settings, filename));
+	TEST_CHECK(std::filesystem::exists(materialPath) && std::filesystem::file_size(directory / filename) == size);
+	//書けなければ失敗を返し、何も残さない
+	TEST_CHECK(!WriteSyntheticObj((directory / "missing").string(), "x.obj", settings).succeeded);
+	TEST_CHECK(!std::filesystem::exists(directory / "missing"));
+}
+
+}
+
+int main() {
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "cg3_obj_loader_test";
+	std::filesystem::create_directories(directory);
+	TestSkipInvalidFaces(directory);
+	TestSkipInvalidFacesParallel(directory);
+	TestSyntheticObjNaming(directory);
+	std::filesystem::remove_all(directory);
+	return TestResult("obj_loader_test");
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "TestCommon.h"
+#include "ProceduralMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <vector>
+
+// GenerateUvSphereのインデックスを展開した三角形が、四角形ごとに6頂点を並べていた元の生成と同じになることを確かめる
+
+namespace {
+
+// 元のmain.cppの生成。四角形abdc(aが左下)をa,b,cとc,b,dの2つの三角形として、6頂点をそのまま並べる
+std::vector<VertexData> GenerateLegacyUvSphere(uint32_t subdivision, float w) {
+	std::vector<VertexData> vertexData(subdivision * subdivision * 6);
+	const float kLonEvery = 2 * std::numbers::pi_v<float> / float(subdivision);
+	const float kLatEvery = std::numbers::pi_v<float> / float(subdivision);
+	auto makeVertex = [&](float lat, float lon, float u, float v) {
+		VertexData vertex = {};
+		vertex.position = { std::cos(lat) * std::cos(lon), std::sin(lat), std::cos(lat) * std::sin(lon), w };
+		vertex.normal = { vertex.position.x, vertex.position.y, vertex.position.z };
+		vertex.texcoord = { u, v };
+		return vertex;
+	};
+	for (uint32_t latIndex = 0; latIndex < subdivision; ++latIndex) {
+		const float lat = -std::numbers::pi_v<float> / 2.0f + kLatEvery * latIndex;
+		for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+			const uint32_t start = (latIndex * subdivision + lonIndex) * 6;
+			const float lon = lonIndex * kLonEvery;
+			const float u0 = float(lonIndex) / float(subdivision);
+			const float u1 = float(lonIndex + 1) / float(subdivision);
+			const float v0 = 1.0f - float(latIndex) / float(subdivision);
+			const float v1 = 1.0f - float(latIndex + 1) / float(subdivision);
+			const VertexData a = makeVertex(lat, lon, u0, v0);
+			const VertexData b = makeVertex(lat + kLatEvery, lon, u0, v1);
+			const VertexData c = makeVertex(lat, lon + kLonEvery, u1, v0);
+			const VertexData d = makeVertex(lat + kLatEvery, lon + kLonEvery, u1, v1);
+			vertexData[start + 0] = a;
+			vertexData[start + 1] = b;
+			vertexData[start + 2] = c;
+			vertexData[start + 3] = c;
+			vertexData[start + 4] = b;
+			vertexData[start + 5] = d;
+		}
+	}
+	return vertexData;
+}
+
+float Difference(const VertexData& a, const VertexData& b) {
+	return (std::max)({
+		std::abs(a.position.x - b.position.x), std::abs(a.position.y - b.position.y), std::abs(a.position.z - b.position.z), std::abs(a.position.w - b.position.w),
+		std::abs(a.normal.x - b.normal.x), std::abs(a.normal.y - b.normal.y), std::abs(a.normal.z - b.normal.z),
+		std::abs(a.texcoord.x - b.texcoord.x), std::abs(a.texcoord.y - b.texcoord.y) });
+}
+
+// 元の生成から極でつぶれる三角形(南極の段のa,b,c、北極の段のc,b,d)を除くと、
+// インデックスを展開したものと三角形の数・順番・周り順・各頂点が一致する(sin/cosの求め方の違いによる誤差は許す)
+void TestUvSphereMatchesLegacy(uint32_t subdivision) {
+	const float w = 2.0f;
+	std::vector<VertexData> vertices(GetUvSphereVertexCount(subdivision, subdivision));
+	std::vector<uint32_t> indices(GetUvSphereIndexCount(subdivision, subdivision));
+	GenerateUvSphere(subdivision, subdivision, w, vertices, indices);
+	TEST_CHECK(std::all_of(indices.begin(), indices.end(), [&](uint32_t index) { return index < vertices.size(); }));
+
+	const std::vector<VertexData> legacy = GenerateLegacyUvSphere(subdivision, w);
+	size_t indexPosition = 0;
+	size_t mismatchCount = 0;
+	float maxDifference = 0.0f;
+	for (uint32_t latIndex = 0; latIndex < subdivision; ++latIndex) {
+		for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+			for (uint32_t half = 0; half < 2; ++half) {
+				if ((half == 0 && latIndex == 0) || (half == 1 && latIndex == subdivision - 1)) {
+					continue;
+				}
+				if (indexPosition + 3 > indices.size()) {
+					++mismatchCount;
+					continue;
+				}
+				const size_t start = (size_t(latIndex) * subdivision + lonIndex) * 6 + half * 3;
+				for (size_t corner = 0; corner < 3; ++corner) {
+					const float difference = Difference(vertices[indices[indexPosition + corner]], legacy[start + corner]);
+					maxDifference = (std::max)(maxDifference, difference);
+					if (!(difference <= 1.0e-5f)) {
+						++mismatchCount;
+					}
+				}
+				indexPosition += 3;
+			}
+		}
+	}
+	std::printf("uv sphere %u: %zu triangles (legacy %u), max difference %g\n", subdivision, indices.size() / 3, subdivision * subdivision * 2, maxDifference);
+	TEST_CHECK(indexPosition == indices.size());
+	TEST_CHECK(mismatchCount == 0);
+}
+
+}
+
+int main() {
+	for (uint32_t subdivision : { 2u, 3u, 16u, 64u, 512u }) {
+		TestUvSphereMatchesLegacy(subdivision);
+	}
+	return TestResult("procedural_mesh_test");
+}
\ No newline at end of file
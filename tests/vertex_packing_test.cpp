@@ -0,0 +1,165 @@
+#include "TestCommon.h"
+#include "VertexPacking.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+// PackVertex/UnpackVertexの往復の誤差と、FloatToHalfの丸め・特殊な値の扱いを確かめる
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double AngleDegrees(const Vector3& a, const Vector3& b) {
+	double dot = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z;
+	double lengthA = std::sqrt(double(a.x) * a.x + double(a.y) * a.y + double(a.z) * a.z);
+	double lengthB = std::sqrt(double(b.x) * b.x + double(b.y) * b.y + double(b.z) * b.z);
+	return std::acos(std::clamp(dot / (lengthA * lengthB), -1.0, 1.0)) * 180.0 / kPi;
+}
+
+// 球面全体(フィボナッチ格子)と、八面体の折り返しの境目になる軸・z=0の円の上の法線を往復させる
+void TestNormalRoundTrip() {
+	std::vector<Vector3> normals;
+	const int sphereCount = 1 << 20;
+	const double goldenAngle = kPi * (3.0 - std::sqrt(5.0));
+	for (int i = 0; i < sphereCount; i++) {
+		double z = 1.0 - 2.0 * (i + 0.5) / sphereCount;
+		double radius = std::sqrt(1.0 - z * z);
+		double phi = goldenAngle * i;
+		normals.push_back({ float(radius * std::cos(phi)), float(radius * std::sin(phi)), float(z) });
+	}
+	for (int i = 0; i < 4096; i++) {
+		double phi = 2.0 * kPi * i / 4096;
+		normals.push_back({ float(std::cos(phi)), float(std::sin(phi)), 0.0f });
+		normals.push_back({ float(std::cos(phi)), float(std::sin(phi)), -1.0e-7f });
+	}
+	const Vector3 axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	normals.insert(normals.end(), std::begin(axes), std::end(axes));
+
+	double maxAngle = 0.0;
+	for (const Vector3& normal : normals) {
+		VertexData vertex = {};
+		vertex.normal = normal;
+		VertexData unpacked = UnpackVertex(PackVertex(vertex));
+		maxAngle = std::max(maxAngle, AngleDegrees(normal, unpacked.normal));
+	}
+	for (const Vector3& axis : axes) {
+		int16_t encoded[2];
+		EncodeOctahedralNormal(axis, encoded);
+		TEST_CHECK(AngleDegrees(axis, DecodeOctahedralNormal(encoded)) < 1.0e-4);
+	}
+	std::printf("octahedral normal max angular error: %.5f deg (%zu normals)\n", maxAngle, normals.size());
+	//16bitの格子の間隔は1/32767。実測の最大は約0.0037度なので、少し余裕を持たせる
+	TEST_CHECK(maxAngle < 0.005);
+}
+
+// UVはhalfで持つ。正規化数の範囲なら相対誤差は2^-11以下(最近接丸め)
+void TestTexcoordRoundTrip() {
+	double maxRelative = 0.0;
+	double maxAbsoluteUnit = 0.0;  //0~1の範囲での絶対誤差
+	const int stepCount = 1 << 20;
+	for (int i = 0; i <= stepCount; i++) {
+		float u = -8.0f + 16.0f * static_cast<float>(i) / stepCount;
+		VertexData vertex = {};
+		vertex.texcoord = { u, 1.0f - u };
+		VertexData unpacked = UnpackVertex(PackVertex(vertex));
+		for (int axis = 0; axis < 2; axis++) {
+			float original = axis == 0 ? vertex.texcoord.x : vertex.texcoord.y;
+			float restored = axis == 0 ? unpacked.texcoord.x : unpacked.texcoord.y;
+			double error = std::abs(double(restored) - original);
+			if (std::abs(original) >= 6.103515625e-5f) {  //halfの正規化数の最小値2^-14
+				maxRelative = std::max(maxRelative, error / std::abs(original));
+			}
+			if (original >= 0.0f && original <= 1.0f) {
+				maxAbsoluteUnit = std::max(maxAbsoluteUnit, error);
+			}
+		}
+	}
+	std::printf("half texcoord max relative error: %.3g (bound %.3g), max abs error in [0,1]: %.3g (bound %.3g)\n",
+		maxRelative, std::ldexp(1.0, -11), maxAbsoluteUnit, std::ldexp(1.0, -12));
+	TEST_CHECK(maxRelative <= std::ldexp(1.0, -11));
+	TEST_CHECK(maxAbsoluteUnit <= std::ldexp(1.0, -12));
+}
+
+// 位置はfloatのまま持つので変わらない
+void TestPositionRoundTrip() {
+	VertexData vertex = {};
+	vertex.position = { 1.0e-30f, -12345.678f, 3.0e30f, 1.0f };
+	VertexData unpacked = UnpackVertex(PackVertex(vertex));
+	TEST_CHECK(unpacked.position.x == vertex.position.x && unpacked.position.y == vertex.position.y && unpacked.position.z == vertex.position.z);
+	TEST_CHECK(unpacked.position.w == 1.0f);
+}
+
+// すべてのhalfがfloatを経由して同じビットに戻ること、隣り合うhalfの中点が偶数側に丸められること
+void TestHalfExhaustive() {
+	for (uint32_t bits = 0; bits <= 0xFFFFu; bits++) {
+		const uint16_t half = static_cast<uint16_t>(bits);
+		const float value = HalfToFloat(half);
+		const bool isNaN = (half & 0x7C00u) == 0x7C00u && (half & 0x03FFu) != 0;
+		if (isNaN) {
+			TEST_CHECK(std::isnan(value));
+			TEST_CHECK(std::isnan(HalfToFloat(FloatToHalf(value))));
+			continue;
+		}
+		TEST_CHECK(FloatToHalf(value) == half);
+	}
+	//正の有限値の隣り合う組(非正規化数と正規化数の境目、65504の手前を含む)
+	for (uint16_t half = 0; half < 0x7BFFu; half++) {
+		const float low = HalfToFloat(half);
+		const float high = HalfToFloat(static_cast<uint16_t>(half + 1));
+		const float middle = low + (high - low) * 0.5f;  //floatで正確に表せる
+		TEST_CHECK(FloatToHalf(middle) == ((half & 1u) ? half + 1 : half));
+		TEST_CHECK(FloatToHalf(std::nextafter(middle, high)) == half + 1);
+		TEST_CHECK(FloatToHalf(std::nextafter(middle, low)) == half);
+		TEST_CHECK(FloatToHalf(-middle) == (0x8000u | ((half & 1u) ? half + 1 : half)));
+	}
+}
+
+void TestHalfSpecialValues() {
+	const float infinity = std::numeric_limits<float>::infinity();
+	TEST_CHECK(FloatToHalf(infinity) == 0x7C00u);
+	TEST_CHECK(FloatToHalf(-infinity) == 0xFC00u);
+	TEST_CHECK(FloatToHalf(0.0f) == 0x0000u);
+	TEST_CHECK(FloatToHalf(-0.0f) == 0x8000u);
+
+	//NaNは仮数部の下位ビットしか立っていないものも含めてNaNのまま(無限大にならない)
+	for (uint32_t nanBits : { 0x7FC00000u, 0x7F800001u, 0x7FBFFFFFu, 0xFFC00000u, 0xFF800001u }) {
+		const uint16_t half = FloatToHalf(std::bit_cast<float>(nanBits));
+		TEST_CHECK((half & 0x7C00u) == 0x7C00u && (half & 0x03FFu) != 0);
+		TEST_CHECK((half & 0x8000u) == ((nanBits >> 16) & 0x8000u));
+	}
+
+	//最大値65504と、丸めで無限大になる境目(65520)
+	TEST_CHECK(FloatToHalf(65504.0f) == 0x7BFFu);
+	TEST_CHECK(FloatToHalf(std::nextafter(65520.0f, 0.0f)) == 0x7BFFu);
+	TEST_CHECK(FloatToHalf(65520.0f) == 0x7C00u);
+	TEST_CHECK(FloatToHalf(1.0e10f) == 0x7C00u);
+	TEST_CHECK(FloatToHalf(-1.0e10f) == 0xFC00u);
+
+	//halfの非正規化数: 最小値2^-24、その半分(2^-25)は偶数側の0、少しでも大きければ最小値
+	TEST_CHECK(FloatToHalf(std::ldexp(1.0f, -24)) == 0x0001u);
+	TEST_CHECK(FloatToHalf(std::ldexp(1.0f, -25)) == 0x0000u);
+	TEST_CHECK(FloatToHalf(std::nextafter(std::ldexp(1.0f, -25), 1.0f)) == 0x0001u);
+	TEST_CHECK(FloatToHalf(std::ldexp(1.0f, -14) - std::ldexp(1.0f, -24)) == 0x03FFu);  //非正規化数の最大値
+	TEST_CHECK(FloatToHalf(std::ldexp(1.0f, -14)) == 0x0400u);                         //正規化数の最小値
+
+	//floatの非正規化数はhalfでは0になり、符号は残る
+	const float floatDenormal = std::numeric_limits<float>::denorm_min();
+	TEST_CHECK(FloatToHalf(floatDenormal) == 0x0000u);
+	TEST_CHECK(FloatToHalf(-floatDenormal) == 0x8000u);
+	TEST_CHECK(FloatToHalf(std::bit_cast<float>(0x007FFFFFu)) == 0x0000u);
+}
+
+}
+
+int main() {
+	TestNormalRoundTrip();
+	TestTexcoordRoundTrip();
+	TestPositionRoundTrip();
+	TestHalfExhaustive();
+	TestHalfSpecialValues();
+	return TestResult("vertex_packing_test");
+}
\ No newline at end of file